@@ -309,6 +309,94 @@ void GenerateScalAB (ostream & out, int h, int w)
 }
 
 
+/*
+  batched matrix-vector products, every SIMD lane holds one
+  matrix and one vector (interleaved storage of equally sized blocks)
+
+  c = A * b
+  c += A * b
+  c -= A * b
+
+  A ... h x n
+  b ... n
+  c ... h
+ */
+void GenerateBatchMatVec (ostream & out, int h, OP op)
+{
+  out << "template <> INLINE void MatKernelBatchMatVec<" << h << ", " << ToString(op) << ">" << endl
+      << "    (size_t n," << endl
+      << "     SIMD<double> * pa, size_t da," << endl
+      << "     SIMD<double> * pb," << endl
+      << "     SIMD<double> * pc)" << endl
+      << "{" << endl;
+
+  for (int i = 0; i < h; i++)
+    out << "SIMD<double> sum" << i << "(0);" << endl;
+
+  out << "for (size_t i = 0; i < n; i++, pa++) {" << endl;
+  out << "SIMD<double> b = pb[i];" << endl;
+  for (int i = 0; i < h; i++)
+    out << "FMAasm(pa[" << i << "*da],b,sum" << i << ");" << endl;
+  out << "}" << endl;
+
+  for (int i = 0; i < h; i++)
+    switch (op)
+      {
+      case SET: out << "pc[" << i << "] = sum" << i << ";" << endl; break;
+      case ADD: out << "pc[" << i << "] += sum" << i << ";" << endl; break;
+      case SUB: out << "pc[" << i << "] -= sum" << i << ";" << endl; break;
+      }
+  out << "}" << endl;
+}
+
+/*
+  c = A^T * b
+  c += A^T * b
+  c -= A^T * b
+
+  A ... n x w
+  b ... n
+  c ... w
+ */
+void GenerateBatchMatTransVec (ostream & out, int w, OP op)
+{
+  out << "template <> INLINE void MatKernelBatchMatTransVec<" << w << ", " << ToString(op) << ">" << endl
+      << "    (size_t n," << endl
+      << "     SIMD<double> * pa, size_t da," << endl
+      << "     SIMD<double> * pb," << endl
+      << "     SIMD<double> * pc)" << endl
+      << "{" << endl;
+
+  for (int j = 0; j < w; j++)
+    out << "SIMD<double> sum" << j << "(0);" << endl;
+
+  out << "for (size_t i = 0; i < n; i++, pa += da) {" << endl;
+  out << "SIMD<double> b = pb[i];" << endl;
+  for (int j = 0; j < w; j++)
+    out << "FMAasm(pa[" << j << "],b,sum" << j << ");" << endl;
+  out << "}" << endl;
+
+  for (int j = 0; j < w; j++)
+    switch (op)
+      {
+      case SET: out << "pc[" << j << "] = sum" << j << ";" << endl; break;
+      case ADD: out << "pc[" << j << "] += sum" << j << ";" << endl; break;
+      case SUB: out << "pc[" << j << "] -= sum" << j << ";" << endl; break;
+      }
+  out << "}" << endl;
+}
+
+void GenerateBatchMatVec (ostream & out, int h)
+{
+  GenerateBatchMatVec (out, h, SET);
+  GenerateBatchMatVec (out, h, ADD);
+  GenerateBatchMatVec (out, h, SUB);
+  GenerateBatchMatTransVec (out, h, SET);
+  GenerateBatchMatTransVec (out, h, ADD);
+  GenerateBatchMatTransVec (out, h, SUB);
+}
+
+
 void GenKernel (ofstream & out, int h, int w)
 {
   out << "template <> inline void MyScalTrans<" << h << ", " << w << ">" << endl
@@ -430,4 +518,17 @@ int main ()
   GenKernel (out, 4, 4);
   GenKernel (out, 5, 4);
   GenKernel (out, 6, 4);
+
+
+  // batched small matrices
+  
+  out << "template <size_t H, OPERATION OP>" << endl
+      << "inline void MatKernelBatchMatVec" << endl
+      << "(size_t n, SIMD<double> * pa, size_t da, SIMD<double> * pb, SIMD<double> * pc);" << endl;
+  out << "template <size_t W, OPERATION OP>" << endl
+      << "inline void MatKernelBatchMatTransVec" << endl
+      << "(size_t n, SIMD<double> * pa, size_t da, SIMD<double> * pb, SIMD<double> * pc);" << endl;
+
+  for (int i = 1; i <= 4; i++)
+    GenerateBatchMatVec (out, i);
 }
@@ -7481,3 +7481,429 @@ sum52.Store(pc+SW*2);
 sum53.Store(pc+SW*3);
 pc += dc;
 }
+template <size_t H, OPERATION OP>
+inline void MatKernelBatchMatVec
+(size_t n, SIMD<double> * pa, size_t da, SIMD<double> * pb, SIMD<double> * pc);
+template <size_t W, OPERATION OP>
+inline void MatKernelBatchMatTransVec
+(size_t n, SIMD<double> * pa, size_t da, SIMD<double> * pb, SIMD<double> * pc);
+template <> INLINE void MatKernelBatchMatVec<1, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+}
+pc[0] = sum0;
+}
+template <> INLINE void MatKernelBatchMatVec<1, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+}
+pc[0] += sum0;
+}
+template <> INLINE void MatKernelBatchMatVec<1, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+}
+pc[0] -= sum0;
+}
+template <> INLINE void MatKernelBatchMatTransVec<1, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+}
+pc[0] = sum0;
+}
+template <> INLINE void MatKernelBatchMatTransVec<1, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+}
+pc[0] += sum0;
+}
+template <> INLINE void MatKernelBatchMatTransVec<1, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+}
+pc[0] -= sum0;
+}
+template <> INLINE void MatKernelBatchMatVec<2, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+}
+pc[0] = sum0;
+pc[1] = sum1;
+}
+template <> INLINE void MatKernelBatchMatVec<2, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+}
+pc[0] += sum0;
+pc[1] += sum1;
+}
+template <> INLINE void MatKernelBatchMatVec<2, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+}
+pc[0] -= sum0;
+pc[1] -= sum1;
+}
+template <> INLINE void MatKernelBatchMatTransVec<2, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+}
+pc[0] = sum0;
+pc[1] = sum1;
+}
+template <> INLINE void MatKernelBatchMatTransVec<2, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+}
+pc[0] += sum0;
+pc[1] += sum1;
+}
+template <> INLINE void MatKernelBatchMatTransVec<2, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+}
+pc[0] -= sum0;
+pc[1] -= sum1;
+}
+template <> INLINE void MatKernelBatchMatVec<3, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+FMAasm(pa[2*da],b,sum2);
+}
+pc[0] = sum0;
+pc[1] = sum1;
+pc[2] = sum2;
+}
+template <> INLINE void MatKernelBatchMatVec<3, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+FMAasm(pa[2*da],b,sum2);
+}
+pc[0] += sum0;
+pc[1] += sum1;
+pc[2] += sum2;
+}
+template <> INLINE void MatKernelBatchMatVec<3, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+FMAasm(pa[2*da],b,sum2);
+}
+pc[0] -= sum0;
+pc[1] -= sum1;
+pc[2] -= sum2;
+}
+template <> INLINE void MatKernelBatchMatTransVec<3, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+FMAasm(pa[2],b,sum2);
+}
+pc[0] = sum0;
+pc[1] = sum1;
+pc[2] = sum2;
+}
+template <> INLINE void MatKernelBatchMatTransVec<3, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+FMAasm(pa[2],b,sum2);
+}
+pc[0] += sum0;
+pc[1] += sum1;
+pc[2] += sum2;
+}
+template <> INLINE void MatKernelBatchMatTransVec<3, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+FMAasm(pa[2],b,sum2);
+}
+pc[0] -= sum0;
+pc[1] -= sum1;
+pc[2] -= sum2;
+}
+template <> INLINE void MatKernelBatchMatVec<4, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+SIMD<double> sum3(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+FMAasm(pa[2*da],b,sum2);
+FMAasm(pa[3*da],b,sum3);
+}
+pc[0] = sum0;
+pc[1] = sum1;
+pc[2] = sum2;
+pc[3] = sum3;
+}
+template <> INLINE void MatKernelBatchMatVec<4, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+SIMD<double> sum3(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+FMAasm(pa[2*da],b,sum2);
+FMAasm(pa[3*da],b,sum3);
+}
+pc[0] += sum0;
+pc[1] += sum1;
+pc[2] += sum2;
+pc[3] += sum3;
+}
+template <> INLINE void MatKernelBatchMatVec<4, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+SIMD<double> sum3(0);
+for (size_t i = 0; i < n; i++, pa++) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0*da],b,sum0);
+FMAasm(pa[1*da],b,sum1);
+FMAasm(pa[2*da],b,sum2);
+FMAasm(pa[3*da],b,sum3);
+}
+pc[0] -= sum0;
+pc[1] -= sum1;
+pc[2] -= sum2;
+pc[3] -= sum3;
+}
+template <> INLINE void MatKernelBatchMatTransVec<4, SET>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+SIMD<double> sum3(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+FMAasm(pa[2],b,sum2);
+FMAasm(pa[3],b,sum3);
+}
+pc[0] = sum0;
+pc[1] = sum1;
+pc[2] = sum2;
+pc[3] = sum3;
+}
+template <> INLINE void MatKernelBatchMatTransVec<4, ADD>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+SIMD<double> sum3(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+FMAasm(pa[2],b,sum2);
+FMAasm(pa[3],b,sum3);
+}
+pc[0] += sum0;
+pc[1] += sum1;
+pc[2] += sum2;
+pc[3] += sum3;
+}
+template <> INLINE void MatKernelBatchMatTransVec<4, SUB>
+    (size_t n,
+     SIMD<double> * pa, size_t da,
+     SIMD<double> * pb,
+     SIMD<double> * pc)
+{
+SIMD<double> sum0(0);
+SIMD<double> sum1(0);
+SIMD<double> sum2(0);
+SIMD<double> sum3(0);
+for (size_t i = 0; i < n; i++, pa += da) {
+SIMD<double> b = pb[i];
+FMAasm(pa[0],b,sum0);
+FMAasm(pa[1],b,sum1);
+FMAasm(pa[2],b,sum2);
+FMAasm(pa[3],b,sum3);
+}
+pc[0] -= sum0;
+pc[1] -= sum1;
+pc[2] -= sum2;
+pc[3] -= sum3;
+}
@@ -280,6 +280,125 @@ namespace ngbla
 
 
 
+  /* ************** batched  c = A * b,  every SIMD lane is one matrix *************** */
+
+  void MultBatchMatVec (size_t h, size_t w, BareSliceMatrix<SIMD<double>> a,
+                        SIMD<double> * pb, SIMD<double> * pc)
+  {
+    size_t r = 0;
+    size_t da = a.Dist();
+    SIMD<double> * pa = &a(0,0);
+    for ( ; r+4 <= h; r += 4, pa += 4*da)
+      MatKernelBatchMatVec<4,SET> (w, pa, da, pb, pc+r);
+    switch (h-r)
+      {
+      case 0: break;
+      case 1: MatKernelBatchMatVec<1,SET> (w, pa, da, pb, pc+r); break;
+      case 2: MatKernelBatchMatVec<2,SET> (w, pa, da, pb, pc+r); break;
+      case 3: MatKernelBatchMatVec<3,SET> (w, pa, da, pb, pc+r); break;
+      default: ;
+      }
+  }
+
+  void MultBatchMatTransVec (size_t h, size_t w, BareSliceMatrix<SIMD<double>> a,
+                             SIMD<double> * pb, SIMD<double> * pc)
+  {
+    size_t c = 0;
+    size_t da = a.Dist();
+    SIMD<double> * pa = &a(0,0);
+    for ( ; c+4 <= w; c += 4)
+      MatKernelBatchMatTransVec<4,SET> (h, pa+c, da, pb, pc+c);
+    switch (w-c)
+      {
+      case 0: break;
+      case 1: MatKernelBatchMatTransVec<1,SET> (h, pa+c, da, pb, pc+c); break;
+      case 2: MatKernelBatchMatTransVec<2,SET> (h, pa+c, da, pb, pc+c); break;
+      case 3: MatKernelBatchMatTransVec<3,SET> (h, pa+c, da, pb, pc+c); break;
+      default: ;
+      }
+  }
+
+
+
+  /* ************** batched LU factorization, every SIMD lane is one matrix *************** */
+
+  bool CalcBatchLU (SliceMatrix<SIMD<double>> a)
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+    size_t n = a.Height();
+
+    double norm[SW];
+    for (size_t l = 0; l < SW; l++)
+      norm[l] = 0;
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        for (size_t l = 0; l < SW; l++)
+          norm[l] = max2(norm[l], fabs(a(i,j)[l]));
+
+    for (size_t k = 0; k < n; k++)
+      {
+        SIMD<double> piv = a(k,k);
+        // no pivoting: small pivots and large growth are refused
+        for (size_t l = 0; l < SW; l++)
+          if (!(fabs(piv[l]) > 1e-12 * norm[l]))
+            return false;
+        SIMD<double> invpiv = 1.0 / piv;
+        for (size_t i = k+1; i < n; i++)
+          {
+            SIMD<double> f = a(i,k) * invpiv;
+            a(i,k) = f;
+            for (size_t j = k+1; j < n; j++)
+              a(i,j) -= f * a(k,j);
+          }
+      }
+
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = i; j < n; j++)
+        for (size_t l = 0; l < SW; l++)
+          if (!(fabs(a(i,j)[l]) < 1e8 * norm[l]))
+            return false;
+    return true;
+  }
+
+  void SolveBatchLU (SliceMatrix<SIMD<double>> lu, SliceMatrix<SIMD<double>> b)
+  {
+    size_t n = lu.Height();
+    size_t m = b.Width();
+    for (size_t i = 1; i < n; i++)
+      for (size_t k = 0; k < i; k++)
+        {
+          SIMD<double> f = lu(i,k);
+          for (size_t j = 0; j < m; j++)
+            b(i,j) -= f * b(k,j);
+        }
+    for (size_t i = n; i-- > 0; )
+      {
+        for (size_t k = i+1; k < n; k++)
+          {
+            SIMD<double> f = lu(i,k);
+            for (size_t j = 0; j < m; j++)
+              b(i,j) -= f * b(k,j);
+          }
+        SIMD<double> invdiag = 1.0 / lu(i,i);
+        for (size_t j = 0; j < m; j++)
+          b(i,j) *= invdiag;
+      }
+  }
+
+  void SubBatchAB (SliceMatrix<SIMD<double>> a, SliceMatrix<SIMD<double>> b,
+                   SliceMatrix<SIMD<double>> c)
+  {
+    for (size_t i = 0; i < a.Height(); i++)
+      for (size_t k = 0; k < a.Width(); k++)
+        {
+          SIMD<double> f = a(i,k);
+          for (size_t j = 0; j < b.Width(); j++)
+            c(i,j) -= f * b(k,j);
+        }
+  }
+
+
+  
   /* ***************************** A * B^T *************************************** */
 
   template <typename TAB, typename FUNC>
@@ -32,6 +32,31 @@ namespace ngbla
 
   
 
+  /// c = a * b for SIMD<double>::Size() interleaved small matrices, a is h x w
+  extern NGS_DLL_HEADER
+  void MultBatchMatVec (size_t h, size_t w, BareSliceMatrix<SIMD<double>> a,
+                        SIMD<double> * b, SIMD<double> * c);
+
+  /// c = a^T * b for SIMD<double>::Size() interleaved small matrices, a is h x w
+  extern NGS_DLL_HEADER
+  void MultBatchMatTransVec (size_t h, size_t w, BareSliceMatrix<SIMD<double>> a,
+                             SIMD<double> * b, SIMD<double> * c);
+
+  /// LU factorization without pivoting of interleaved small matrices,
+  /// returns false if the factorization of some lane is unstable
+  extern NGS_DLL_HEADER
+  bool CalcBatchLU (SliceMatrix<SIMD<double>> a);
+
+  /// b <- a^{-1} b for interleaved matrices a factorized by CalcBatchLU
+  extern NGS_DLL_HEADER
+  void SolveBatchLU (SliceMatrix<SIMD<double>> lu, SliceMatrix<SIMD<double>> b);
+
+  /// c -= a * b for interleaved small matrices
+  extern NGS_DLL_HEADER
+  void SubBatchAB (SliceMatrix<SIMD<double>> a, SliceMatrix<SIMD<double>> b,
+                   SliceMatrix<SIMD<double>> c);
+
+
   extern void AddABt (SliceMatrix<double> a, SliceMatrix<double> b, BareSliceMatrix<double> c);  
   extern void SubABt (SliceMatrix<double> a, SliceMatrix<double> b, BareSliceMatrix<double> c);
 
@@ -38,6 +38,22 @@ namespace ngcomp
 
     shared_ptr<BitArray> wb_free_dofs;
 
+    /// the dofs of a nested level (a subset of the parent wirebasket), nullptr on the top level
+    shared_ptr<BitArray> level_dofs;
+    /// the wirebasket dofs of a nested level
+    shared_ptr<BitArray> level_wbdofs;
+    /// nested BDDC as wirebasket solver (coarsetype=bddc)
+    shared_ptr<BDDCMatrix> nested;
+
+    COUPLING_TYPE GetCouplingType (DofId d) const
+    {
+      if (!level_dofs)
+        return fes->GetDofCouplingType(d);
+      if (!level_dofs->Test(d))
+        return UNUSED_DOF;
+      return level_wbdofs->Test(d) ? WIREBASKET_DOF : INTERFACE_DOF;
+    }
+
   public:
 
     void SetHypre (bool ah = true) { hypre = ah; }
@@ -48,15 +64,18 @@ namespace ngcomp
 		const string & ainversetype, 
 		const string & acoarsetype, 
                 bool ablock, 
-                bool ahypre
+                bool ahypre,
+                shared_ptr<BitArray> alevel_dofs = nullptr,
+                shared_ptr<BitArray> alevel_wbdofs = nullptr
       )
-      : bfa(abfa), block(ablock), inversetype(ainversetype), coarsetype(acoarsetype)
+      : bfa(abfa), block(ablock), inversetype(ainversetype), coarsetype(acoarsetype),
+        level_dofs(alevel_dofs), level_wbdofs(alevel_wbdofs)
     {
       static Timer timer ("BDDC Constructor");
 
       fes = bfa->GetFESpace();
       
-      coarse = (coarsetype != "none");
+      coarse = (coarsetype != "none" && coarsetype != "bddc");
 
       hypre = ahypre;
 
@@ -92,7 +111,8 @@ namespace ngcomp
                {
                  if (d == -1) continue;
                  if (!freedofs.Test(d)) continue;
-                 COUPLING_TYPE ct = fes->GetDofCouplingType(d);
+                 COUPLING_TYPE ct = GetCouplingType(d);
+                 if (ct == UNUSED_DOF) continue;
                  if (ct == LOCAL_DOF && bfa -> UsesEliminateInternal()) continue;
 		
                  int ii = base + el.Nr();
@@ -119,7 +139,8 @@ namespace ngcomp
                {
                  if (d == -1) continue;
                  if (!freedofs.Test(d)) continue;
-                 COUPLING_TYPE ct = fes->GetDofCouplingType(d);
+                 COUPLING_TYPE ct = GetCouplingType(d);
+                 if (ct == UNUSED_DOF) continue;
                  if (ct == LOCAL_DOF && bfa->UsesEliminateInternal()) continue;
 		
                  int ii = base + el.Nr();
@@ -138,7 +159,7 @@ namespace ngcomp
 
       // *wb_free_dofs = wbdof;
       for (auto i : Range(ndof))
-	if (fes->GetDofCouplingType(i) == WIREBASKET_DOF)
+	if (GetCouplingType(i) == WIREBASKET_DOF)
 	  wb_free_dofs -> Set(i);
 
 
@@ -182,6 +203,30 @@ namespace ngcomp
         inv = creator->creatorbf (bfa, flags, "wirebasket"+coarsetype);
         dynamic_pointer_cast<Preconditioner>(inv) -> InitLevel(wb_free_dofs);
       }
+
+      if (coarsetype == "bddc")
+        {
+          if (bfa->GetFESpace()->IsParallel() && !local)
+            throw Exception("coarsetype=bddc not available for distributed spaces");
+
+          // the wirebasket problem is solved by BDDC with the vertex dofs as wirebasket
+          auto vertexdofs = make_shared<BitArray> (ndof);
+          vertexdofs->Clear();
+          Array<DofId> dnums;
+          for (size_t v = 0; v < ma->GetNV(); v++)
+            {
+              fes->GetVertexDofNrs (v, dnums);
+              for (auto d : dnums)
+                if (d >= 0) vertexdofs->Set(d);
+            }
+          vertexdofs->And (*wb_free_dofs);
+
+          if (vertexdofs->NumSet() && vertexdofs->NumSet() < wb_free_dofs->NumSet())
+            nested = make_shared<BDDCMatrix> (bfa, flags, inversetype, "none", false, false,
+                                              wb_free_dofs, vertexdofs);
+          else
+            cout << IM(3) << "no vertex dofs for nested BDDC, use direct wirebasket solver" << endl;
+        }
     }
 
     virtual bool IsComplex() const { return pwbmat -> IsComplex(); }
@@ -203,7 +248,7 @@ namespace ngcomp
       
       for (int k : Range(dnums))
 	{
-	  COUPLING_TYPE ct = fes->GetDofCouplingType(dnums[k]);	      
+	  COUPLING_TYPE ct = GetCouplingType(dnums[k]);
 	  if (ct == WIREBASKET_DOF)
 	    localwbdofs.Append (k);
 	  else
@@ -289,10 +334,14 @@ namespace ngcomp
       
       sparse_innersolve -> AddElementMatrix(intdofs,intdofs,d);
 	
-      dynamic_pointer_cast<SparseMatrix<SCAL,TV,TV>>(pwbmat)
-        ->AddElementMatrix(wbdofs,wbdofs,a);
+      // the nested BDDC assembles its own wirebasket matrix
+      if (!nested)
+        dynamic_pointer_cast<SparseMatrix<SCAL,TV,TV>>(pwbmat)
+          ->AddElementMatrix(wbdofs,wbdofs,a);
       if (coarse)
         dynamic_pointer_cast<Preconditioner>(inv)->AddElementMatrix(wbdofs,a,id,lh);
+      if (nested)
+        nested->AddMatrix(a,wbdofs,id,lh);
     }
 
 
@@ -346,7 +395,7 @@ namespace ngcomp
 
       if (block)
 	{
-          if (coarse)
+          if (coarse || nested)
             throw Exception("combination of coarse and block not implemented! ");
 
 	  //Smoothing Blocks
@@ -414,7 +463,14 @@ namespace ngcomp
               for (int i = 0; i < wb_free_dofs->Size(); i++)
                 if (wb_free_dofs->Test(i)) cntfreedofs++;
 
-              if (coarse)
+              if (nested)
+              {
+                cout << IM(3) << "call nested wirebasket bddc ( with " << cntfreedofs
+                     << " free dofs out of " << pwbmat->Height() << " )" << endl;
+                nested->Finalize();
+                inv = nested;
+              }
+              else if (coarse)
               {
                 cout << IM(3) << "call wirebasket preconditioner finalize ( with " << cntfreedofs
                      << " free dofs out of " << pwbmat->Height() << " )" << endl;
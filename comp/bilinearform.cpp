@@ -89,6 +89,8 @@ namespace ngcomp
     SetStoreInner (flags.GetDefineFlag ("store_inner"));
     precompute = flags.GetDefineFlag ("precompute");
     checksum = flags.GetDefineFlag ("checksum");
+    cache_scatter = flags.GetDefineFlag ("cache_scatter");
+    batch_elements = flags.GetDefineFlag ("batch_elements");
     spd = flags.GetDefineFlag ("spd");
     if (spd) symmetric = true;
     SetCheckUnused (!flags.GetDefineFlagX("check_unused").IsFalse());
@@ -729,6 +731,564 @@ namespace ngcomp
   S_BilinearForm<SCAL> :: ~S_BilinearForm() { ; }
 
 
+  // greedy coloring such that items of one color have disjoint dofs
+  static Table<int> ColorByDofs (const FESpace & fes, size_t nitems,
+                                 const function<void(size_t,Array<DofId>&)> & getdofs)
+  {
+    static Timer t("BilinearForm - coloring");
+    RegionTimer reg(t);
+
+    Array<int> col(nitems);
+    col = -1;
+    Array<unsigned int> mask(fes.GetNDof());
+    Array<DofId> dofs;
+
+    int maxcolor = 0, basecol = 0;
+    size_t found = 0;
+    while (found < nitems)
+      {
+        mask = 0;
+        for (size_t i = 0; i < nitems; i++)
+          {
+            if (col[i] >= 0) continue;
+            getdofs (i, dofs);
+
+            unsigned check = 0;
+            for (auto d : dofs)
+              if (d >= 0) check |= mask[d];
+            if (check == UINT_MAX) continue;
+
+            unsigned checkbit = 1;
+            int color = basecol;
+            while (check & checkbit)
+              {
+                color++;
+                checkbit *= 2;
+              }
+
+            col[i] = color;
+            maxcolor = max(maxcolor, color);
+            found++;
+
+            for (auto d : dofs)
+              if (d >= 0 && !fes.IsAtomicDof(d)) mask[d] |= checkbit;
+          }
+        basecol += 8*sizeof(unsigned int);
+      }
+
+    TableCreator<int> creator(maxcolor+1);
+    for ( ; !creator.Done(); creator++)
+      for (size_t i = 0; i < nitems; i++)
+        creator.Add (col[i], i);
+    return creator.MoveTable();
+  }
+
+
+  template <class SCAL>
+  void S_BilinearForm<SCAL> :: UpdateAssemblyCache ()
+  {
+    const BaseMatrix * mat = &GetMatrix();
+    if (cache_mesh_timestamp != ma->GetTimeStamp() ||
+        cache_ndof != fespace->GetNDof() || cache_matrix != mat)
+      {
+        InvalidateScatterCache();
+        cache_mesh_timestamp = ma->GetTimeStamp();
+        cache_ndof = fespace->GetNDof();
+        cache_matrix = mat;
+      }
+  }
+
+  template <class SCAL>
+  void S_BilinearForm<SCAL> :: InvalidateScatterCache ()
+  {
+    cache_matrix = nullptr;
+
+    innerfacet_coloring = Table<int>();
+    bndfacet_coloring = Table<int>();
+    skeleton_coloring = Table<int>();
+    for (auto & ep : element_positions) ep.Reset();
+    for (auto & fp : facet_positions) fp.Reset();
+  }
+
+  /*
+    Static condensation of one element matrix: the rows and cols odofs
+    of mat are replaced by the Schur complement. With keep_internal,
+    dinv = D^{-1}, he = -D^{-1} C and het = -B D^{-1}, otherwise the
+    element vector (if given) is condensed. For spd matrices, the Schur
+    complement with keep_internal is computed via CalcSchur.
+  */
+  template <typename SCAL>
+  static void CondenseElement (FlatMatrix<SCAL> mat, FlatArray<int> idofs, FlatArray<int> odofs,
+                               bool keep_internal, bool symmetric, bool spd,
+                               FlatMatrix<SCAL> dinv, FlatMatrix<SCAL> he, FlatMatrix<SCAL> het,
+                               FlatVector<SCAL> elvec, LocalHeap & lh)
+  {
+    HeapReset hr(lh);
+    FlatMatrix<SCAL> 
+      a = mat.Rows(odofs).Cols(odofs) | lh,
+      b = mat.Rows(odofs).Cols(idofs) | lh,
+      c = Trans(mat.Rows(idofs).Cols(odofs)) | lh,
+      d = mat.Rows(idofs).Cols(idofs) | lh;
+
+    if (!keep_internal)
+      {
+        LapackAInvBt (d, b);    // b <--- b d^-1
+        LapackMultAddABt (b, c, -1, a);
+        if (elvec.Size())
+          {
+            FlatVector<SCAL> hfi(idofs.Size(), lh);
+            FlatVector<SCAL> hfo(odofs.Size(), lh);
+            hfi = elvec(idofs);
+            hfo = b * hfi;
+            elvec(odofs) -= hfo;
+          }
+      }
+    else
+      {
+        LapackInverse (d);
+        he = 0.0;
+        he -= d * Trans(c) | Lapack;
+        if (!symmetric)
+          {
+            het = 0.0;
+            LapackMultAddAB (b, d, -1, het);
+          }
+        dinv = d;
+        a += b * he | Lapack;
+
+        if (spd)
+          CalcSchur (mat, a, odofs, idofs);
+      }
+    mat.Rows(odofs).Cols(odofs) = a;
+  }
+
+  template <typename SCAL>
+  static bool CondenseBatchSIMD (FlatArray<FlatMatrix<SCAL>> mats, FlatArray<int> idofs, FlatArray<int> odofs,
+                                 bool keep_internal, bool symmetric,
+                                 FlatArray<FlatMatrix<SCAL>> dinv, FlatArray<FlatMatrix<SCAL>> he,
+                                 FlatArray<FlatMatrix<SCAL>> het, FlatArray<FlatVector<SCAL>> elvecs,
+                                 LocalHeap & lh)
+  { return false; }
+
+  /*
+    CondenseElement for up to SIMD<double>::Size() element matrices with
+    equal positions of the local dofs, one element per SIMD lane. The
+    inner blocks are factorized without pivoting. Returns false, without
+    changing anything, if this is not stable for some element.
+  */
+  static bool CondenseBatchSIMD (FlatArray<FlatMatrix<double>> mats, FlatArray<int> idofs, FlatArray<int> odofs,
+                                 bool keep_internal, bool symmetric,
+                                 FlatArray<FlatMatrix<double>> dinv, FlatArray<FlatMatrix<double>> he,
+                                 FlatArray<FlatMatrix<double>> het, FlatArray<FlatVector<double>> elvecs,
+                                 LocalHeap & lh)
+  {
+    HeapReset hr(lh);
+    size_t nl = mats.Size(), ni = idofs.Size(), no = odofs.Size();
+    FlatMatrix<SIMD<double>> d(ni, ni, lh), ct(ni, no, lh), b(no, ni, lh), a(no, no, lh);
+    d = SIMD<double>(0.0);
+    ct = SIMD<double>(0.0);
+    b = SIMD<double>(0.0);
+    a = SIMD<double>(0.0);
+    for (size_t i = 0; i < ni; i++)
+      d(i,i) = SIMD<double>(1.0);     // for unused lanes
+
+    for (size_t l = 0; l < nl; l++)
+      {
+        FlatMatrix<double> m = mats[l];
+        for (size_t i = 0; i < ni; i++)
+          {
+            for (size_t j = 0; j < ni; j++)
+              d(i,j)[l] = m(idofs[i], idofs[j]);
+            for (size_t j = 0; j < no; j++)
+              ct(i,j)[l] = m(idofs[i], odofs[j]);
+          }
+        for (size_t i = 0; i < no; i++)
+          {
+            for (size_t j = 0; j < ni; j++)
+              b(i,j)[l] = m(odofs[i], idofs[j]);
+            for (size_t j = 0; j < no; j++)
+              a(i,j)[l] = m(odofs[i], odofs[j]);
+          }
+      }
+
+    if (!CalcBatchLU (d)) return false;
+
+    if (elvecs.Size())
+      {
+        FlatMatrix<SIMD<double>> fi(ni, 1, lh), fo(no, 1, lh);
+        fi = SIMD<double>(0.0);
+        fo = SIMD<double>(0.0);
+        for (size_t l = 0; l < nl; l++)
+          for (size_t i = 0; i < ni; i++)
+            fi(i,0)[l] = elvecs[l](idofs[i]);
+        SolveBatchLU (d, fi);
+        SubBatchAB (b, fi, fo);
+        for (size_t l = 0; l < nl; l++)
+          for (size_t i = 0; i < no; i++)
+            elvecs[l](odofs[i]) += fo(i,0)[l];
+      }
+
+    SolveBatchLU (d, ct);      // D^{-1} C
+    SubBatchAB (b, ct, a);     // A - B D^{-1} C
+
+    for (size_t l = 0; l < nl; l++)
+      for (size_t i = 0; i < no; i++)
+        for (size_t j = 0; j < no; j++)
+          mats[l](odofs[i], odofs[j]) = a(i,j)[l];
+
+    if (keep_internal)
+      {
+        FlatMatrix<SIMD<double>> inv(ni, ni, lh);
+        inv = SIMD<double>(0.0);
+        for (size_t i = 0; i < ni; i++)
+          inv(i,i) = SIMD<double>(1.0);
+        SolveBatchLU (d, inv);
+
+        FlatMatrix<SIMD<double>> hbt(no, ni, lh);
+        if (!symmetric)
+          {
+            hbt = SIMD<double>(0.0);
+            SubBatchAB (b, inv, hbt);
+          }
+
+        for (size_t l = 0; l < nl; l++)
+          {
+            for (size_t i = 0; i < ni; i++)
+              {
+                for (size_t j = 0; j < ni; j++)
+                  dinv[l](i,j) = inv(i,j)[l];
+                for (size_t j = 0; j < no; j++)
+                  he[l](i,j) = -ct(i,j)[l];
+              }
+            if (!symmetric)
+              for (size_t i = 0; i < no; i++)
+                for (size_t j = 0; j < ni; j++)
+                  het[l](i,j) = hbt(i,j)[l];
+          }
+      }
+    return true;
+  }
+
+  template <class SCAL>
+  void S_BilinearForm<SCAL> :: 
+  CondenseElementsBatched (FlatArray<int> els, FlatArray<FlatArray<DofId>> dnums,
+                           FlatArray<FlatMatrix<SCAL>> elmats, LocalHeap & lh)
+  {
+    static Timer statcondtimer("static condensation batched", 2);
+    ThreadRegionTimer regstat (statcondtimer, TaskManager::GetThreadId());
+
+    size_t nb = elmats.Size();
+    int size = elmats[0].Height();
+    int dim = size / dnums[0].Size();
+
+    // positions of the local dofs in the element
+    FlatArray<FlatArray<int>> idofs(nb, lh), odofs(nb, lh);
+    Array<int> hdofs;
+    bool same = true;
+    for (size_t k = 0; k < nb; k++)
+      {
+        fespace->GetDofNrs (els[k], hdofs, LOCAL_DOF);
+        new (&idofs[k]) FlatArray<int> (dim*hdofs.Size(), lh);
+        new (&odofs[k]) FlatArray<int> (size-dim*hdofs.Size(), lh);
+        for (int j = 0, ii = 0; j < hdofs.Size(); j++)
+          for (int jj = 0; jj < dim; jj++)
+            idofs[k][ii++] = dim*dnums[k].Pos(hdofs[j])+jj;
+        for (int j = 0, ii = 0; j < size; j++)
+          if (!idofs[k].Contains(j))
+            odofs[k][ii++] = j;
+        
+        if (idofs[k].Size() != idofs[0].Size())
+          same = false;
+        else
+          for (size_t j = 0; j < idofs[k].Size(); j++)
+            if (idofs[k][j] != idofs[0][j]) same = false;
+      }
+
+    FlatArray<FlatMatrix<SCAL>> dinv(nb, lh), he(nb, lh), het(nb, lh);
+    FlatArray<FlatVector<SCAL>> elvecs((linearform && !keep_internal) ? nb : 0, lh);
+    FlatArray<FlatArray<int>> idnums(nb, lh), ednums(nb, lh);
+    for (size_t k = 0; k < nb; k++)
+      {
+        size_t ni = idofs[k].Size(), no = odofs[k].Size();
+        if (keep_internal)
+          {
+            new (&dinv[k]) FlatMatrix<SCAL> (ni, ni, lh);
+            new (&he[k]) FlatMatrix<SCAL> (ni, no, lh);
+            new (&het[k]) FlatMatrix<SCAL> (symmetric ? 0 : no, symmetric ? 0 : ni, lh);
+
+            fespace->GetDofNrs (els[k], hdofs, LOCAL_DOF);
+            new (&idnums[k]) FlatArray<int> (ni, lh);
+            for (int j = 0, ii = 0; j < hdofs.Size(); j++)
+              for (int jj = 0; jj < dim; jj++)
+                idnums[k][ii++] = dim*hdofs[j]+jj;
+            fespace->GetDofNrs (els[k], hdofs, EXTERNAL_DOF);
+            new (&ednums[k]) FlatArray<int> (dim*hdofs.Size(), lh);
+            for (int j = 0, ii = 0; j < hdofs.Size(); j++)
+              for (int jj = 0; jj < dim; jj++)
+                ednums[k][ii++] = dim*hdofs[j]+jj;
+
+            if (store_inner && ni)
+              {
+                FlatMatrix<SCAL> d = elmats[k].Rows(idofs[k]).Cols(idofs[k]) | lh;
+                innermatrix->AddElementMatrix(els[k], idnums[k], idnums[k], d);
+              }
+          }
+        else
+          {
+            new (&dinv[k]) FlatMatrix<SCAL> (0, 0, lh);
+            new (&he[k]) FlatMatrix<SCAL> (0, 0, lh);
+            new (&het[k]) FlatMatrix<SCAL> (0, 0, lh);
+          }
+        if (elvecs.Size())
+          {
+            new (&elvecs[k]) FlatVector<SCAL> (size, lh);
+            linearform -> GetVector().GetIndirect (dnums[k], elvecs[k]);
+          }
+      }
+
+    // the spd variant with keep_internal is only done element by element
+    if (!same || !idofs[0].Size() || (keep_internal && spd) ||
+        !CondenseBatchSIMD (elmats, idofs[0], odofs[0], keep_internal, symmetric, dinv, he, het, elvecs, lh))
+      for (size_t k = 0; k < nb; k++)
+        if (idofs[k].Size())
+          CondenseElement (elmats[k], idofs[k], odofs[k], keep_internal, symmetric, spd, dinv[k], he[k], het[k],
+                           elvecs.Size() ? elvecs[k] : FlatVector<SCAL>(0, (SCAL*)nullptr), lh);
+
+    for (size_t k = 0; k < nb; k++)
+      {
+        if (!idofs[k].Size()) continue;
+        if (keep_internal)
+          {
+            harmonicext->AddElementMatrix(els[k], idnums[k], ednums[k], he[k]);
+            if (!symmetric)
+              static_cast<ElementByElementMatrix<SCAL>*>(harmonicexttrans.get())
+                ->AddElementMatrix(els[k], ednums[k], idnums[k], het[k]);
+            innersolve->AddElementMatrix(els[k], idnums[k], idnums[k], dinv[k]);
+          }
+        if (elvecs.Size())
+          linearform->GetVector().SetIndirect (dnums[k], elvecs[k]);
+        for (auto i : idofs[k])
+          if (i % dim == 0)
+            dnums[k][i/dim] = -1;
+      }
+  }
+
+
+  template <class SCAL>
+  bool S_BilinearForm<SCAL> :: 
+  AssembleElementsBatched (VorB vb, LocalHeap & clh, bool use_positions,
+                           FlatArray<bool> useddof, ProgressOutput & progress)
+  {
+    if (!batch_elements || !is_same<SCAL,double>::value ||
+        printelmat || elmat_ev ||
+        fespace->VarOrder() || VB_parts[vb].Size() > 8*sizeof(size_t))
+      return false;
+
+    static Timer t("assemble batched elements");
+    RegionTimer reg(t);
+    constexpr size_t SW = SIMD<double>::Size();
+
+    for (FlatArray<int> els_of_col : fespace->ElementColoring(vb))
+      ParallelForRange
+        (IntRange(els_of_col.Size()), [&] (IntRange r)
+         {
+           LocalHeap lh = clh.Split();
+           FlatArray<int> els = els_of_col.Range(r);
+
+           // elements of same type, material, vertex ordering and integrators
+           // share the finite element
+           Array<tuple<int,int,size_t,size_t>> keys(els.Size());
+           Array<int> order(els.Size());
+           for (size_t i = 0; i < els.Size(); i++)
+             {
+               ElementId ei(vb, els[i]);
+               int index = ma->GetElIndex(ei);
+               auto vnums = ma->GetElVertices(ei);
+               size_t vkey = 0;
+               for (size_t j = vnums.Size(); j-- > 0; )
+                 {
+                   int rank = 0;
+                   for (size_t k = 0; k < vnums.Size(); k++)
+                     if (vnums[k] < vnums[j]) rank++;
+                   vkey = vkey * vnums.Size() + rank;
+                 }
+               size_t mask = 0;
+               for (size_t j = 0; j < VB_parts[vb].Size(); j++)
+                 if (VB_parts[vb][j]->DefinedOn(index) && VB_parts[vb][j]->DefinedOnElement(els[i]))
+                   mask |= size_t(1) << j;
+               keys[i] = make_tuple (int(ma->GetElType(ei)), index, vkey, mask);
+               order[i] = i;
+             }
+           QuickSortI (keys, order);
+
+           Array<DofId> dnums;
+           for (size_t first = 0; first < order.Size(); )
+             {
+               HeapReset hr(lh);
+               size_t next = first+1;
+               while (next < order.Size() && next-first < SW && keys[order[next]] == keys[order[first]])
+                 next++;
+               FlatArray<int> batch = order.Range(first, next);
+               size_t mask = get<3> (keys[batch[0]]);
+               first = next;
+
+               for (size_t k = 0; k < batch.Size(); k++)
+                 progress.Update();
+               if (!mask) continue;
+
+               const FiniteElement & fel = fespace->GetFE (ElementId(vb, els[batch[0]]), lh);
+               size_t elmat_size = fel.GetNDof() * fespace->GetDimension();
+               FlatArray<const ElementTransformation*> trafos(batch.Size(), lh);
+               for (size_t k = 0; k < batch.Size(); k++)
+                 trafos[k] = &ma->GetTrafo (ElementId(vb, els[batch[k]]), lh);
+
+               FlatMatrix<double> elmats(batch.Size()*elmat_size, elmat_size, lh);
+               elmats = 0.0;
+               for (size_t j = 0; j < VB_parts[vb].Size(); j++)
+                 if (mask & (size_t(1) << j))
+                   VB_parts[vb][j]->CalcElementMatricesAdd (fel, trafos, elmats, lh);
+
+               FlatArray<int> batch_els(batch.Size(), lh);
+               FlatArray<FlatArray<DofId>> batch_dnums(batch.Size(), lh);
+               FlatArray<FlatMatrix<SCAL>> batch_elmats(batch.Size(), lh);
+               for (size_t k = 0; k < batch.Size(); k++)
+                 {
+                   ElementId ei(vb, els[batch[k]]);
+                   batch_els[k] = els[batch[k]];
+                   fespace->GetDofNrs (ei, dnums);
+                   new (&batch_dnums[k]) FlatArray<DofId> (dnums.Size(), lh);
+                   batch_dnums[k] = dnums;
+                   new (&batch_elmats[k]) FlatMatrix<SCAL> (elmat_size, lh);
+                   batch_elmats[k] = elmats.Rows(k*elmat_size, (k+1)*elmat_size);
+                   fespace->TransformMat (ei, batch_elmats[k], TRANSFORM_MAT_LEFT_RIGHT);
+                 }
+
+               if (vb == VOL && eliminate_internal)
+                 CondenseElementsBatched (batch_els, batch_dnums, batch_elmats, lh);
+
+               for (size_t k = 0; k < batch.Size(); k++)
+                 {
+                   ElementId ei(vb, els[batch[k]]);
+                   FlatArray<DofId> dnums = batch_dnums[k];
+                   FlatMatrix<SCAL> sum_elmat = batch_elmats[k];
+
+                   if (use_positions)
+                     {
+                       auto pos = element_positions[vb].Get
+                         (ei.Nr(), dnums.Size(),
+                          [&] (FlatArray<size_t> pos) { GetElementPositions (dnums, pos); });
+                       AddElementMatrixPositions (pos, dnums.Size(), sum_elmat);
+                     }
+                   else
+                     AddElementMatrix (dnums, dnums, sum_elmat, ei, lh);
+
+                   for (auto pre : preconditioners)
+                     pre -> AddElementMatrix (dnums, sum_elmat, ei, lh);
+
+                   if (check_unused)
+                     for (auto d : dnums)
+                       if (d != -1) useddof[d] = true;
+                 }
+             }
+         });
+    return true;
+  }
+
+  template <class SCAL>
+  void S_BilinearForm<SCAL> :: GetFacetLoopDofs (VorB vb, size_t i, Array<DofId> & dofs) const
+  {
+    ArrayMem<int,2> elnums, elnums_per;
+    dofs.SetSize0();
+    if (vb == VOL)
+      {
+        ma->GetFacetElements (i, elnums);
+        if (elnums.Size() < 2)
+          {
+            int facet2 = ma->GetPeriodicFacet(i);
+            if (facet2 > i)
+              {
+                ma->GetFacetElements (facet2, elnums_per);
+                elnums.Append (elnums_per[0]);
+              }
+          }
+      }
+    else
+      {
+        auto fnums = ma->GetElFacets (ElementId(BND, i));
+        ma->GetFacetElements (fnums[0], elnums);
+        elnums.SetSize(1);
+      }
+
+    Array<DofId> eldofs;
+    for (int el : elnums)
+      {
+        fespace->GetDofNrs (ElementId(VOL, el), eldofs);
+        dofs.Append (eldofs);
+      }
+  }
+
+
+  template <class SCAL>
+  const Table<int> & S_BilinearForm<SCAL> :: FacetColoring (VorB vb)
+  {
+    Table<int> & coloring = (vb == VOL) ? innerfacet_coloring : bndfacet_coloring;
+    if (!coloring.Size())
+      coloring = ColorByDofs
+        (*fespace, (vb == VOL) ? ma->GetNFacets() : ma->GetNE(BND),
+         [&] (size_t i, Array<DofId> & dofs) { GetFacetLoopDofs (vb, i, dofs); });
+
+    if (cache_scatter && SupportsElementPositions() && !facet_positions[vb].IsSetUp())
+      {
+        size_t n = (vb == VOL) ? ma->GetNFacets() : ma->GetNE(BND);
+        Array<int> maxdofs(n);
+        ParallelFor (n, [&] (size_t i)
+                     {
+                       Array<DofId> dofs;
+                       GetFacetLoopDofs (vb, i, dofs);
+                       maxdofs[i] = dofs.Size();
+                     });
+        facet_positions[vb].SetUp (maxdofs);
+      }
+    return coloring;
+  }
+
+
+  template <class SCAL>
+  const Table<int> & S_BilinearForm<SCAL> :: SkeletonColoring ()
+  {
+    if (!skeleton_coloring.Size())
+      {
+        Array<int> elnums, elnums_per;
+        Array<DofId> eldofs;
+        skeleton_coloring = ColorByDofs
+          (*fespace, ma->GetNE(VOL), [&] (size_t i, Array<DofId> & dofs)
+           {
+             fespace->GetDofNrs (ElementId(VOL, i), dofs);
+             for (auto f : ma->GetElFacets (ElementId(VOL, i)))
+               {
+                 ma->GetFacetElements (f, elnums);
+                 if (elnums.Size() < 2)
+                   {
+                     int facet2 = ma->GetPeriodicFacet(f);
+                     if (facet2 != f)
+                       {
+                         ma->GetFacetElements (facet2, elnums_per);
+                         elnums.Append (elnums_per[0]);
+                       }
+                   }
+                 for (int el : elnums)
+                   if (el != i)
+                     {
+                       fespace->GetDofNrs (ElementId(VOL, el), eldofs);
+                       dofs.Append (eldofs);
+                     }
+               }
+           });
+      }
+    return skeleton_coloring;
+  }
+
+
 
 
   template <class SCAL>
@@ -743,10 +1303,7 @@ namespace ngcomp
                                    Timer("Matrix assembling bound"),
                                    Timer("Matrix assembling co dim 2") };
     
-    static mutex addelemfacbnd_mutex;
-    static mutex addelemfacin_mutex;
     static mutex printelmat_mutex;
-    static mutex printmatasstatus2_mutex;
     static mutex printmatspecel_mutex;
     static mutex printmatspecel2_mutex;
 
@@ -790,6 +1347,7 @@ namespace ngcomp
             size_t nf = ma->GetNFacets();
 
             GetMatrix().SetZero();
+            UpdateAssemblyCache();
 	    
             if (print)
               {
@@ -918,7 +1476,22 @@ namespace ngcomp
                         if (store_inner)
                           innermatrix = make_shared<ElementByElementMatrix<SCAL>>(ndof, ne);
                       }
+
+                    // with cache_scatter, scatter to matrix positions computed once per element
+                    bool use_positions = cache_scatter && SupportsElementPositions();
+                    if (use_positions && !element_positions[vb].IsSetUp())
+                      {
+                        Array<int> maxdofs(ne);
+                        ParallelFor (ne, [&] (size_t i)
+                                     {
+                                       ArrayMem<DofId,100> dnums;
+                                       fespace->GetDofNrs (ElementId(vb, i), dnums);
+                                       maxdofs[i] = dnums.Size();
+                                     });
+                        element_positions[vb].SetUp (maxdofs);
+                      }
                     
+                    if (!AssembleElementsBatched (vb, clh, use_positions, useddof, progress))
                     IterateElements
                       (*fespace, vb, clh,  [&] (FESpace::Element el, LocalHeap & lh)
                        {
@@ -1071,92 +1644,64 @@ namespace ngcomp
                                      (*testout) << "odofs = " << endl << odofs << endl;
                                    }
                                  
-                                 FlatMatrix<SCAL> 
-                                   a = sum_elmat.Rows(odofs).Cols(odofs) | lh,
-                                   b = sum_elmat.Rows(odofs).Cols(idofs) | lh,
-                                   c = Trans(sum_elmat.Rows(idofs).Cols(odofs)) | lh,
-                                   d = sum_elmat.Rows(idofs).Cols(idofs) | lh;
-                                 
-				 
-                                 /*
-                                   statcondtimer.AddFlops (double(sizei)*sizei*sizei/3);  // LU fact
-                                   statcondtimer.AddFlops (double(sizei)*sizei*sizeo);  
-                                   statcondtimer.AddFlops (double(sizei)*sizeo*sizeo);  
-                                 */
-				 
-                                 // A := A - B D^{-1} C^T
-                                 // new Versions, July 07
-                                 if (!keep_internal) 
-                                   {
-                                     LapackAInvBt (d, b);    // b <--- b d^-1
-                                     LapackMultAddABt (b, c, -1, a);                                 
-                                   }
-                                 else
+                                 FlatMatrix<SCAL> dinv(0, 0, lh), he(0, 0, lh), het(0, 0, lh);
+                                 FlatVector<SCAL> elvec(0, (SCAL*)nullptr);
+
+                                 Array<int> idnums1(dnums.Size(), lh), 
+                                   ednums1(dnums.Size(), lh);
+                                 idnums1.SetSize0();
+                                 ednums1.SetSize0();
+                                 if (keep_internal)
                                    {
-                                     Array<int> idnums1(dnums.Size(), lh), 
-                                       ednums1(dnums.Size(), lh);
                                      fespace->GetDofNrs(el.Nr(),idnums1,LOCAL_DOF);
                                      fespace->GetDofNrs(el.Nr(),ednums1,EXTERNAL_DOF);
-                                     
-                                     Array<int> idnums(dim*idnums1.Size(), lh);
-                                     Array<int> ednums(dim*ednums1.Size(), lh);
-                                     idnums.SetSize0(); 
-                                     ednums.SetSize0();
-                                     for (size_t j = 0; j < idnums1.Size(); j++)
-                                       idnums += dim*IntRange(idnums1[j], idnums1[j]+1);
-                                     for (size_t j = 0; j < ednums1.Size(); j++)
-                                       ednums += dim * IntRange(ednums1[j], ednums1[j]+1);
-                                     
+                                   }
+                                 Array<int> idnums(dim*idnums1.Size(), lh);
+                                 Array<int> ednums(dim*ednums1.Size(), lh);
+                                 idnums.SetSize0(); 
+                                 ednums.SetSize0();
+                                 for (size_t j = 0; j < idnums1.Size(); j++)
+                                   idnums += dim*IntRange(idnums1[j], idnums1[j]+1);
+                                 for (size_t j = 0; j < ednums1.Size(); j++)
+                                   ednums += dim * IntRange(ednums1[j], ednums1[j]+1);
+
+                                 if (keep_internal)
+                                   {
                                      if (store_inner)
-                                       innermatrix ->AddElementMatrix(el.Nr(),idnums,idnums,d);
-                                     
-                                     /*
-                                       Matrix<SCAL> hd = d;
-                                       Vector<SCAL> diag(d.Height());
-                                       for (int i = 0; i < d.Height(); i++)
-                                       diag(i) = sqrt(fabs(hd(i,i)));
-                                       for (int i = 0; i < d.Height(); i++)
                                        {
-                                       hd.Row(i) *= 1.0/diag(i);
-                                       hd.Col(i) *= 1.0/diag(i);
+                                         FlatMatrix<SCAL> d = sum_elmat.Rows(idofs).Cols(idofs) | lh;
+                                         innermatrix ->AddElementMatrix(el.Nr(),idnums,idnums,d);
                                        }
-                                       Vector<SCAL> lam(d.Height());
-                                       Matrix<SCAL> evecs(d.Height());
-                                       CalcEigenSystem (hd, lam, evecs);
-                                       cout << "lam = " << lam << endl;
-                                     */
-                                     
-                                     
-                                     LapackInverse (d);
-                                     FlatMatrix<SCAL> he (sizei, sizeo, lh);
-                                     he = 0.0;
-                                     he -= d * Trans(c) | Lapack;
+                                     new (&dinv) FlatMatrix<SCAL> (sizei, sizei, lh);
+                                     new (&he) FlatMatrix<SCAL> (sizei, sizeo, lh);
+                                     if (!symmetric)
+                                       new (&het) FlatMatrix<SCAL> (sizeo, sizei, lh);
+                                   }
+                                 else if (linearform)
+                                   {
+                                     new (&elvec) FlatVector<SCAL> (size, lh);
+                                     linearform -> GetVector().GetIndirect (dnums, elvec);
+                                   }
+
+                                 // A := A - B D^{-1} C^T
+                                 CondenseElement (sum_elmat, idofs, odofs, keep_internal, symmetric, spd,
+                                                  dinv, he, het, elvec, lh);
+
+                                 if (keep_internal)
+                                   {
                                      harmonicext ->AddElementMatrix(el.Nr(),idnums,ednums,he);
                                      if (!symmetric)
-                                       {
-                                         FlatMatrix<SCAL> het (sizeo, sizei, lh);
-                                         het = 0.0;
-                                         LapackMultAddAB (b, d, -1, het);
-                                         //  het = -1.0 * b * d;
-                                         static_cast<ElementByElementMatrix<SCAL>*>(harmonicexttrans.get())
-                                           ->AddElementMatrix(el.Nr(),ednums,idnums,het);
-                                       }
-                                     
-                                     innersolve ->AddElementMatrix(el.Nr(),idnums,idnums,d);
-                                     a += b * he | Lapack;
-                                     
-                                     if (spd)
-                                       { // more stable ? 
-                                         FlatMatrix<SCAL> schur(odofs.Size(), lh);
-                                         CalcSchur (sum_elmat, schur, odofs, idofs);
-                                         a = schur;
-                                       }
-                                   }                             
+                                       static_cast<ElementByElementMatrix<SCAL>*>(harmonicexttrans.get())
+                                         ->AddElementMatrix(el.Nr(),ednums,idnums,het);
+                                     innersolve ->AddElementMatrix(el.Nr(),idnums,idnums,dinv);
+                                   }
+                                 else if (linearform)
+                                   linearform->GetVector().SetIndirect (dnums, elvec);
                                  
                                  if (printelmat) 
                                    {
                                      testout->precision(8);
-                                     (*testout) << "Schur elmat = " << endl << a << endl;
+                                     (*testout) << "Schur elmat = " << endl << sum_elmat.Rows(odofs).Cols(odofs) << endl;
                                    }
                                  
                                  if (elmat_ev)
@@ -1164,22 +1709,8 @@ namespace ngcomp
                                      testout->precision(8);
                                      
                                      (*testout) << "EV of Schur complement:" << endl;
-                                     LapackEigenSystem(a, lh);
-                                   }
-                                 
-                                 sum_elmat.Rows(odofs).Cols(odofs) = a;
-                                 if (linearform && (!keep_internal))
-                                   {
-                                     FlatVector<SCAL> elvec (size, lh);
-                                     linearform -> GetVector().GetIndirect (dnums, elvec);
-                                     FlatVector<SCAL> hfi(sizei, lh);
-                                     FlatVector<SCAL> hfo(sizeo, lh);
-                                     
-                                     hfi = elvec(idofs);
-                                     hfo = b * hfi;
-                                     elvec(odofs) -= hfo;
-                                     
-                                     linearform->GetVector().SetIndirect (dnums, elvec);
+                                     FlatMatrix<SCAL> schur = sum_elmat.Rows(odofs).Cols(odofs) | lh;
+                                     LapackEigenSystem(schur, lh);
                                    }
                                  
                                  for (int k = 0; k < idofs1.Size(); k++)
@@ -1191,8 +1722,16 @@ namespace ngcomp
                              lock_guard<mutex> guard(printelmat_mutex);
                              *testout<< "elem " << el << ", elmat = " << endl << sum_elmat << endl;
                            }
-                         
-                         AddElementMatrix (dnums, dnums, sum_elmat, el, lh);
+
+                         if (use_positions)
+                           {
+                             auto pos = element_positions[vb].Get
+                               (el.Nr(), dnums.Size(),
+                                [&] (FlatArray<size_t> pos) { GetElementPositions (dnums, pos); });
+                             AddElementMatrixPositions (pos, dnums.Size(), sum_elmat);
+                           }
+                         else
+                           AddElementMatrix (dnums, dnums, sum_elmat, el, lh);
 			 
                          for (auto pre : preconditioners)
                            pre -> AddElementMatrix (dnums, sum_elmat, el, lh);
@@ -1260,17 +1799,17 @@ namespace ngcomp
                     for (auto f : elfacets) fine_facet.Set(f);
                   }
                 
-                int cnt = 0;
-                // better: use facet coloring
+                ProgressOutput progress(ma, "assemble inner facet element", nf);
+                for (FlatArray<int> facets_of_col : FacetColoring(VOL))
                 ParallelForRange
-                  ( IntRange(nf), [&] ( IntRange r )
+                  ( IntRange(facets_of_col.Size()), [&] ( IntRange r )
                     {
                       LocalHeap lh = clh.Split();
                       
                       Array<int> elnums_per(2, lh);
 
                       Array<int> dnums, dnums1, dnums2, elnums, fnums, vnums1, vnums2;
-                      for (int i : r)
+                      for (int i : facets_of_col.Range(r))
                         {
                           if (!fine_facet.Test(i)) continue;
                           HeapReset hr(lh);
@@ -1308,14 +1847,7 @@ namespace ngcomp
                           fnums = ma->GetElFacets(ei2);
                           int facnr2 = fnums.Pos(fac2);
                           
-                          {
-                            lock_guard<mutex> guard(printmatasstatus2_mutex);
-                            cnt++;
-                            gcnt++;
-                            if (cnt % 10 == 0)
-                              cout << IM(3) << "\rassemble inner facet element " << cnt << "/" << nf << flush;
-                            ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
-                          }
+                          progress.Update();
                           
                           const FiniteElement & fel1 = fespace->GetFE (ei1, lh);
                           const FiniteElement & fel2 = fespace->GetFE (ei2, lh);
@@ -1486,14 +2018,20 @@ namespace ngcomp
                               //                      if(fabs(elmat(k,k)) < 1e-7 && dnums[k] != -1)
                               //                        cout << "dnums " << dnums << " elmat " << elmat << endl; 
                               
-                              {
-                                lock_guard<mutex> guard(addelemfacin_mutex);
+                              if (facet_positions[VOL].IsSetUp())
+                                {
+                                  auto pos = facet_positions[VOL].Get
+                                    (i, compressed_dnums.Size(), [&] (FlatArray<size_t> pos)
+                                     { GetElementPositions (compressed_dnums, pos); });
+                                  AddElementMatrixPositions (pos, compressed_dnums.Size(), compressed_elmat);
+                                }
+                              else
                                 AddElementMatrix (compressed_dnums, compressed_dnums, compressed_elmat, ElementId(BND,i), lh);
-                              }
                             }
                         }
                     });
-                cout << IM(3) << "\rassemble inner facet element " << nf << "/" << nf << endl;
+                progress.Done();
+                gcnt += nf;
                 
               }
 
@@ -1501,15 +2039,16 @@ namespace ngcomp
             // if (has_element_wise)
             if (elementwise_skeleton_parts.Size())
               {
-                int cnt = 0;
                 int ne = ma->GetNE(VOL);
+                ProgressOutput progress(ma, "assemble inner facet element", nf);
+                for (FlatArray<int> els_of_col : SkeletonColoring())
                 ParallelForRange
-                  (IntRange(ne), [&] ( IntRange r )
+                  (IntRange(els_of_col.Size()), [&] ( IntRange r )
                    {
                      LocalHeap lh = clh.Split();
                      
                      Array<int> dnums, dnums1, dnums2, elnums, elnums_per, fnums1, fnums2, vnums1, vnums2;
-                     for (int el1 : r)
+                     for (int el1 : els_of_col.Range(r))
                        {
                          ElementId ei1(VOL, el1);
                          fnums1 = ma->GetElFacets(ei1);
@@ -1591,10 +2130,7 @@ namespace ngcomp
                                          (*testout) << "elmat = " << endl << elmat << endl;
                                        }
                                      
-                                     {
-                                       lock_guard<mutex> guard(addelemfacbnd_mutex);
-                                       AddElementMatrix (dnums, dnums, elmat, ElementId(VOL,el1), lh);
-                                     }
+                                     AddElementMatrix (dnums, dnums, elmat, ElementId(VOL,el1), lh);
                                    } //end for (numintegrators)
                                  continue;
                                } // end if boundary facet
@@ -1606,14 +2142,7 @@ namespace ngcomp
                              fnums2 = ma->GetElFacets(ei2);
                              int facnr2 = fnums2.Pos(facet2);
                              
-                             {
-                               lock_guard<mutex> guard(printmatasstatus2_mutex);
-                               cnt++;
-                               gcnt++;
-                               if (cnt % 10 == 0)
-                                 cout << IM(3) << "\rassemble inner facet element " << cnt << "/" << nf << flush;
-                               ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
-                             }
+                             progress.Update();
                              
                              const FiniteElement & fel1 = fespace->GetFE (ei1, lh);
                              const FiniteElement & fel2 = fespace->GetFE (ei2, lh);
@@ -1762,40 +2291,28 @@ namespace ngcomp
                                        for (int dj = 0; dj < dim; ++dj)
                                          compressed_elmat(dim*dnums_to_compressed[i]+di,dim*dnums_to_compressed[j]+dj) += elmat(i*dim+di,j*dim+dj);
 
-                                 {
-                                   lock_guard<mutex> guard(addelemfacin_mutex);
-                                   AddElementMatrix (compressed_dnums, compressed_dnums, compressed_elmat,
-                                                     ElementId(BND,el1), lh);
-                                 }
+                                 AddElementMatrix (compressed_dnums, compressed_dnums, compressed_elmat,
+                                                   ElementId(BND,el1), lh);
                                }
                            }
                        }                             
                    });
-                cout << IM(3) << "\rassemble inner facet element " << nf << "/" << nf << endl;
+                progress.Done();
               } // if (elementwise_skeleton_parts.Size())
                 
             if (facetwise_skeleton_parts[BND].Size())
               {
                 // cout << "check bnd" << endl;
-                int cnt = 0;
                 int ne = ma->GetNE(BND);
+                for (FlatArray<int> sels_of_col : FacetColoring(BND))
                 ParallelForRange
-                  ( IntRange(ne), [&] ( IntRange r )
+                  ( IntRange(sels_of_col.Size()), [&] ( IntRange r )
                     {
                       LocalHeap lh = clh.Split();
                       Array<int> fnums, elnums, vnums, svnums, dnums;
                       
-                      for (int i : r)
+                      for (int i : sels_of_col.Range(r))
                         {
-                          {
-                            lock_guard<mutex> guard(printmatasstatus2_mutex);
-                            cnt++;
-                            gcnt++;
-                            // if (cnt % 10 == 0)
-                              // cout << "\rassemble facet surface element " << cnt << "/" << ne << flush;
-                            ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
-                          }
-                          
                           HeapReset hr(lh);
                           ElementId sei(BND, i);
                               
@@ -1888,13 +2405,20 @@ namespace ngcomp
                               //                    for(int k=0; k<elmat.Height(); k++)
                               //                      if(fabs(elmat(k,k)) < 1e-7 && dnums[k] != -1)
                               //                        cout << "dnums " << dnums << " elmat " << elmat << endl; 
-                              {
-                                lock_guard<mutex> guard(addelemfacbnd_mutex);
+                              if (facet_positions[BND].IsSetUp())
+                                {
+                                  auto pos = facet_positions[BND].Get
+                                    (i, dnums.Size(), [&] (FlatArray<size_t> pos)
+                                     { GetElementPositions (dnums, pos); });
+                                  AddElementMatrixPositions (pos, dnums.Size(), elmat);
+                                }
+                              else
                                 AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
-                              }
                             }//end for (numintegrators)
                         }//end for nse                  
                     });//end of parallel
+                gcnt += ne;
+                ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
                 // cout << "\rassemble facet surface element " << ne << "/" << ne << endl;  
               } // if facetwise_skeleton_parts[BND].size
             
@@ -4226,6 +4750,39 @@ namespace ngcomp
 
 
 
+  // dof coordinates as average of element centers, for nested dissection
+  static Array<Vec<3>> CalcDofCoordinates (shared_ptr<FESpace> fes)
+  {
+    auto ma = fes->GetMeshAccess();
+    Array<Vec<3>> coords(fes->GetNDof());
+    Array<int> cnt(fes->GetNDof());
+    coords = Vec<3>(0.0);
+    cnt = 0;
+
+    Array<DofId> dnums;
+    for (VorB vb : { VOL, BND })
+      for (auto el : ma->Elements(vb))
+        {
+          Vec<3> center = 0.0;
+          for (auto v : el.Vertices())
+            center += ma->GetPoint<3>(v);
+          center *= 1.0 / el.Vertices().Size();
+
+          fes->GetDofNrs (el, dnums);
+          for (auto d : dnums)
+            if (d >= 0)
+              {
+                coords[d] += center;
+                cnt[d]++;
+              }
+        }
+
+    for (size_t i = 0; i < coords.Size(); i++)
+      if (cnt[i]) coords[i] *= 1.0 / cnt[i];
+    return coords;
+  }
+
+
   template <class TM, class TV>
   void T_BilinearForm<TM,TV>::
   AllocateMatrix ()
@@ -4239,6 +4796,8 @@ namespace ngcomp
     mymatrix = spmat.get();
     
     if (this->spd) spmat->SetSPD();
+    auto fes = this->GetFESpace();
+    spmat->SetDofCoordinates ([fes] () { return CalcDofCoordinates (fes); });
     shared_ptr<BaseMatrix> mat = spmat;
 
 
@@ -4324,6 +4883,20 @@ namespace ngcomp
     mymatrix -> TMATRIX::AddElementMatrix (dnums1, dnums2, elmat, this->fespace->HasAtomicDofs());
   }
 
+  template <class TM, class TV>
+  void T_BilinearForm<TM,TV>::
+  GetElementPositions (FlatArray<int> dnums, FlatArray<size_t> pos) const
+  {
+    mymatrix -> GetElementPositions (dnums, dnums, pos, false);
+  }
+
+  template <class TM, class TV>
+  void T_BilinearForm<TM,TV>::
+  AddElementMatrixPositions (FlatArray<size_t> pos, size_t n, BareSliceMatrix<TSCAL> elmat)
+  {
+    mymatrix -> AddElementMatrixPositions (pos, n, n, elmat, this->fespace->HasAtomicDofs());
+  }
+
 
   template <class TM, class TV>
   void T_BilinearForm<TM,TV>::LapackEigenSystem(FlatMatrix<TSCAL> & elmat, LocalHeap & lh) const 
@@ -4373,6 +4946,8 @@ namespace ngcomp
     mymatrix = spmat.get();
     
     if (this->spd) spmat->SetSPD();
+    auto fes = this->GetFESpace();
+    spmat->SetDofCoordinates ([fes] () { return CalcDofCoordinates (fes); });
     shared_ptr<BaseMatrix> mat = spmat;
 
 #ifdef PARALLEL
@@ -4432,6 +5007,20 @@ namespace ngcomp
     mymatrix -> TMATRIX::AddElementMatrixSymmetric (dnums1, elmat, this->fespace->HasAtomicDofs());
   }
 
+  template <class TM, class TV>
+  void T_BilinearFormSymmetric<TM,TV>::
+  GetElementPositions (FlatArray<int> dnums, FlatArray<size_t> pos) const
+  {
+    mymatrix -> GetElementPositions (dnums, dnums, pos, true);
+  }
+
+  template <class TM, class TV>
+  void T_BilinearFormSymmetric<TM,TV>::
+  AddElementMatrixPositions (FlatArray<size_t> pos, size_t n, BareSliceMatrix<TSCAL> elmat)
+  {
+    mymatrix -> AddElementMatrixPositions (pos, n, n, elmat, this->fespace->HasAtomicDofs());
+  }
+
 
 
 
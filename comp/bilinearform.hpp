@@ -101,6 +101,10 @@ namespace ngcomp
     Array<void*> precomputed_data;
     /// output of norm of matrix entries
     bool checksum;
+    /// record matrix positions in the first assembly, reuse them later
+    bool cache_scatter = false;
+    /// compute element matrices of equal elements together
+    bool batch_elements = false;
 
   public:
     /// generate a bilinear-form
@@ -339,6 +343,11 @@ namespace ngcomp
     void SetPrintElmat (bool ap);
     void SetElmatEigenValues (bool ee);
     void SetCheckUnused (bool b);
+
+    /// record matrix positions of element matrices on first assembly
+    void SetCacheScatter (bool cs = true) { cache_scatter = cs; }
+    /// drop colorings and matrix positions, e.g. after renumbering dofs
+    virtual void InvalidateScatterCache () { ; }
     
     /// computes low-order matrices from fines matrix
     void GalerkinProjection ();
@@ -391,6 +400,49 @@ namespace ngcomp
   
 
 
+  /// matrix positions of element matrices, recorded on first use
+  class ElementPositions
+  {
+    Table<size_t> positions;
+    Array<bool> recorded;
+    bool is_set_up = false;
+  public:
+    bool IsSetUp () const { return is_set_up; }
+
+    /// items have at most maxdofs[i] dofs
+    void SetUp (FlatArray<int> maxdofs)
+    {
+      Array<int> sizes(maxdofs.Size());
+      for (size_t i = 0; i < sizes.Size(); i++)
+        sizes[i] = sqr(maxdofs[i]);
+      positions = Table<size_t> (sizes);
+      recorded.SetSize (sizes.Size());
+      recorded = false;
+      is_set_up = true;
+    }
+
+    void Reset ()
+    {
+      positions = Table<size_t>();
+      recorded.SetSize0();
+      is_set_up = false;
+    }
+
+    /// positions for n dofs of item nr, calc(pos) is called on first use
+    template <typename TFUNC>
+    FlatArray<size_t> Get (size_t nr, size_t n, TFUNC calc)
+    {
+      FlatArray<size_t> pos = positions[nr].Range(0, n*n);
+      if (!recorded[nr])
+        {
+          calc (pos);
+          recorded[nr] = true;
+        }
+      return pos;
+    }
+  };
+
+
   /**
      We specify the scalar (double or Complex) of the biform.
    */
@@ -410,6 +462,16 @@ namespace ngcomp
     mutable Table<SCAL> send_table;
     mutable Table<SCAL> recv_table;
 #endif
+
+    /// colorings of the facet loops, built on demand
+    Table<int> innerfacet_coloring, bndfacet_coloring, skeleton_coloring;
+    /// matrix positions of element matrices, set up with cache_scatter
+    ElementPositions element_positions[3];
+    /// matrix positions of inner facets (VOL) and boundary facets (BND)
+    ElementPositions facet_positions[2];
+    /// mesh, dofs and matrix the cached data belong to
+    size_t cache_mesh_timestamp = 0, cache_ndof = 0;
+    const BaseMatrix * cache_matrix = nullptr;
     
     
         
@@ -512,6 +574,35 @@ namespace ngcomp
 				   ElementId id, 
 				   LocalHeap & lh) = 0;
 
+    /// can scatter element matrices to precomputed matrix positions
+    virtual bool SupportsElementPositions () const { return false; }
+    /// matrix positions of element matrix entries
+    virtual void GetElementPositions (FlatArray<int> dnums, FlatArray<size_t> pos) const
+    { throw Exception ("GetElementPositions not supported"); }
+    /// add element matrix at positions from GetElementPositions
+    virtual void AddElementMatrixPositions (FlatArray<size_t> pos, size_t n,
+                                            BareSliceMatrix<SCAL> elmat)
+    { throw Exception ("AddElementMatrixPositions not supported"); }
+
+    virtual void InvalidateScatterCache () override;
+
+  protected:
+    /// invalidates cached colorings and positions if mesh, dofs or matrix changed
+    void UpdateAssemblyCache ();
+    /// dofs of item i of the inner facet (VOL) or boundary facet (BND) loop
+    void GetFacetLoopDofs (VorB vb, size_t i, Array<DofId> & dofs) const;
+    /// element loop with batched element matrices, returns false if not applicable
+    bool AssembleElementsBatched (VorB vb, LocalHeap & clh, bool use_positions,
+                                  FlatArray<bool> useddof, ProgressOutput & progress);
+    /// static condensation of a batch of element matrices, SIMD batched if the local dofs agree
+    void CondenseElementsBatched (FlatArray<int> els, FlatArray<FlatArray<DofId>> dnums,
+                                  FlatArray<FlatMatrix<SCAL>> elmats, LocalHeap & lh);
+    /// coloring of inner facets (VOL) or boundary elements (BND) with disjoint dofs
+    const Table<int> & FacetColoring (VorB vb);
+    /// coloring of volume elements with disjoint dofs of all facet neighbours
+    const Table<int> & SkeletonColoring ();
+  public:
+
     /*
     virtual void ApplyElementMatrix(const BaseVector & x,
 				    BaseVector & y,
@@ -607,6 +698,11 @@ namespace ngcomp
 				   ElementId id, 
 				   LocalHeap & lh);
 
+    virtual bool SupportsElementPositions () const { return true; }
+    virtual void GetElementPositions (FlatArray<int> dnums, FlatArray<size_t> pos) const;
+    virtual void AddElementMatrixPositions (FlatArray<size_t> pos, size_t n,
+                                            BareSliceMatrix<TSCAL> elmat);
+
     virtual void LapackEigenSystem(FlatMatrix<TSCAL> & elmat, LocalHeap & lh) const;
   };
 
@@ -642,6 +738,11 @@ namespace ngcomp
                                    BareSliceMatrix<TSCAL> elmat,
 				   ElementId id, 
 				   LocalHeap & lh);
+
+    virtual bool SupportsElementPositions () const { return true; }
+    virtual void GetElementPositions (FlatArray<int> dnums, FlatArray<size_t> pos) const;
+    virtual void AddElementMatrixPositions (FlatArray<size_t> pos, size_t n,
+                                            BareSliceMatrix<TSCAL> elmat);
     /*
     virtual void ApplyElementMatrix(const BaseVector & x,
 				    BaseVector & y,
@@ -55,6 +55,7 @@ namespace ngcomp
 
 #include "gridfunction.hpp"
 #include "bilinearform.hpp"
+#include "sumfactorization.hpp"
 #include "linearform.hpp"
 #include "preconditioner.hpp"
 #include "numproc.hpp"
@@ -4,6 +4,13 @@
 #include <parallelngs.hpp>
 #include <stdlib.h>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace ngcomp; 
 
 
@@ -214,6 +221,259 @@ namespace ngcomp
   }
 
 
+  /*
+    Binary checkpoints: every entry is a fixed header, the fespace
+    type and grid-function name, and the raw vectors of all multidim
+    components. Header and vectors start at aligned file positions,
+    such that the vectors can be read directly from the mapped file.
+   */
+
+  static const char checkpoint_magic[8] = { 'N','G','S','C','K','P','T','\0' };
+  static constexpr size_t checkpoint_align = 64;
+
+  struct CheckpointHeader
+  {
+    char magic[8];
+    uint64_t version;
+    uint64_t header_bytes;    // header and names, padded
+    uint64_t data_bytes;      // raw vectors, padded
+    uint64_t mesh_checksum;
+    uint64_t ndof;
+    int64_t order;
+    uint64_t multidim;
+    uint64_t entrysize;       // doubles per vector entry
+    uint64_t parallel_status;
+    uint64_t fespace_len;
+    uint64_t name_len;
+    double time;
+  };
+
+  static size_t AlignCheckpoint (size_t bytes)
+  {
+    return (bytes + checkpoint_align-1) / checkpoint_align * checkpoint_align;
+  }
+
+  /// every rank writes its own checkpoint file
+  static string CheckpointFileName (const string & filename)
+  {
+    if (MyMPI_GetNTasks() == 1) return filename;
+    return filename + "_" + ToString(MyMPI_GetId());
+  }
+
+  static uint64_t HashCombine (uint64_t h, uint64_t v)
+  {
+    // splitmix64 finalizer
+    v += 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+    return v ^ (v >> 31);
+  }
+
+  /// checksum of vertex coordinates and element vertices
+  static uint64_t MeshChecksum (const MeshAccess & ma)
+  {
+    static Timer t("MeshChecksum"); RegionTimer reg(t);
+    atomic<uint64_t> checksum(HashCombine (ma.GetNV(), ma.GetNE(VOL)));
+
+    ParallelForRange
+      (IntRange(ma.GetNV()), [&] (IntRange r)
+       {
+         uint64_t mysum = 0;
+         for (size_t i : r)
+           {
+             Vec<3> p = ma.GetPoint<3> (i);
+             uint64_t h = i;
+             for (int j = 0; j < 3; j++)
+               {
+                 uint64_t bits;
+                 memcpy (&bits, &p(j), sizeof(bits));
+                 h = HashCombine (h, bits);
+               }
+             mysum += h;
+           }
+         checksum += mysum;
+       });
+
+    ParallelForRange
+      (IntRange(ma.GetNE(VOL)), [&] (IntRange r)
+       {
+         uint64_t mysum = 0;
+         for (size_t i : r)
+           {
+             uint64_t h = HashCombine (i, 1);
+             for (auto v : ma.GetElVertices (ElementId(VOL, i)))
+               h = HashCombine (h, v);
+             mysum += h;
+           }
+         checksum += mysum;
+       });
+    return checksum;
+  }
+
+  static void ParallelCopy (char * dst, const char * src, size_t bytes)
+  {
+    constexpr size_t chunk = 1 << 20;
+    ParallelFor ((bytes+chunk-1) / chunk, [&] (size_t i)
+                 {
+                   size_t first = i*chunk;
+                   memcpy (dst+first, src+first, min2 (chunk, bytes-first));
+                 });
+  }
+
+  /// read-only view of a whole file, memory mapped where available
+  class MappedFile
+  {
+    const char * data = nullptr;
+    size_t size = 0;
+    Array<char> buffer;
+  public:
+    MappedFile (const string & filename)
+    {
+#ifndef WIN32
+      int fd = open (filename.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw Exception ("cannot open checkpoint file '"+filename+"'");
+      struct stat st;
+      if (fstat (fd, &st) == 0)
+        size = st.st_size;
+      if (size > 0)
+        {
+          void * ptr = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (ptr == MAP_FAILED)
+            {
+              close (fd);
+              throw Exception ("cannot map checkpoint file '"+filename+"'");
+            }
+          data = static_cast<const char*> (ptr);
+        }
+      close (fd);
+#else
+      ifstream in(filename, ios::binary | ios::ate);
+      if (!in)
+        throw Exception ("cannot open checkpoint file '"+filename+"'");
+      size = in.tellg();
+      buffer.SetSize (size);
+      in.seekg (0);
+      if (size) in.read (&buffer[0], size);
+      data = size ? &buffer[0] : nullptr;
+#endif
+    }
+
+    ~MappedFile ()
+    {
+#ifndef WIN32
+      if (size > 0)
+        munmap (const_cast<char*> (data), size);
+#endif
+    }
+
+    const char * Data () const { return data; }
+    size_t Size () const { return size; }
+  };
+
+
+  void GridFunction :: SaveCheckpoint (const string & filename, bool append, double time) const
+  {
+    static Timer t("GridFunction::SaveCheckpoint"); RegionTimer reg(t);
+
+    string fesname = fespace->GetClassName();
+    size_t vecbytes = GetVector().Size() * GetVector().EntrySize() * sizeof(double);
+
+    CheckpointHeader header;
+    memset (&header, 0, sizeof(header));
+    memcpy (header.magic, checkpoint_magic, sizeof(header.magic));
+    header.version = 1;
+    header.fespace_len = fesname.length();
+    header.name_len = name.length();
+    header.header_bytes = AlignCheckpoint (sizeof(header) + header.fespace_len + header.name_len);
+    header.data_bytes = AlignCheckpoint (multidim * vecbytes);
+    header.mesh_checksum = MeshChecksum (*ma);
+    header.ndof = GetVector().Size();
+    header.order = fespace->GetOrder();
+    header.multidim = multidim;
+    header.entrysize = GetVector().EntrySize();
+    header.parallel_status = GetVector().GetParallelStatus();
+    header.time = time;
+
+    string fname = CheckpointFileName (filename);
+    ofstream out(fname, ios::binary | (append ? ios::app : ios::trunc));
+    if (!out)
+      throw Exception ("cannot open checkpoint file '"+fname+"'");
+
+    Array<char> padding(checkpoint_align);
+    padding = 0;
+    
+    out.write (reinterpret_cast<const char*> (&header), sizeof(header));
+    out.write (fesname.c_str(), header.fespace_len);
+    out.write (name.c_str(), header.name_len);
+    out.write (&padding[0], header.header_bytes - sizeof(header) - header.fespace_len - header.name_len);
+    for (int i = 0; i < multidim; i++)
+      out.write (static_cast<const char*> (vec[i]->Memory()), vecbytes);
+    out.write (&padding[0], header.data_bytes - multidim*vecbytes);
+    if (!out)
+      throw Exception ("writing checkpoint file '"+fname+"' failed");
+  }
+
+
+  double GridFunction :: LoadCheckpoint (const string & filename, int index)
+  {
+    static Timer t("GridFunction::LoadCheckpoint"); RegionTimer reg(t);
+
+    string fname = CheckpointFileName (filename);
+    MappedFile file(fname);
+
+    // entries of this grid-function
+    Array<size_t> entries;
+    for (size_t pos = 0; pos < file.Size(); )
+      {
+        const CheckpointHeader * header = reinterpret_cast<const CheckpointHeader*> (file.Data()+pos);
+        if (pos + sizeof(CheckpointHeader) > file.Size() ||
+            memcmp (header->magic, checkpoint_magic, sizeof(header->magic)) != 0)
+          throw Exception ("'"+fname+"' is not a grid-function checkpoint file");
+        // the sizes are read from the file, compare without overflow
+        size_t avail = file.Size() - pos;
+        if (header->fespace_len > avail || header->name_len > avail - header->fespace_len ||
+            header->header_bytes < sizeof(CheckpointHeader) + header->fespace_len + header->name_len)
+          throw Exception ("checkpoint file '"+fname+"' has a corrupt header");
+        if (header->header_bytes > avail || header->data_bytes > avail - header->header_bytes)
+          throw Exception ("checkpoint file '"+fname+"' is truncated");
+
+        string entryname(file.Data()+pos+sizeof(CheckpointHeader)+header->fespace_len, header->name_len);
+        if (entryname == name)
+          entries.Append (pos);
+        pos += header->header_bytes + header->data_bytes;
+      }
+
+    int nr = (index < 0) ? int(entries.Size()) + index : index;
+    if (nr < 0 || nr >= entries.Size())
+      throw Exception ("checkpoint "+ToString(index)+" of grid-function '"+name+"' not found in '"+fname+"'");
+
+    const char * entry = file.Data() + entries[nr];
+    const CheckpointHeader & header = *reinterpret_cast<const CheckpointHeader*> (entry);
+    string fesname(entry+sizeof(CheckpointHeader), header.fespace_len);
+
+    if (header.mesh_checksum != MeshChecksum (*ma))
+      throw Exception ("checkpoint of grid-function '"+name+"' was written for a different mesh");
+    if (fesname != fespace->GetClassName() || header.order != fespace->GetOrder() ||
+        header.ndof != GetVector().Size() || header.entrysize != GetVector().EntrySize())
+      throw Exception ("checkpoint of grid-function '"+name+"' was written for a different space: "
+                       + fesname + ", order " + ToString(header.order) + ", ndof " + ToString(header.ndof));
+    if (header.multidim != multidim)
+      throw Exception ("checkpoint of grid-function '"+name+"' has multidim = "+ToString(header.multidim));
+
+    size_t vecbytes = header.ndof * header.entrysize * sizeof(double);
+    if (header.data_bytes < multidim * vecbytes)
+      throw Exception ("checkpoint of grid-function '"+name+"' is truncated");
+    for (int i = 0; i < multidim; i++)
+      {
+        ParallelCopy (static_cast<char*> (vec[i]->Memory()),
+                      entry + header.header_bytes + i*vecbytes, vecbytes);
+        vec[i]->SetParallelStatus (PARALLEL_STATUS(header.parallel_status));
+      }
+    return header.time;
+  }
+
+
   // void GridFunction :: Visualize(const string & given_name)
   void Visualize(shared_ptr<GridFunction> gf, const string & given_name)
   {
@@ -144,6 +144,11 @@ namespace ngcomp
 
     /// increase multidim and copy vec to new component
     void AddMultiDimComponent (BaseVector & vec);
+
+    /// binary checkpoint of all components, append for time series or bundles
+    void SaveCheckpoint (const string & filename, bool append = false, double time = 0) const;
+    /// load checkpoint number index of this name, negative counts from the end; returns time
+    double LoadCheckpoint (const string & filename, int index = -1);
   
     int GetLevelUpdated() const { return level_updated; }
     ///
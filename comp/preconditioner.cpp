@@ -265,6 +265,10 @@ namespace ngcomp
 	else
 	  sm = make_shared<BlockSmoother> (*ma, *lo_bfa, *lfconstraint, flags);
       }
+    else if (smoothertype == "chebyshev")
+      {
+	sm = make_shared<ChebyshevSmoother> (*ma, *lo_bfa, flags);
+      }
     /*
     else if (smoothertype == "potential")
       {
@@ -364,6 +368,10 @@ namespace ngcomp
             sm = new BlockSmoother (*ma, *lo_bfa, *lfconstraint, flags);
           */
       }
+    else if (smoothertype == "chebyshev")
+      {
+	sm = make_shared<ChebyshevSmoother> (*ma, *lo_bfa, flags);
+      }
     /*
     else if (smoothertype == "potential")
       {
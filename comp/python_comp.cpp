@@ -1257,6 +1257,23 @@ used_idnrs : list of int = None
                LoadBin(in, d);
          },
          py::arg("filename"), py::arg("parallel")=false)         
+
+    .def("SaveCheckpoint", [](GF& self, string filename, bool append, double time)
+         {
+           self.SaveCheckpoint(filename, append, time);
+         },
+         py::arg("filename"), py::arg("append")=false, py::arg("time")=0.0,
+         "binary checkpoint of the vectors, together with fespace, order, ndof and a mesh checksum\n"
+         "append=True adds it to the file, for time series or several grid-functions in one file",
+         py::call_guard<py::gil_scoped_release>())
+    .def("LoadCheckpoint", [](GF& self, string filename, int index)
+         {
+           return self.LoadCheckpoint(filename, index);
+         },
+         py::arg("filename"), py::arg("index")=-1,
+         "load checkpoint number 'index' of this grid-function (matched by name) from a memory mapped file,\n"
+         "negative index counts from the end. Returns the time stored with the checkpoint",
+         py::call_guard<py::gil_scoped_release>())
          
     .def("Set", 
          [](shared_ptr<GF> self, spCF cf,
@@ -1578,7 +1595,16 @@ check_unused : bool
                      "  of the matrix on the finest grid. This is needed to use the multigrid\n"
                      "  preconditioner with a changing bilinearform.",
 		     py::arg("nonsym_storage") = "bool = False\n"
-		     " The full matrix is stored, even if the symmetric flag is set."
+		     " The full matrix is stored, even if the symmetric flag is set.",
+                     py::arg("cache_scatter") = "bool = False\n"
+                     "  Record the matrix positions of element and facet matrices\n"
+                     "  during the first assembly and reuse them on reassembly.\n"
+                     "  Costs one index per element matrix entry.",
+                     py::arg("batch_elements") = "bool = False\n"
+                     "  Compute element matrices of up to SIMD-width elements with\n"
+                     "  equal finite elements together, one element per SIMD lane.\n"
+                     "  Speeds up assembly of low order elements. Together with\n"
+                     "  eliminate_internal, the batch is also condensed together."
                      );
                 })
 
@@ -1601,6 +1627,9 @@ check_unused : bool
          }, py::call_guard<py::gil_scoped_release>(),
          py::arg("reallocate")=false)
 
+    .def("InvalidateScatterCache", [](BF & self) { self.InvalidateScatterCache(); },
+         "drop cached colorings and matrix positions, they are recomputed on next Assemble")
+
     .def_property_readonly("mat", [](BF & self)
                                          {
                                            auto mat = self.GetMatrixPtr();
@@ -1691,6 +1720,27 @@ y : ngsolve.BaseVector
                   )
     ;
 
+  py::class_<SumFactorizationOperator, shared_ptr<SumFactorizationOperator>, BaseMatrix>
+    (m, "SumFactorizationOperator",
+     "matrix-free operator for alpha*grad(u)*grad(v)+beta*u*v on quad/hex meshes\n"
+     "for H1 and L2 spaces of uniform order, applied by sum factorization")
+    .def(py::init([](shared_ptr<FESpace> fes, py::object alpha, py::object beta, int intorder)
+                  {
+                    auto tocf = [] (py::object val) -> spCF
+                      {
+                        if (val.is_none()) return nullptr;
+                        if (py::isinstance<py::float_>(val) || py::isinstance<py::int_>(val))
+                          return make_shared<ConstantCoefficientFunction> (val.cast<double>());
+                        return val.cast<spCF>();
+                      };
+                    return make_shared<SumFactorizationOperator> (fes, tocf(alpha), tocf(beta), intorder);
+                  }),
+         py::arg("space"), py::arg("alpha")=1.0, py::arg("beta")=py::none(),
+         py::arg("intorder")=-1,
+         "alpha .. diffusion coefficient, beta .. mass coefficient, None to skip the term\n"
+         "intorder .. integration order, default 2*order")
+    ;
+
   ///////////////////////////////// LinearForm //////////////////////////////////////////
 
   typedef LinearForm LF;
@@ -1824,7 +1874,14 @@ flags : dict
                     "  Smoother between multigrid levels, available options are:\n"
                     "    'point': Gauss-Seidel-Smoother\n"
                     "    'line':  Anisotropic smoother\n"
-                    "    'block': Block smoother";
+                    "    'block': Block smoother\n"
+                    "    'chebyshev': Chebyshev polynomial smoother";
+                  mg_flags["chebyshevdegree"] = "int = 2\n"
+                    "  Polynomial degree per smoothing step of the chebyshev smoother";
+                  mg_flags["chebyshevratio"] = "double = 30\n"
+                    "  Chebyshev smoother reduces the eigenvalues in [lmax/ratio, lmax]";
+                  mg_flags["eigensteps"] = "int = 10\n"
+                    "  Power iterations to estimate lmax for the chebyshev smoother";
                   return mg_flags;
                 })
     ;
@@ -2660,7 +2717,8 @@ flags : dict
 
    py::class_<BaseVTKOutput, shared_ptr<BaseVTKOutput>>(m, "VTKOutput")
     .def(py::init([] (shared_ptr<MeshAccess> ma, py::list coefs_list,
-                      py::list names_list, string filename, int subdivision, int only_element)
+                      py::list names_list, string filename, int subdivision, int only_element,
+                      string format, string encoding, bool compress)
          -> shared_ptr<BaseVTKOutput>
          {
            Array<shared_ptr<CoefficientFunction> > coefs
@@ -2669,9 +2727,11 @@ flags : dict
              = makeCArray<string> (names_list);
            shared_ptr<BaseVTKOutput> ret;
            if (ma->GetDimension() == 2)
-             ret = make_shared<VTKOutput<2>> (ma, coefs, names, filename, subdivision, only_element);
+             ret = make_shared<VTKOutput<2>> (ma, coefs, names, filename, subdivision, only_element,
+                                              format, encoding, compress);
            else
-             ret = make_shared<VTKOutput<3>> (ma, coefs, names, filename, subdivision, only_element);
+             ret = make_shared<VTKOutput<3>> (ma, coefs, names, filename, subdivision, only_element,
+                                              format, encoding, compress);
            return ret;
          }),
          py::arg("ma"),
@@ -2679,18 +2739,26 @@ flags : dict
          py::arg("names") = py::list(),
          py::arg("filename") = "vtkout",
          py::arg("subdivision") = 0,
-         py::arg("only_element") = -1
+         py::arg("only_element") = -1,
+         py::arg("format") = "vtk",
+         py::arg("encoding") = "raw",
+         py::arg("compress") = false,
+         "format 'vtk' writes legacy ascii files, format 'vtu' xml files\n"
+         "with 'ascii', 'base64' or 'raw' encoding and optional zlib compression,\n"
+         "one piece per MPI rank, and a .pvd collection of all timesteps"
          )
-     .def("Do", [](shared_ptr<BaseVTKOutput> self)
+     .def("Do", [](shared_ptr<BaseVTKOutput> self, double time)
           { 
-            self->Do(glh);
+            self->Do(glh, nullptr, time);
           },
+          py::arg("time") = -1,
           py::call_guard<py::gil_scoped_release>())
-     .def("Do", [](shared_ptr<BaseVTKOutput> self, const BitArray * drawelems)
+     .def("Do", [](shared_ptr<BaseVTKOutput> self, const BitArray * drawelems, double time)
           { 
-            self->Do(glh, drawelems);
+            self->Do(glh, drawelems, time);
           },
           py::arg("drawelems"),
+          py::arg("time") = -1,
           py::call_guard<py::gil_scoped_release>())
      ;
 
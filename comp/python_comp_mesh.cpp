@@ -262,8 +262,10 @@ mesh (netgen.Mesh): a mesh generated from Netgen
                         }
                       else
                         {
-                          auto str = make_shared<stringstream> (py::cast<string> (state[1]));
-                          BinaryInArchive ar(str);
+                          char * buffer;
+                          Py_ssize_t len;
+                          PyBytes_AsStringAndSize (state[1].ptr(), &buffer, &len);
+                          BinaryInArchive ar(FlatArray<char> (len, buffer));
                           auto ma = make_shared<MeshAccess>();
                           ma->ArchiveMesh(ar);
                           return ma;
@@ -0,0 +1,501 @@
+/*********************************************************************/
+/* File:   sumfactorization.cpp                                      */
+/* Date:   17. Oct. 2026                                             */
+/*********************************************************************/
+
+/*
+   matrix-free operator application by sum factorization
+*/
+
+#include <comp.hpp>
+
+namespace ngcomp
+{
+
+  /*
+    apply the 1D matrix a along direction dir of the tensor 'in'
+    with extents ext (first direction fastest). The extent ext[dir]
+    becomes a.Height() in the result.
+  */
+  static void ApplyAlong (FlatMatrix<> a, FlatVector<> in, FlatVector<> out,
+                          const int * ext, int dir)
+  {
+    size_t m = a.Height();
+    size_t e0 = ext[0], e1 = ext[1], e2 = ext[2];
+    switch (dir)
+      {
+      case 0:
+        {
+          FlatMatrix<> min(e1*e2, e0, in.Data());
+          FlatMatrix<> mout(e1*e2, m, out.Data());
+          mout = min * Trans(a);
+          break;
+        }
+      case 1:
+        for (size_t i2 = 0; i2 < e2; i2++)
+          {
+            FlatMatrix<> min(e1, e0, in.Data()+i2*e1*e0);
+            FlatMatrix<> mout(m, e0, out.Data()+i2*m*e0);
+            mout = a * min;
+          }
+        break;
+      case 2:
+        {
+          FlatMatrix<> min(e2, e0*e1, in.Data());
+          FlatMatrix<> mout(m, e0*e1, out.Data());
+          mout = a * min;
+          break;
+        }
+      }
+  }
+
+  /// Lagrange polynomials through nodes, and derivatives, evaluated at points
+  static void CalcLagrange1D (FlatArray<double> nodes, FlatArray<double> points,
+                              SliceMatrix<> shape, SliceMatrix<> dshape)
+  {
+    int n = nodes.Size();
+    for (int q = 0; q < points.Size(); q++)
+      {
+        double x = points[q];
+        for (int j = 0; j < n; j++)
+          {
+            double val = 1, dval = 0;
+            for (int k = 0; k < n; k++)
+              {
+                if (k == j) continue;
+                double fac = 1.0 / (nodes[j]-nodes[k]);
+                dval = dval * (x-nodes[k]) * fac + val * fac;
+                val *= (x-nodes[k]) * fac;
+              }
+            shape(q,j) = val;
+            dshape(q,j) = dval;
+          }
+      }
+  }
+
+  /*
+    Write the shapes, given by their values at the tensor product nodes
+    (columns of vals, first direction fastest), as products of 1D
+    functions. The m[d] distinct 1D functions of direction d are
+    stored in factors[d] by their nodal values. Shape k is scale[k]
+    times the product of the 1D functions at position index[k] of the
+    m[0] x m[1] x m[2] tensor. Returns false if some shape is not a
+    product of 1D functions.
+  */
+  static bool DecomposeTensorShapes (FlatMatrix<> vals, int nd1, int D,
+                                     Array<double> * factors, int * m,
+                                     FlatArray<int> index, FlatArray<double> scale)
+  {
+    int n[3] = { nd1, nd1, (D == 3) ? nd1 : 1 };
+    size_t ndof = vals.Width();
+    Array<int> pos(3*ndof);
+    for (int d = 0; d < 3; d++)
+      factors[d].SetSize0();
+
+    Vector<> f[3] = { Vector<>(n[0]), Vector<>(n[1]), Vector<>(n[2]) };
+    for (size_t k = 0; k < ndof; k++)
+      {
+        auto v = [&] (int i0, int i1, int i2) { return vals(i0+n[0]*(i1+n[1]*i2), k); };
+
+        // the product passes through the entry of maximal modulus
+        int p[3] = { 0, 0, 0 };
+        double vmax = 0;
+        for (int i2 = 0; i2 < n[2]; i2++)
+          for (int i1 = 0; i1 < n[1]; i1++)
+            for (int i0 = 0; i0 < n[0]; i0++)
+              if (fabs(v(i0,i1,i2)) > vmax)
+                {
+                  vmax = fabs(v(i0,i1,i2));
+                  p[0] = i0; p[1] = i1; p[2] = i2;
+                }
+        if (vmax == 0) return false;
+        double vp = v(p[0],p[1],p[2]);
+
+        double fac = 1.0 / (vp*vp);
+        for (int d = 0; d < 3; d++)
+          {
+            for (int i = 0; i < n[d]; i++)
+              {
+                int q[3] = { p[0], p[1], p[2] };
+                q[d] = i;
+                f[d](i) = v(q[0],q[1],q[2]);
+              }
+            // normalize by the first entry of maximal modulus
+            int imax = 0;
+            while (fabs(f[d](imax)) < (1-1e-8) * vmax) imax++;
+            double nrm = f[d](imax);
+            f[d] /= nrm;
+            fac *= nrm;
+          }
+
+        for (int i2 = 0; i2 < n[2]; i2++)
+          for (int i1 = 0; i1 < n[1]; i1++)
+            for (int i0 = 0; i0 < n[0]; i0++)
+              if (fabs(v(i0,i1,i2) - fac * f[0](i0)*f[1](i1)*f[2](i2)) > 1e-10 * vmax)
+                return false;
+
+        scale[k] = fac;
+        for (int d = 0; d < 3; d++)
+          {
+            size_t nf = factors[d].Size() / n[d];
+            size_t j = 0;
+            for ( ; j < nf; j++)
+              if (L2Norm (FlatVector<>(n[d], &factors[d][j*n[d]]) - f[d]) < 1e-8)
+                break;
+            if (j == nf)
+              for (int i = 0; i < n[d]; i++)
+                factors[d].Append (f[d](i));
+            pos[3*k+d] = j;
+          }
+      }
+
+    for (int d = 0; d < 3; d++)
+      m[d] = factors[d].Size() / n[d];
+    for (size_t k = 0; k < ndof; k++)
+      index[k] = pos[3*k] + m[0] * (pos[3*k+1] + m[1] * pos[3*k+2]);
+    return true;
+  }
+
+
+
+  SumFactorizationOperator ::
+  SumFactorizationOperator (shared_ptr<FESpace> afes,
+                            shared_ptr<CoefficientFunction> alpha,
+                            shared_ptr<CoefficientFunction> beta,
+                            int aorder)
+    : fes(afes), has_laplace(alpha != nullptr), has_mass(beta != nullptr)
+  {
+    static Timer t("SumFactorizationOperator - setup");
+    RegionTimer reg(t);
+
+    auto ma = fes->GetMeshAccess();
+    dim = ma->GetDimension();
+    if (dim != 2 && dim != 3)
+      throw Exception ("SumFactorizationOperator: needs a 2D or 3D mesh");
+    if (fes->IsComplex() || fes->GetDimension() != 1)
+      throw Exception ("SumFactorizationOperator: needs a real, scalar space");
+    if (!has_laplace && !has_mass)
+      throw Exception ("SumFactorizationOperator: neither alpha nor beta given");
+    if (fes->VarOrder())
+      throw Exception ("SumFactorizationOperator: needs a space of uniform order");
+
+    ELEMENT_TYPE et = (dim == 2) ? ET_QUAD : ET_HEX;
+    size_t ne = ma->GetNE(VOL);
+    LocalHeap lh(10*1000*1000, "sumfactorization-setup");
+
+    int order = 0;
+    for (size_t i = 0; i < ne; i++)
+      {
+        HeapReset hr(lh);
+        ElementId ei(VOL, i);
+        if (ma->GetElType(ei) != et)
+          throw Exception ("SumFactorizationOperator: only quadrilateral and hexahedral meshes are supported");
+        order = max(order, fes->GetFE(ei, lh).Order());
+      }
+
+    nd1 = order+1;
+    nq = (aorder >= 0) ? aorder/2+1 : order+1;
+    size_t nnodes = (dim == 2) ? nd1*nd1 : nd1*nd1*nd1;
+    npts = (dim == 2) ? nq*nq : nq*nq*nq;
+    nblocks = (npts + SIMD<double>::Size()-1) / SIMD<double>::Size();
+
+    Array<double> xnodes, wnodes, xq, wq;
+    if (nd1 == 1)
+      {
+        xnodes.SetSize(1);
+        xnodes[0] = 0.5;
+      }
+    else
+      ComputeGaussLobattoRule (nd1, xnodes, wnodes);
+    ComputeGaussRule (nq, xq, wq);
+
+    // 1D Lagrange basis at Gauss points
+    Matrix<> shape1d(nq, nd1), dshape1d(nq, nd1);
+    CalcLagrange1D (xnodes, xq, shape1d, dshape1d);
+
+    // tensor product nodes and Gauss points, first direction fastest
+    IntegrationRule irnodes, ir;
+    for (int k = 0; k < ((dim == 3) ? nd1 : 1); k++)
+      for (int j = 0; j < nd1; j++)
+        for (int i = 0; i < nd1; i++)
+          irnodes.Append (IntegrationPoint (xnodes[i], xnodes[j], (dim == 3) ? xnodes[k] : 0, 0));
+    for (int k = 0; k < ((dim == 3) ? nq : 1); k++)
+      for (int j = 0; j < nq; j++)
+        for (int i = 0; i < nq; i++)
+          ir.Append (IntegrationPoint (xq[i], xq[j], (dim == 3) ? xq[k] : 0,
+                                       wq[i]*wq[j]*((dim == 3) ? wq[k] : 1)));
+
+    // element shapes depend on the ordering of the element vertices only
+    element_factors.SetSize (ne);
+    map<size_t,int> factors_of_key;
+    Array<DofId> dnums;
+    size_t maxext = nq;
+    for (size_t i = 0; i < ne; i++)
+      {
+        HeapReset hr(lh);
+        ElementId ei(VOL, i);
+        auto vnums = ma->GetElVertices (ei);
+        size_t key = 0;
+        for (size_t j = vnums.Size(); j-- > 0; )
+          {
+            int rank = 0;
+            for (size_t k = 0; k < vnums.Size(); k++)
+              if (vnums[k] < vnums[j]) rank++;
+            key = key * vnums.Size() + rank;
+          }
+
+        fes->GetDofNrs (ei, dnums);
+        auto pos = factors_of_key.find (key);
+        if (pos != factors_of_key.end())
+          {
+            element_factors[i] = pos->second;
+            if (dnums.Size() != factors[pos->second]->index.Size())
+              throw Exception ("SumFactorizationOperator: elements of equal vertex ordering have different ndof");
+            continue;
+          }
+
+        auto & fel = dynamic_cast<const BaseScalarFiniteElement&> (fes->GetFE(ei, lh));
+        size_t ndof = fel.GetNDof();
+        if (dnums.Size() != ndof)
+          throw Exception ("SumFactorizationOperator: needs one dof per element shape");
+
+        Matrix<> vals(nnodes, ndof);
+        for (size_t k = 0; k < nnodes; k++)
+          fel.CalcShape (irnodes[k], vals.Row(k));
+
+        auto tf = make_shared<TensorFactors>();
+        tf->index.SetSize (ndof);
+        tf->scale.SetSize (ndof);
+        Array<double> nodal[3];
+        if (!DecomposeTensorShapes (vals, nd1, dim, nodal, tf->m, tf->index, tf->scale))
+          throw Exception ("SumFactorizationOperator: element shapes are not products of 1D functions");
+
+        // evaluate the 1D functions at the Gauss points by nodal interpolation
+        for (int d = 0; d < dim; d++)
+          {
+            int m = tf->m[d];
+            FlatMatrix<> fnodal(m, nd1, &nodal[d][0]);
+            tf->shape[d].SetSize (nq, m);
+            tf->dshape[d].SetSize (nq, m);
+            tf->shape[d] = shape1d * Trans(fnodal);
+            tf->dshape[d] = dshape1d * Trans(fnodal);
+            tf->shape_trans[d].SetSize (m, nq);
+            tf->dshape_trans[d].SetSize (m, nq);
+            tf->shape_trans[d] = Trans(tf->shape[d]);
+            tf->dshape_trans[d] = Trans(tf->dshape[d]);
+            maxext = max (maxext, size_t(m));
+          }
+
+        element_factors[i] = factors.Size();
+        factors_of_key[key] = factors.Size();
+        factors.Append (tf);
+      }
+
+    // largest intermediate tensor of the 1D contractions
+    bufsize = (dim == 2) ? maxext*maxext : maxext*maxext*maxext;
+    bufsize = max (bufsize, nblocks*SIMD<double>::Size());
+
+    cout << IM(3) << "SumFactorizationOperator: order = " << order
+         << ", points per direction = " << nq
+         << ", vertex orderings = " << factors.Size() << endl;
+
+    if (dim == 2)
+      SetupGeometry<2> (alpha, beta, ir);
+    else
+      SetupGeometry<3> (alpha, beta, ir);
+  }
+
+  SumFactorizationOperator :: ~SumFactorizationOperator ()
+  { ; }
+
+
+  template <int D>
+  void SumFactorizationOperator ::
+  SetupGeometry (shared_ptr<CoefficientFunction> alpha,
+                 shared_ptr<CoefficientFunction> beta,
+                 const IntegrationRule & ir)
+  {
+    auto ma = fes->GetMeshAccess();
+    size_t ne = ma->GetNE(VOL);
+    ngeom = 1 + D*(D+1)/2;
+    geom.SetSize (ne*ngeom*nblocks);
+
+    SIMD_IntegrationRule simd_ir(ir);
+    LocalHeap clh(1000*1000*TaskManager::GetMaxThreads(), "sumfactorization-geometry");
+
+    ParallelForRange
+      (IntRange(ne), [&] (IntRange r)
+       {
+         LocalHeap slh = clh.Split();
+         for (size_t i : r)
+           {
+             HeapReset hr(slh);
+             ElementTransformation & trafo = ma->GetTrafo (ElementId(VOL, i), slh);
+             auto & mir = static_cast<SIMD_MappedIntegrationRule<D,D>&> (trafo(simd_ir, slh));
+
+             FlatMatrix<SIMD<double>> alphavals(1, nblocks, slh), betavals(1, nblocks, slh);
+             if (alpha) alpha->Evaluate (mir, alphavals);
+             if (beta) beta->Evaluate (mir, betavals);
+
+             SIMD<double> * g = &geom[i*ngeom*nblocks];
+             for (size_t k = 0; k < nblocks; k++)
+               {
+                 SIMD<double> w = mir[k].GetWeight();
+                 g[k] = beta ? w * betavals(0,k) : SIMD<double>(0.0);
+
+                 auto jacinv = mir[k].GetJacobianInverse();
+                 SIMD<double> wa = alpha ? w * alphavals(0,k) : SIMD<double>(0.0);
+                 int c = 1;
+                 for (int a = 0; a < D; a++)
+                   for (int b = a; b < D; b++, c++)
+                     {
+                       SIMD<double> sum(0.0);
+                       for (int l = 0; l < D; l++)
+                         sum += jacinv(a,l) * jacinv(b,l);
+                       g[c*nblocks+k] = wa * sum;
+                     }
+               }
+           }
+       });
+  }
+
+
+  template <int D>
+  void SumFactorizationOperator ::
+  ApplyElement (size_t elnr, FlatVector<> fx, FlatVector<> fy,
+                double s, LocalHeap & lh) const
+  {
+    constexpr int SW = SIMD<double>::Size();
+
+    ArrayMem<DofId,128> dnums;
+    fes->GetDofNrs (ElementId(VOL, elnr), dnums);
+    const TensorFactors & tf = *factors[element_factors[elnr]];
+    size_t ncoef = tf.m[0] * tf.m[1] * tf.m[2];
+
+    FlatVector<> ue(ncoef, lh), re(ncoef, lh);
+    FlatVector<> buf1(bufsize, lh), buf2(bufsize, lh);
+    FlatMatrix<> qp(D+1, nblocks*SW, lh);
+
+    ue = 0.0;
+    for (size_t i = 0; i < dnums.Size(); i++)
+      if (dnums[i] >= 0)
+        ue(tf.index[i]) += tf.scale[i] * fx(dnums[i]);
+
+    // interpolate values (c = 0) and reference gradients (c = 1..D) to Gauss points
+    for (int c = 0; c <= D; c++)
+      {
+        if ( (c == 0 && !has_mass) || (c > 0 && !has_laplace) ) continue;
+        int ext[3] = { tf.m[0], tf.m[1], tf.m[2] };
+        FlatVector<> in = ue;
+        for (int dir = 0; dir < D; dir++)
+          {
+            FlatVector<> out = (dir == D-1) ? FlatVector<>(qp.Row(c)) : ((dir % 2 == 0) ? buf1 : buf2);
+            ApplyAlong ((c == dir+1) ? tf.dshape[dir] : tf.shape[dir], in, out, ext, dir);
+            ext[dir] = nq;
+            in.AssignMemory (out.Size(), out.Data());
+          }
+      }
+
+    // geometry and coefficients at Gauss points
+    const SIMD<double> * g = &geom[elnr*ngeom*nblocks];
+    for (size_t k = 0; k < nblocks; k++)
+      {
+        if (has_mass)
+          {
+            SIMD<double> u(&qp(0, k*SW));
+            (g[k] * u).Store (&qp(0, k*SW));
+          }
+        if (has_laplace)
+          {
+            Vec<D,SIMD<double>> grad, flux;
+            for (int a = 0; a < D; a++)
+              {
+                grad(a) = SIMD<double> (&qp(a+1, k*SW));
+                flux(a) = SIMD<double> (0.0);
+              }
+            int c = 1;
+            for (int a = 0; a < D; a++)
+              for (int b = a; b < D; b++, c++)
+                {
+                  SIMD<double> gab = g[c*nblocks+k];
+                  flux(a) += gab * grad(b);
+                  if (a != b) flux(b) += gab * grad(a);
+                }
+            for (int a = 0; a < D; a++)
+              flux(a).Store (&qp(a+1, k*SW));
+          }
+      }
+
+    // transposed interpolation back to the 1D functions
+    re = 0.0;
+    for (int c = 0; c <= D; c++)
+      {
+        if ( (c == 0 && !has_mass) || (c > 0 && !has_laplace) ) continue;
+        int ext[3] = { nq, nq, (D == 3) ? nq : 1 };
+        FlatVector<> in = qp.Row(c);
+        for (int dir = 0; dir < D; dir++)
+          {
+            FlatVector<> out = (dir % 2 == 0) ? buf1 : buf2;
+            ApplyAlong ((c == dir+1) ? tf.dshape_trans[dir] : tf.shape_trans[dir], in, out, ext, dir);
+            ext[dir] = tf.m[dir];
+            in.AssignMemory (out.Size(), out.Data());
+          }
+        re += in.Range(0, ncoef);
+      }
+
+    for (size_t i = 0; i < dnums.Size(); i++)
+      if (dnums[i] >= 0)
+        fy(dnums[i]) += s * tf.scale[i] * re(tf.index[i]);
+  }
+
+
+  void SumFactorizationOperator ::
+  MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SumFactorizationOperator::MultAdd");
+    RegionTimer reg(t);
+
+    x.Cumulate();
+    y.Distribute();
+
+    FlatVector<> fx = x.FV<double>();
+    FlatVector<> fy = y.FV<double>();
+
+    size_t heapsize = (dim+5) * bufsize * sizeof(double) + 10000;
+    LocalHeap clh(heapsize*TaskManager::GetMaxThreads(), "sumfactorization-apply");
+
+    // elements of one color share no dofs
+    for (FlatArray<int> els_of_col : fes->ElementColoring(VOL))
+      ParallelForRange
+        (IntRange(els_of_col.Size()), [&] (IntRange r)
+         {
+           LocalHeap lh = clh.Split();
+           for (int el : els_of_col.Range(r))
+             {
+               HeapReset hr(lh);
+               if (dim == 2)
+                 ApplyElement<2> (el, fx, fy, s, lh);
+               else
+                 ApplyElement<3> (el, fx, fy, s, lh);
+             }
+         });
+  }
+
+  void SumFactorizationOperator ::
+  Mult (const BaseVector & x, BaseVector & y) const
+  {
+    y = 0.0;
+    MultAdd (1, x, y);
+  }
+
+  AutoVector SumFactorizationOperator :: CreateVector () const
+  {
+#ifdef PARALLEL
+    if (fes->IsParallel())
+      return make_shared<ParallelVVector<double>> (fes->GetNDof(), fes->GetParallelDofs());
+    else
+#endif
+      return make_shared<VVector<double>> (fes->GetNDof());
+  }
+
+}
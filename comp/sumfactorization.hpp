@@ -0,0 +1,80 @@
+#ifndef FILE_SUMFACTORIZATION
+#define FILE_SUMFACTORIZATION
+
+/*********************************************************************/
+/* File:   sumfactorization.hpp                                      */
+/* Date:   17. Oct. 2026                                             */
+/*********************************************************************/
+
+namespace ngcomp
+{
+
+  /**
+     Matrix-free application of
+       \int alpha \nabla u \nabla v + beta u v
+     for H1 and L2 spaces on quadrilateral and hexahedral meshes.
+
+     The element shapes are products of 1D functions. Element vectors
+     are interpolated to tensor product Gauss points by 1D contractions
+     (sum factorization). Geometry and coefficients are evaluated once
+     at the Gauss points.
+   */
+  class NGS_DLL_HEADER SumFactorizationOperator : public BaseMatrix
+  {
+    /// the 1D factors of the element shapes, for one vertex ordering
+    struct TensorFactors
+    {
+      /// number of 1D functions per direction
+      int m[3];
+      /// 1D functions and derivatives at Gauss points (nq x m), and transposes
+      Matrix<> shape[3], dshape[3], shape_trans[3], dshape_trans[3];
+      /// per element dof: position in the m[0] x m[1] x m[2] tensor, and factor
+      Array<int> index;
+      Array<double> scale;
+    };
+
+    shared_ptr<FESpace> fes;
+    int dim;
+    /// nodes and quadrature points per direction
+    int nd1, nq;
+    size_t npts, nblocks, bufsize;
+    bool has_laplace, has_mass;
+
+    /// shared by elements of same vertex ordering
+    Array<shared_ptr<TensorFactors>> factors;
+    Array<int> element_factors;
+
+    /// per element: mass weight and symmetric metric at Gauss points
+    int ngeom;
+    Array<SIMD<double>> geom;
+
+  public:
+    SumFactorizationOperator (shared_ptr<FESpace> afes,
+                              shared_ptr<CoefficientFunction> alpha,
+                              shared_ptr<CoefficientFunction> beta,
+                              int aorder = -1);
+    virtual ~SumFactorizationOperator ();
+
+    virtual bool IsComplex() const override { return false; }
+    virtual int VHeight() const override { return fes->GetNDof(); }
+    virtual int VWidth() const override { return fes->GetNDof(); }
+    virtual AutoVector CreateVector () const override;
+
+    virtual void Mult (const BaseVector & x, BaseVector & y) const override;
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override
+    { MultAdd (s, x, y); }
+
+  private:
+    template <int D>
+    void SetupGeometry (shared_ptr<CoefficientFunction> alpha,
+                        shared_ptr<CoefficientFunction> beta,
+                        const IntegrationRule & ir);
+    template <int D>
+    void ApplyElement (size_t elnr, FlatVector<> x, FlatVector<> y,
+                       double s, LocalHeap & lh) const;
+  };
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 /*********************************************************************/
 
 #include <comp.hpp>
+#include <zlib.h>
 
 namespace ngcomp
 { 
@@ -19,7 +20,10 @@ namespace ngcomp
                 flags.GetStringListFlag ("fieldnames" ),
                 flags.GetStringFlag ("filename","output"),
                 (int) flags.GetNumFlag ( "subdivision", 0),
-                (int) flags.GetNumFlag ( "only_element", -1))
+                (int) flags.GetNumFlag ( "only_element", -1),
+                flags.GetStringFlag ("format","vtk"),
+                flags.GetStringFlag ("encoding","raw"),
+                flags.GetDefineFlag ("compress"))
   {;}
 
 
@@ -27,10 +31,17 @@ namespace ngcomp
   VTKOutput<D>::VTKOutput (shared_ptr<MeshAccess> ama,
                            const Array<shared_ptr<CoefficientFunction>> & a_coefs,
                            const Array<string> & a_field_names,
-                           string a_filename, int a_subdivision, int a_only_element)
+                           string a_filename, int a_subdivision, int a_only_element,
+                           string a_format, string a_encoding, bool a_compress)
     : ma(ama), coefs(a_coefs), fieldnames(a_field_names),
-      filename(a_filename), subdivision(a_subdivision), only_element(a_only_element)
+      filename(a_filename), subdivision(a_subdivision), only_element(a_only_element),
+      format(a_format), encoding(a_encoding), compress(a_compress)
   {
+    if (format != "vtk" && format != "vtu")
+      throw Exception ("VTKOutput: unknown format '"+format+"', use 'vtk' or 'vtu'");
+    if (encoding != "ascii" && encoding != "base64" && encoding != "raw")
+      throw Exception ("VTKOutput: unknown encoding '"+encoding+"', use 'ascii', 'base64' or 'raw'");
+
     value_field.SetSize(a_coefs.Size());
     for (int i = 0; i < a_coefs.Size(); i++)
       if (fieldnames.Size() > i)
@@ -46,6 +57,7 @@ namespace ngcomp
   {
     points.SetSize(0);
     cells.SetSize(0);
+    celltypes.SetSize(0);
     for (auto field : value_field)
       field->SetSize(0);
   }
@@ -347,42 +359,13 @@ namespace ngcomp
     }
   }
 
-  /// output of cell types (here only simplices)
+  /// output of cell types
   template <int D> 
   void VTKOutput<D>::PrintCellTypes()
   {
     *fileout << "CELL_TYPES " << cells.Size() << endl;
-    int factor = (1<<subdivision)*(1<<subdivision);
-    if (D==3)
-      factor *= (1<<subdivision);
-    for (auto e : ma->Elements(VOL))
-    {
-      switch(ma->GetElType(e))
-      {
-      case ET_TET:
-        for(int i=0; i<factor; i++)
-          *fileout << "10 " << endl; //(void)c;
-        break;
-      case ET_QUAD:
-        for(int i=0; i<factor; i++)
-          *fileout << "9 " << endl;
-        break;
-      case ET_TRIG:
-        for(int i=0; i<factor; i++)
-          *fileout << "5 " << endl;
-        break;
-      case ET_PRISM:
-        for(int i=0; i<factor; i++)
-          *fileout << "13 " << endl;
-        break;
-      case ET_HEX:
-        for(int i=0; i<factor; i++)
-          *fileout << "12 " << endl;
-        break;        
-      default:
-        cout << "VTKOutput Element Type " << ma->GetElType(e) << " not supported!" << endl;
-      }
-    }
+    for (auto type : celltypes)
+      *fileout << int(type) << " " << endl;
     *fileout << "CELL_DATA " << cells.Size() << endl;
     *fileout << "POINT_DATA " << points.Size() << endl;
   }
@@ -406,122 +389,506 @@ namespace ngcomp
   }
     
 
-  template <int D> 
-  void VTKOutput<D>::Do (LocalHeap & lh, const BitArray * drawelems)
+  /// file name without directory, for references between output files
+  static string BaseName (const string & path)
   {
-    ostringstream filenamefinal;
-    filenamefinal << filename;
-    if (output_cnt > 0)
-      filenamefinal << "_" << output_cnt;
-    filenamefinal << ".vtk";
-    fileout = make_shared<ofstream>(filenamefinal.str());
-    cout << " Writing VTK-Output";
-    if (output_cnt > 0)
-      cout << " ( " << output_cnt << " )";
-    cout << ":" << flush;
-    
-    output_cnt++;
+    size_t pos = path.find_last_of ("/\\");
+    return (pos == string::npos) ? path : path.substr (pos+1);
+  }
+
+  static string Base64 (FlatArray<char> data)
+  {
+    static const char table[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t n = data.Size();
+    size_t ntriples = (n+2) / 3;
+    string res(4*ntriples, '=');
+    ParallelForRange
+      (IntRange(ntriples), [&] (IntRange r)
+       {
+         for (size_t i : r)
+           {
+             size_t first = 3*i;
+             size_t len = min2 (n-first, size_t(3));
+             unsigned char b[3] = { 0, 0, 0 };
+             for (size_t k = 0; k < len; k++)
+               b[k] = data[first+k];
+             uint32_t triple = (uint32_t(b[0]) << 16) | (uint32_t(b[1]) << 8) | b[2];
+             res[4*i]   = table[(triple >> 18) & 63];
+             res[4*i+1] = table[(triple >> 12) & 63];
+             if (len > 1) res[4*i+2] = table[(triple >> 6) & 63];
+             if (len > 2) res[4*i+3] = table[triple & 63];
+           }
+       });
+    return res;
+  }
+
+  template <typename T>
+  static FlatArray<char> Bytes (FlatArray<T> a)
+  {
+    return FlatArray<char> (a.Size()*sizeof(T), 
+                            a.Size() ? reinterpret_cast<char*> (&a[0]) : nullptr);
+  }
+
+  template <typename T>
+  static void WriteAsciiValues (ostream & out, FlatArray<char> raw, int ncomp)
+  {
+    FlatArray<T> values(raw.Size()/sizeof(T), 
+                        raw.Size() ? reinterpret_cast<T*> (&raw[0]) : nullptr);
+    for (size_t i = 0; i < values.Size(); i++)
+      {
+        if (is_same<T,unsigned char>::value)
+          out << int(values[i]);
+        else
+          out << values[i];
+        out << (((i+1) % ncomp == 0) ? '\n' : ' ');
+      }
+  }
+
+
+  /**
+     A data array of a vtu piece. Binary data is stored with an UInt64
+     header, zlib compressed data in blocks as expected by
+     vtkZLibDataCompressor.
+  */
+  class VTUDataArray
+  {
+  public:
+    string name, type;
+    int ncomp = 1;
+    FlatArray<char> raw;
+    Array<uint64_t> header;
+    Array<char> zdata;
+    bool zipped = false;
+    /// position in the appended data section
+    size_t offset = 0;
+
+    void Set (string aname, string atype, int ancomp, FlatArray<char> araw)
+    {
+      name = aname; type = atype; ncomp = ancomp; raw.Assign(araw);
+    }
+
+    void Encode (bool zip)
+    {
+      zipped = zip;
+      if (!zip)
+        {
+          header.SetSize(1);
+          header[0] = raw.Size();
+          return;
+        }
+
+      static Timer t("VTKOutput::Compress"); RegionTimer reg(t);
+      constexpr size_t blocksize = 1 << 15;
+      size_t nblocks = (raw.Size()+blocksize-1) / blocksize;
+      header.SetSize (3+nblocks);
+      header[0] = nblocks;
+      header[1] = blocksize;
+      header[2] = nblocks ? raw.Size()-(nblocks-1)*blocksize : 0;
+
+      size_t bound = compressBound (blocksize);
+      Array<char> buffer(nblocks*bound);
+      atomic<bool> failed(false);
+      ParallelFor (nblocks, [&] (size_t i)
+                   {
+                     FlatArray<char> block = raw.Range (i*blocksize, min2(raw.Size(), (i+1)*blocksize));
+                     uLongf len = bound;
+                     if (compress2 (reinterpret_cast<Bytef*> (&buffer[i*bound]), &len,
+                                    reinterpret_cast<const Bytef*> (&block[0]), block.Size(),
+                                    Z_DEFAULT_COMPRESSION) != Z_OK)
+                       failed = true;
+                     header[3+i] = len;
+                   });
+      if (failed)
+        throw Exception ("VTKOutput: zlib compression of '"+name+"' failed");
+
+      Array<size_t> first(nblocks+1);
+      first[0] = 0;
+      for (size_t i = 0; i < nblocks; i++)
+        first[i+1] = first[i] + header[3+i];
+      zdata.SetSize (first[nblocks]);
+      ParallelFor (nblocks, [&] (size_t i)
+                   {
+                     memcpy (&zdata[first[i]], &buffer[i*bound], header[3+i]);
+                   });
+    }
+
+    FlatArray<char> Payload () const { return zipped ? FlatArray<char>(zdata) : raw; }
+
+    size_t AppendedSize () const { return header.Size()*sizeof(uint64_t) + Payload().Size(); }
+
+    void WriteRaw (ostream & out) const
+    {
+      out.write (reinterpret_cast<const char*> (&header[0]), header.Size()*sizeof(uint64_t));
+      if (Payload().Size())
+        out.write (&Payload()[0], Payload().Size());
+    }
+
+    void WriteBase64 (ostream & out) const
+    {
+      FlatArray<char> hbytes(header.Size()*sizeof(uint64_t),
+                             reinterpret_cast<char*> (&header[0]));
+      if (zipped)
+        {
+          // compressed data: header and blocks are encoded separately
+          out << Base64 (hbytes) << Base64 (zdata);
+          return;
+        }
+      Array<char> all(hbytes.Size()+raw.Size());
+      all.Range(0, hbytes.Size()) = hbytes;
+      all.Range(hbytes.Size(), all.Size()) = raw;
+      out << Base64 (all);
+    }
+
+    void WriteAscii (ostream & out) const
+    {
+      if (type == "Float32")
+        WriteAsciiValues<float> (out, raw, ncomp);
+      else if (type == "Int32")
+        WriteAsciiValues<int> (out, raw, ncomp);
+      else
+        WriteAsciiValues<unsigned char> (out, raw, ncomp);
+    }
+  };
+  
+
+  template <int D>
+  void VTKOutput<D>::FillData (LocalHeap & lh, const BitArray * drawelems)
+  {
+    static Timer t("VTKOutput::FillData"); RegionTimer reg(t);
+    typedef INT<ELEMENT_MAXPOINTS+1> T_CELL;
 
     ResetArrays();
 
     Array<IntegrationPoint> ref_vertices_tet(0), ref_vertices_prism(0), ref_vertices_trig(0), ref_vertices_quad(0), ref_vertices_hex(0);
-    Array<INT<ELEMENT_MAXPOINTS+1>> ref_tets(0), ref_prisms(0), ref_trigs(0), ref_quads(0), ref_hexes(0);
-    FlatArray<IntegrationPoint> ref_vertices;
-    FlatArray<INT<ELEMENT_MAXPOINTS+1>> ref_elems;
-    /*
-    if (D==3)
-      FillReferenceData3D(ref_vertices,ref_tets);
-    else
-      FillReferenceData2D(ref_vertices,ref_tets);
-    */
+    Array<T_CELL> ref_tets(0), ref_prisms(0), ref_trigs(0), ref_quads(0), ref_hexes(0);
     FillReferenceTet(ref_vertices_tet,ref_tets);
     FillReferencePrism(ref_vertices_prism,ref_prisms);
     FillReferenceQuad(ref_vertices_quad,ref_quads);
     FillReferenceTrig(ref_vertices_trig,ref_trigs);
     FillReferenceHex(ref_vertices_hex,ref_hexes);
-      
-    // header:
-    *fileout << "# vtk DataFile Version 3.0" << endl;
-    *fileout << "vtk output" << endl;
-    *fileout << "ASCII" << endl;
-    *fileout << "DATASET UNSTRUCTURED_GRID" << endl;
 
-    int ne = ma->GetNE();
+    // reference lattice and vtk cell type of an element type
+    typedef tuple<FlatArray<IntegrationPoint>, FlatArray<T_CELL>, unsigned char> T_REFERENCE;
+    auto reference = [&] (ELEMENT_TYPE eltype) -> T_REFERENCE
+      {
+        switch(eltype)
+          {
+          case ET_TRIG:  return T_REFERENCE (ref_vertices_trig, ref_trigs, 5);
+          case ET_QUAD:  return T_REFERENCE (ref_vertices_quad, ref_quads, 9);
+          case ET_TET:   return T_REFERENCE (ref_vertices_tet, ref_tets, 10);
+          case ET_HEX:   return T_REFERENCE (ref_vertices_hex, ref_hexes, 12);
+          case ET_PRISM: return T_REFERENCE (ref_vertices_prism, ref_prisms, 13);
+          default:
+            throw Exception("VTK output for element-type"+ToString(eltype)+"not supported");
+          }
+      };
 
+    int ne = ma->GetNE();
     IntRange range = only_element >= 0 ? IntRange(only_element,only_element+1) : IntRange(ne);
-    
-    for ( int elnr : range)
-    {
-      if (drawelems && !(drawelems->Test(elnr)))
-          continue;
-      
-      HeapReset hr(lh);
 
-      ElementId ei(VOL, elnr);
-      ElementTransformation & eltrans = ma->GetTrafo (ei, lh);
-      ELEMENT_TYPE eltype = ma->GetElType(ei);
+    Array<int> elnrs;
+    for (int elnr : range)
+      if (!drawelems || drawelems->Test(elnr))
+        elnrs.Append (elnr);
 
-      switch(eltype)
+    // every element gets a contiguous range of points and cells
+    Array<size_t> firstpoint(elnrs.Size()+1), firstcell(elnrs.Size()+1);
+    firstpoint[0] = firstcell[0] = 0;
+    for (size_t i = 0; i < elnrs.Size(); i++)
       {
-      case ET_TRIG:
-        ref_vertices.Assign(ref_vertices_trig);
-        ref_elems.Assign(ref_trigs);
-        break;
-      case ET_QUAD:
-        ref_vertices.Assign(ref_vertices_quad);
-        ref_elems.Assign(ref_quads);
-        break;
-      case ET_TET:
-        ref_vertices.Assign(ref_vertices_tet);
-        ref_elems.Assign(ref_tets);
-        break;
-      case ET_HEX:
-        ref_vertices.Assign(ref_vertices_hex);
-        ref_elems.Assign(ref_hexes);
-        break;        
-      case ET_PRISM:
-        ref_vertices.Assign(ref_vertices_prism);
-        ref_elems.Assign(ref_prisms);
-        break;
-      default:
-        throw Exception("VTK output for element-type"+ToString(eltype)+"not supported");
+        auto ref = reference (ma->GetElType (ElementId(VOL, elnrs[i])));
+        firstpoint[i+1] = firstpoint[i] + get<0>(ref).Size();
+        firstcell[i+1] = firstcell[i] + get<1>(ref).Size();
       }
 
-      int offset = points.Size();
-      for ( auto ip : ref_vertices)
+    points.SetSize (firstpoint.Last());
+    cells.SetSize (firstcell.Last());
+    celltypes.SetSize (firstcell.Last());
+    for (auto field : value_field)
+      field->SetSize (field->Dimension()*points.Size());
+
+    ParallelForRange
+      (IntRange(elnrs.Size()), [&] (IntRange r)
+       {
+         LocalHeap slh = lh.Split();
+         for (size_t i : r)
+           {
+             HeapReset hr(slh);
+             ElementId ei(VOL, elnrs[i]);
+             ElementTransformation & eltrans = ma->GetTrafo (ei, slh);
+             auto ref = reference (ma->GetElType(ei));
+             FlatArray<IntegrationPoint> ref_vertices = get<0>(ref);
+             FlatArray<T_CELL> ref_elems = get<1>(ref);
+
+             IntegrationRule ir(ref_vertices.Size(), &ref_vertices[0]);
+             MappedIntegrationRule<D,D> mir(ir, eltrans, slh);
+
+             size_t offset = firstpoint[i];
+             for (size_t k = 0; k < mir.Size(); k++)
+               points[offset+k] = mir[k].GetPoint();
+
+             for (size_t j = 0; j < coefs.Size(); j++)
+               {
+                 const int dim = coefs[j]->Dimension();
+                 FlatMatrix<> values(mir.Size(), dim, slh);
+                 coefs[j]->Evaluate (mir, values);
+                 FlatArray<double> field = *value_field[j];
+                 for (size_t k = 0; k < mir.Size(); k++)
+                   for (int d = 0; d < dim; d++)
+                     field[dim*(offset+k)+d] = values(k,d);
+               }
+
+             for (size_t k = 0; k < ref_elems.Size(); k++)
+               {
+                 T_CELL new_elem = ref_elems[k];
+                 for (int l = 1; l <= new_elem[0]; ++l)
+                   new_elem[l] += offset;
+                 cells[firstcell[i]+k] = new_elem;
+                 celltypes[firstcell[i]+k] = get<2>(ref);
+               }
+           }
+       });
+  }
+
+
+  template <int D>
+  void VTKOutput<D>::WriteVTU (const string & vtuname)
+  {
+    static Timer t("VTKOutput::WriteVTU"); RegionTimer reg(t);
+
+    size_t np = points.Size();
+    size_t nc = cells.Size();
+
+    Array<float> pts(3*np);
+    ParallelForRange
+      (IntRange(np), [&] (IntRange r)
+       {
+         for (size_t i : r)
+           for (int j = 0; j < 3; j++)
+             pts[3*i+j] = (j < D) ? points[i](j) : 0.0;
+       });
+
+    Array<int> offsets(nc);
+    size_t nconn = 0;
+    for (size_t i = 0; i < nc; i++)
       {
-        MappedIntegrationPoint<D,D> mip(ip, eltrans);
-        points.Append(mip.GetPoint());
+        nconn += cells[i][0];
+        offsets[i] = nconn;
       }
-      
-      for (int i = 0; i < coefs.Size(); i++)
+
+    Array<int> connectivity(nconn);
+    ParallelForRange
+      (IntRange(nc), [&] (IntRange r)
+       {
+         for (size_t i : r)
+           {
+             int first = offsets[i]-cells[i][0];
+             for (int j = 0; j < cells[i][0]; j++)
+               connectivity[first+j] = cells[i][j+1];
+           }
+       });
+
+    Array<Array<float>> fieldvalues(value_field.Size());
+    for (size_t j = 0; j < value_field.Size(); j++)
       {
-        for ( auto ip : ref_vertices)
+        FlatArray<double> field = *value_field[j];
+        fieldvalues[j].SetSize (field.Size());
+        ParallelForRange
+          (IntRange(field.Size()), [&] (IntRange r)
+           {
+             for (size_t i : r)
+               fieldvalues[j][i] = field[i];
+           });
+      }
+
+    size_t nf = value_field.Size();
+    Array<VTUDataArray> arrays(nf+4);
+    for (size_t j = 0; j < nf; j++)
+      arrays[j].Set (value_field[j]->Name(), "Float32", value_field[j]->Dimension(), Bytes<float>(fieldvalues[j]));
+    arrays[nf].Set ("Points", "Float32", 3, Bytes<float>(pts));
+    arrays[nf+1].Set ("connectivity", "Int32", 1, Bytes<int>(connectivity));
+    arrays[nf+2].Set ("offsets", "Int32", 1, Bytes<int>(offsets));
+    arrays[nf+3].Set ("types", "UInt8", 1, Bytes<unsigned char>(celltypes));
+
+    bool zip = compress && encoding != "ascii";
+    size_t appended = 0;
+    if (encoding != "ascii")
+      for (auto & a : arrays)
         {
-          MappedIntegrationPoint<D,D> mip(ip, eltrans);
-          const int dim = coefs[i]->Dimension();
-          FlatVector<> tmp(dim,lh);
-          coefs[i]->Evaluate(mip,tmp);
-          for (int d = 0; d < dim; ++d)
-            value_field[i]->Append(tmp(d));
+          a.Encode (zip);
+          a.offset = appended;
+          appended += a.AppendedSize();
         }
+
+    ofstream out(vtuname, ios::binary);
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+    if (zip)
+      out << " compressor=\"vtkZLibDataCompressor\"";
+    out << ">\n"
+        << "  <UnstructuredGrid>\n"
+        << "    <Piece NumberOfPoints=\"" << np << "\" NumberOfCells=\"" << nc << "\">\n";
+
+    auto write_array = [&] (const VTUDataArray & a)
+      {
+        out << "        <DataArray type=\"" << a.type << "\" Name=\"" << a.name
+            << "\" NumberOfComponents=\"" << a.ncomp << "\" format=\"";
+        if (encoding == "raw")
+          {
+            out << "appended\" offset=\"" << a.offset << "\"/>\n";
+            return;
+          }
+        if (encoding == "ascii")
+          {
+            out << "ascii\">\n";
+            a.WriteAscii (out);
+          }
+        else
+          {
+            out << "binary\">\n";
+            a.WriteBase64 (out);
+            out << "\n";
+          }
+        out << "        </DataArray>\n";
+      };
+
+    out << "      <PointData>\n";
+    for (size_t j = 0; j < nf; j++)
+      write_array (arrays[j]);
+    out << "      </PointData>\n"
+        << "      <Points>\n";
+    write_array (arrays[nf]);
+    out << "      </Points>\n"
+        << "      <Cells>\n";
+    for (size_t j = nf+1; j < nf+4; j++)
+      write_array (arrays[j]);
+    out << "      </Cells>\n"
+        << "    </Piece>\n"
+        << "  </UnstructuredGrid>\n";
+
+    if (encoding == "raw")
+      {
+        out << "  <AppendedData encoding=\"raw\">\n_";
+        for (auto & a : arrays)
+          a.WriteRaw (out);
+        out << "\n  </AppendedData>\n";
       }
-      
-      for ( auto elem : ref_elems)
+    out << "</VTKFile>\n";
+  }
+
+
+  template <int D>
+  void VTKOutput<D>::WritePVTU (const string & pvtuname, const string & piecename, int ntasks)
+  {
+    ofstream out(pvtuname);
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+        << "  <PUnstructuredGrid GhostLevel=\"0\">\n"
+        << "    <PPointData>\n";
+    for (auto field : value_field)
+      out << "      <PDataArray type=\"Float32\" Name=\"" << field->Name()
+          << "\" NumberOfComponents=\"" << field->Dimension() << "\"/>\n";
+    out << "    </PPointData>\n"
+        << "    <PPoints>\n"
+        << "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+        << "    </PPoints>\n";
+    for (int i = 1; i < ntasks; i++)
+      out << "    <Piece Source=\"" << BaseName(piecename) << "_" << i << ".vtu\"/>\n";
+    out << "  </PUnstructuredGrid>\n"
+        << "</VTKFile>\n";
+  }
+
+
+  template <int D>
+  void VTKOutput<D>::AppendPVD (const string & dataname, double time)
+  {
+    const string tail = "  </Collection>\n</VTKFile>\n";
+    string pvdname = filename + ".pvd";
+
+    ostringstream entry;
+    entry.precision(16);
+    entry << "    <DataSet timestep=\"" << time << "\" group=\"\" part=\"0\" file=\""
+          << BaseName(dataname) << "\"/>\n";
+
+    if (output_cnt == 1)
       {
-        INT<ELEMENT_MAXPOINTS+1> new_elem = elem;
-        for (int i = 1; i <= new_elem[0]; ++i)
-          new_elem[i] += offset;
-        cells.Append(new_elem);
+        // first output of this object starts a new collection
+        ofstream pvd(pvdname);
+        pvd << "<?xml version=\"1.0\"?>\n"
+            << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+            << "  <Collection>\n"
+            << entry.str() << tail;
+        return;
       }
 
-    }
+    // overwrite only the closing tags
+    fstream pvd(pvdname, ios::in | ios::out);
+    if (!pvd)
+      throw Exception ("VTKOutput: cannot open '"+pvdname+"' for appending");
+    pvd.seekp (-streamoff(tail.size()), ios::end);
+    pvd << entry.str() << tail;
+  }
+
+
+  template <int D> 
+  void VTKOutput<D>::Do (LocalHeap & lh, const BitArray * drawelems, double time)
+  {
+    static Timer t("VTKOutput::Do"); RegionTimer reg(t);
+
+    ostringstream filenamefinal;
+    filenamefinal << filename;
+    if (output_cnt > 0)
+      filenamefinal << "_" << output_cnt;
+    string basename = filenamefinal.str();
+
+    cout << " Writing VTK-Output";
+    if (output_cnt > 0)
+      cout << " ( " << output_cnt << " )";
+    cout << ":" << flush;
+
+    if (time < 0)
+      time = output_cnt;
+    output_cnt++;
+
+    FillData (lh, drawelems);
+
+    if (format == "vtk")
+      {
+        fileout = make_shared<ofstream>(basename + ".vtk");
+
+        // header:
+        *fileout << "# vtk DataFile Version 3.0" << endl;
+        *fileout << "vtk output" << endl;
+        *fileout << "ASCII" << endl;
+        *fileout << "DATASET UNSTRUCTURED_GRID" << endl;
+
+        PrintPoints();
+        PrintCells();
+        PrintCellTypes();
+        PrintFieldData();
+        fileout = nullptr;
+      }
+    else
+      {
+        // every worker writes its own piece, the master (without elements) the index files
+        int ntasks = MyMPI_GetNTasks();
+        int id = MyMPI_GetId();
+        if (ntasks == 1)
+          {
+            WriteVTU (basename + ".vtu");
+            AppendPVD (basename + ".vtu", time);
+          }
+        else if (id == 0)
+          {
+            WritePVTU (basename + ".pvtu", basename, ntasks);
+            AppendPVD (basename + ".pvtu", time);
+          }
+        else
+          WriteVTU (basename + "_" + ToString(id) + ".vtu");
+      }
 
-    PrintPoints();
-    PrintCells();
-    PrintCellTypes();
-    PrintFieldData();
-      
     cout << " Done." << endl;
   }    
 
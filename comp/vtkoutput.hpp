@@ -30,7 +30,8 @@ namespace ngcomp
   {
   public:
     virtual ~BaseVTKOutput() { ; }
-    virtual void Do (LocalHeap & lh, const BitArray * drawelems = 0) = 0;
+    /// time is the timestep of the pvd collection, negative means output counter
+    virtual void Do (LocalHeap & lh, const BitArray * drawelems = 0, double time = -1) = 0;
   };
   
   template <int D> 
@@ -44,10 +45,17 @@ namespace ngcomp
     string filename;
     int subdivision;
     int only_element = -1;
+    /// "vtk" (legacy ascii) or "vtu" (xml, with pvtu/pvd index files)
+    string format = "vtk";
+    /// data encoding of vtu files: "ascii", "base64" or "raw" (appended)
+    string encoding = "raw";
+    /// zlib compression of binary vtu data
+    bool compress = false;
 
     Array<shared_ptr<ValueField>> value_field;
     Array<Vec<D>> points;
     Array<INT<ELEMENT_MAXPOINTS+1>> cells;
+    Array<unsigned char> celltypes;
 
     int output_cnt = 0;
     
@@ -59,7 +67,8 @@ namespace ngcomp
                const Flags &,shared_ptr<MeshAccess>);
 
     VTKOutput (shared_ptr<MeshAccess>, const Array<shared_ptr<CoefficientFunction>> &,
-               const Array<string> &, string, int, int);
+               const Array<string> &, string, int, int,
+               string aformat = "vtk", string aencoding = "raw", bool acompress = false);
     virtual ~VTKOutput() { ; }
     
     void ResetArrays();
@@ -75,7 +84,16 @@ namespace ngcomp
     void PrintCellTypes();
     void PrintFieldData();    
 
-    virtual void Do (LocalHeap & lh, const BitArray * drawelems = 0);
+    /// evaluate points, cells and fields of all drawn elements in parallel
+    void FillData (LocalHeap & lh, const BitArray * drawelems);
+    /// write the local piece as xml unstructured grid
+    void WriteVTU (const string & vtuname);
+    /// parallel index file referencing the pieces of the ranks 1 ... ntasks-1
+    void WritePVTU (const string & pvtuname, const string & piecename, int ntasks);
+    /// add a timestep to the pvd collection without rewriting earlier steps
+    void AppendPVD (const string & dataname, double time);
+
+    virtual void Do (LocalHeap & lh, const BitArray * drawelems = 0, double time = -1);
   };
 
 
@@ -3,6 +3,12 @@
 #include<l2hofe_impl.hpp>
 #include<l2hofefo.hpp>
 #include<regex>
+#include<set>
+#ifndef WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace ngfem
 {
@@ -18,62 +24,231 @@ namespace ngfem
     {
         string name = "compiled_code_pointer" + ToString(id_counter++); 
         top += "extern \"C\" void* " + name + ";\n";
-        stringstream s_ptr;
-#ifdef WIN32
-        s_ptr << "0x";
-#endif
-        s_ptr << std::hex << p;
-        pointer += "void *" + name + " = reinterpret_cast<void*>(" + s_ptr.str() + ");\n";
+        pointers.push_back(make_pair(name, p));
         return name;
     }
 
-    unique_ptr<SharedLibrary> CompileCode(const std::vector<string> &codes, const std::vector<string> &link_flags )
+
+    static string code_cache_directory = getenv("NGS_CODE_CACHE") ? getenv("NGS_CODE_CACHE") : "";
+    static mutex code_cache_mutex;
+
+    void SetCodeCacheDirectory (string dir)
+    {
+      lock_guard<mutex> guard(code_cache_mutex);
+      code_cache_directory = dir;
+    }
+
+    string GetCodeCacheDirectory ()
+    {
+      lock_guard<mutex> guard(code_cache_mutex);
+      return code_cache_directory;
+    }
+
+
+    // writes prefix_i.cpp, compiles them in parallel and links libname
+    static void BuildLibrary(const std::vector<string> &codes, const std::vector<string> &link_flags,
+                             string prefix, string libname)
     {
-      static int counter = 0;
       static ngstd::Timer tcompile("CompiledCF::Compile");
       static ngstd::Timer tlink("CompiledCF::Link");
+      std::vector<string> file_prefixes;
       string object_files;
-      int i = 0;
-      string prefix = "code" + ToString(counter++);
-      for(string code : codes) {
-        string file_prefix = prefix+"_"+ToString(i++);
+      for (size_t i = 0; i < codes.size(); i++) {
+        string file_prefix = prefix+"_"+ToString(i);
         ofstream codefile(file_prefix+".cpp");
-        codefile << code;
+        codefile << codes[i];
         codefile.close();
-        cout << IM(3) << "compiling..." << endl;
-        tcompile.Start();
+        file_prefixes.push_back(file_prefix);
 #ifdef WIN32
-        string scompile = "cmd /C \"ngscxx.bat " + file_prefix + ".cpp\"";
         object_files += file_prefix+".obj ";
 #else
-        string scompile = "ngscxx -c " + file_prefix + ".cpp -o " + file_prefix + ".o";
-        object_files += file_prefix+".o ";
+        object_files += "\"" + file_prefix+".o\" ";
 #endif
-        int err = system(scompile.c_str());
-        if (err) throw Exception ("problem calling compiler");
-        tcompile.Stop();
       }
 
+      cout << IM(3) << "compiling..." << endl;
+      tcompile.Start();
+      // every compiler process is waited for by its own thread
+      atomic<int> errors{0};
+      std::vector<std::thread> threads;
+      for (string file_prefix : file_prefixes)
+        threads.emplace_back([&errors, file_prefix] ()
+          {
+#ifdef WIN32
+            string scompile = "cmd /C \"ngscxx.bat " + file_prefix + ".cpp\"";
+#else
+            string scompile = "ngscxx -c \"" + file_prefix + ".cpp\" -o \"" + file_prefix + ".o\"";
+#endif
+            if (system(scompile.c_str())) errors++;
+          });
+      for (auto & t : threads)
+        t.join();
+      tcompile.Stop();
+      if (errors) throw Exception ("problem calling compiler");
+
       cout << IM(3) << "linking..." << endl;
       tlink.Start();
 #ifdef WIN32
-        string slink = "cmd /C \"ngsld.bat /OUT:" + prefix+".dll " + object_files + "\"";
+      string slink = "cmd /C \"ngsld.bat /OUT:" + libname + " " + object_files + "\"";
 #else
-        string slink = "ngsld -shared " + object_files + " -o " + prefix + ".so -lngstd -lngbla -lngfem";
-        for (auto flag : link_flags)
-            slink += " "+flag;
+      string slink = "ngsld -shared " + object_files + " -o \"" + libname + "\" -lngstd -lngbla -lngfem";
+      for (auto flag : link_flags)
+        slink += " "+flag;
 #endif
       int err = system(slink.c_str());
       if (err) throw Exception ("problem calling linker");      
       tlink.Stop();
       cout << IM(3) << "done" << endl;
-      auto library = make_unique<SharedLibrary>();
+    }
+
+#ifndef WIN32
+    // FNV-1a
+    static uint64_t HashString (const string & s, uint64_t hash = 14695981039346656037ull)
+    {
+      for (unsigned char c : s)
+        {
+          hash ^= c;
+          hash *= 1099511628211ull;
+        }
+      return hash;
+    }
+
+    // the cache key covers the code, the compiler and linker calls, and the library build
+    static string CodeCacheKey(const std::vector<string> &codes, const std::vector<string> &link_flags)
+    {
+      uint64_t hash = HashString (ngsolve_version + " " __DATE__ " " __TIME__);
+      hash = HashString ("ngscxx -c ; ngsld -shared -lngstd -lngbla -lngfem", hash);
+      for (auto & flag : link_flags)
+        hash = HashString (flag + '\0', hash);
+      for (auto & code : codes)
+        hash = HashString (ToString(code.size()) + '\0' + code, hash);
+      stringstream key;
+      key << std::hex << std::setw(16) << std::setfill('0') << hash;
+      return key.str();
+    }
+
+    // compares the stored sources, a hash collision must not load wrong code
+    static bool CachedCodeMatches(string entry, const std::vector<string> &codes)
+    {
+      for (size_t i = 0; i < codes.size(); i++)
+        {
+          ifstream in(entry+"/code_"+ToString(i)+".cpp", ios::binary);
+          if (!in) return false;
+          stringstream stored;
+          stored << in.rdbuf();
+          if (stored.str() != codes[i]) return false;
+        }
+      return bool(ifstream(entry+"/code.so"));
+    }
+
+    static void MakeDirectories(string path)
+    {
+      for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos+1))
+        {
+          mkdir (path.substr(0, pos).c_str(), 0755);
+          if (pos == string::npos) break;
+        }
+    }
+
+    // build and cache directories contain plain files only
+    static void RemoveBuildDirectory(string dir)
+    {
+      if (DIR * d = opendir(dir.c_str()))
+        {
+          while (dirent * file = readdir(d))
+            {
+              string name = file->d_name;
+              if (name != "." && name != "..")
+                unlink ((dir+"/"+name).c_str());
+            }
+          closedir(d);
+        }
+      rmdir (dir.c_str());
+    }
+
+    // dlopen returns the same instance when a file is loaded twice,
+    // but every compiled CF needs its own pointer variables
+    static unique_ptr<SharedLibrary> LoadCachedLibrary(string libname, string cachedir)
+    {
+      static std::set<string> loaded;
+      static mutex loaded_mutex;
+      static atomic<unsigned> counter{0};
+      {
+        lock_guard<mutex> guard(loaded_mutex);
+        if (loaded.insert(libname).second)
+          return make_unique<SharedLibrary>(libname);
+      }
+      string copy = cachedir + "/load" + ToString(getpid()) + "_" + ToString(counter++) + ".so";
+      {
+        ifstream src(libname, ios::binary);
+        ofstream dst(copy, ios::binary);
+        dst << src.rdbuf();
+      }
+      auto library = make_unique<SharedLibrary>(copy);
+      unlink (copy.c_str());
+      return library;
+    }
+#endif
+
+    unique_ptr<SharedLibrary> CompileCode(const std::vector<string> &codes, const std::vector<string> &link_flags )
+    {
+      static atomic<unsigned> counter{0};
+      unsigned nr = counter++;
+#ifndef WIN32
+      string cachedir = GetCodeCacheDirectory();
+      if (cachedir != "")
+        {
+          string entry = cachedir + "/" + CodeCacheKey(codes, link_flags);
+          if (CachedCodeMatches(entry, codes))
+            {
+              cout << IM(3) << "load compiled code from " << entry << endl;
+              return LoadCachedLibrary(entry+"/code.so", cachedir);
+            }
+
+          // build in a private directory, which is published by an atomic rename
+          string tmpdir = entry + "_tmp" + ToString(getpid()) + "_" + ToString(nr);
+          MakeDirectories(tmpdir);
+          try
+            {
+              BuildLibrary(codes, link_flags, tmpdir+"/code", tmpdir+"/code.so");
+            }
+          catch (Exception &)
+            {
+              RemoveBuildDirectory(tmpdir);
+              throw;
+            }
+          if (rename(tmpdir.c_str(), entry.c_str()) == 0)
+            return LoadCachedLibrary(entry+"/code.so", cachedir);
+
+          // another process was faster
+          if (CachedCodeMatches(entry, codes))
+            {
+              RemoveBuildDirectory(tmpdir);
+              return LoadCachedLibrary(entry+"/code.so", cachedir);
+            }
+
+          // a stale or incomplete entry blocks the name, move it aside and retry
+          string stale = entry + "_stale" + ToString(getpid()) + "_" + ToString(nr);
+          if (rename(entry.c_str(), stale.c_str()) == 0)
+            RemoveBuildDirectory(stale);
+          if (rename(tmpdir.c_str(), entry.c_str()) == 0)
+            return LoadCachedLibrary(entry+"/code.so", cachedir);
+
+          // the mapped library stays valid after its files are removed
+          auto library = make_unique<SharedLibrary>(tmpdir+"/code.so");
+          RemoveBuildDirectory(tmpdir);
+          return library;
+        }
+#endif
+
+      string prefix = "code" + ToString(nr);
 #ifdef WIN32
-      library->Load(prefix+".dll");
+      BuildLibrary(codes, link_flags, prefix, prefix+".dll");
+      return make_unique<SharedLibrary>(prefix+".dll");
 #else
-      library->Load("./"+prefix+".so");
+      BuildLibrary(codes, link_flags, prefix, prefix+".so");
+      return make_unique<SharedLibrary>("./"+prefix+".so");
 #endif
-      return library;
     }
 
     namespace detail {
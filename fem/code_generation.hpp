@@ -45,7 +45,8 @@ namespace ngfem
     int deriv;
     std::vector<string> link_flags;
 
-    string pointer;
+    /// pointers to runtime objects, set after the library is loaded
+    std::vector<std::pair<string,const void*>> pointers;
 
     string AddPointer(const void *p );
 
@@ -175,6 +176,10 @@ namespace ngfem
   }
 
   unique_ptr<SharedLibrary> CompileCode(const std::vector<string> &codes, const std::vector<string> &libraries );
+
+  /// compiled libraries are kept in dir and reused if the code did not change, "" disables the cache
+  NGS_DLL_HEADER void SetCodeCacheDirectory (string dir);
+  NGS_DLL_HEADER string GetCodeCacheDirectory ();
   namespace detail {
       string GenerateL2ElementCode(int order);
   }
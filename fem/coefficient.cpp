@@ -11,6 +11,7 @@
 #include <fem.hpp>
 #include <../ngstd/evalfunc.hpp>
 #include <algorithm>
+#include <regex>
 
 namespace ngstd
 {
@@ -942,6 +943,8 @@ public:
   {
     SetDimensions(c1->Dimensions());
   }
+
+  double GetScale () const { return scal; }
   
   virtual void PrintReport (ostream & ost) const override
   {
@@ -2399,6 +2402,8 @@ public:
   {
     dim1 = c1->Dimension();
   }
+
+  int GetComponent () const { return comp; }
   
   virtual void GenerateCode(Code &code, FlatArray<int> inputs, int index) const override
   {
@@ -3348,6 +3353,7 @@ public:
     typedef T_CoefficientFunction<CoordCoefficientFunction, CoefficientFunctionNoDerivative> BASE;
   public:
     CoordCoefficientFunction (int adir) : BASE(1, false), dir(adir) { ; }
+    int GetDirection () const { return dir; }
     virtual string GetDescription () const override
     {
       string dirname;
@@ -3435,6 +3441,102 @@ shared_ptr<CoefficientFunction> MakeCoordinateCoefficientFunction (int comp)
 
 
   // ///////////////////////////// Compiled CF /////////////////////////
+
+  /// collects the archived state of a CF node as raw bytes, a key for structural hashing
+  class StructureArchive : public Archive
+  {
+    string bytes;
+    template <typename T>
+    Archive & Append (const T & x)
+    {
+      bytes.append (reinterpret_cast<const char*>(&x), sizeof(T));
+      return *this;
+    }
+  public:
+    StructureArchive () : Archive(true) { ; }
+    const string & Bytes () const { return bytes; }
+
+    using Archive::operator&;
+    virtual Archive & operator & (double & d) { return Append(d); }
+    virtual Archive & operator & (int & i) { return Append(i); }
+    virtual Archive & operator & (short & i) { return Append(i); }
+    virtual Archive & operator & (long & i) { return Append(i); }
+    virtual Archive & operator & (size_t & i) { return Append(i); }
+    virtual Archive & operator & (unsigned char & i) { return Append(i); }
+    virtual Archive & operator & (bool & b) { return Append(b); }
+    virtual Archive & operator & (string & str)
+    {
+      Append (str.size());
+      bytes += str;
+      return *this;
+    }
+    virtual Archive & operator & (char *& str)
+    {
+      string hstr = str ? str : "";
+      return (*this) & hstr;
+    }
+  };
+
+
+  /*
+    Kernels of the SIMD interpreter. Registers are rows of SIMD<double>
+    of length nip, input registers have distance nip, the result has
+    distance dist. The template dimensions are fixed for the common
+    small cases, and given by n, h, w for N = -1.
+  */
+  template <typename OP>
+  static void InterpretElementwise (int n, size_t nip, const SIMD<double> * a, const SIMD<double> * b,
+                                    SIMD<double> * r, size_t dist, OP op)
+  {
+    for (int k = 0; k < n; k++)
+      for (size_t i = 0; i < nip; i++)
+        r[k*dist+i] = op(a[k*nip+i], b[k*nip+i]);
+  }
+
+  template <int N>
+  static void InterpretInnerProduct (int n, size_t nip, const SIMD<double> * a, const SIMD<double> * b,
+                                     SIMD<double> * r)
+  {
+    int nn = (N > 0) ? N : n;
+    for (size_t i = 0; i < nip; i++)
+      {
+        SIMD<double> sum = 0.0;
+        for (int k = 0; k < nn; k++)
+          sum += a[k*nip+i] * b[k*nip+i];
+        r[i] = sum;
+      }
+  }
+
+  template <int H, int W>
+  static void InterpretMatVec (int h, int w, size_t nip, const SIMD<double> * a, const SIMD<double> * b,
+                               SIMD<double> * r, size_t dist)
+  {
+    int hh = (H > 0) ? H : h;
+    int ww = (W > 0) ? W : w;
+    for (size_t i = 0; i < nip; i++)
+      for (int k = 0; k < hh; k++)
+        {
+          SIMD<double> sum = 0.0;
+          for (int j = 0; j < ww; j++)
+            sum += a[(k*ww+j)*nip+i] * b[j*nip+i];
+          r[k*dist+i] = sum;
+        }
+  }
+
+  /// one instruction of the SIMD interpreter of a compiled CF
+  struct CFInstruction
+  {
+    enum OPCODE { CALL, CONST, COORD, ADD, SUB, MULT, DIV, SCALE, SCALVEC, INNER, MATVEC, VECTORIAL };
+    OPCODE op;
+    /// the step computed by the instruction
+    int step;
+    /// constant value or scaling factor
+    double val;
+    /// dimension of the result, inner dimension or direction for COORD
+    int h, w;
+  };
+
+  
   class CompiledCoefficientFunction : public CoefficientFunction, public std::enable_shared_from_this<CompiledCoefficientFunction>
   {
     typedef void (*lib_function)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<double>);
@@ -3454,6 +3556,13 @@ shared_ptr<CoefficientFunction> MakeCoordinateCoefficientFunction (int comp)
     Array<int> dim;
     int totdim;
     Array<bool> is_complex;
+    /// steps created by the optimization
+    Array<shared_ptr<CoefficientFunction>> own_steps;
+    /// program of the SIMD interpreter, empty if not applicable
+    Array<CFInstruction> program;
+    /// first register row of every step, -1 for the result
+    Array<int> regrow;
+    int nregrows = 0;
     // Array<Timer*> timers;
     unique_ptr<SharedLibrary> library;
     lib_function compiled_function = nullptr;
@@ -3507,15 +3616,439 @@ shared_ptr<CoefficientFunction> MakeCoordinateCoefficientFunction (int comp)
          });
       cout << IM(3) << "inputs = " << endl << inputs << endl;
 
+      Optimize();
+      SetupInterpreter();
+    }
+
+    /*
+      Optimizes the list of steps:
+      - constant subtrees are folded,
+      - x*1, 1*x, x+0, x-0, x/1 are replaced by x, and 0*x by 0 (also for x = inf or nan),
+      - proxy-free steps which are zero by their NonZeroPattern are replaced by 0,
+      - structurally equal steps are merged.
+      Steps are merged if their type is known for pickling (the archived
+      state describes the node), and they have the same inputs.
+    */
+    void Optimize ()
+    {
+      static Timer t("CompiledCF::Optimize");
+      RegionTimer reg(t);
+      
+      size_t n = steps.Size();
+      for (size_t i = 0; i < n; i++)
+        for (auto nr : inputs[i])
+          if (nr < 0) return;    // undefined input, e.g. DomainWise without cf on some domain
+
+      Array<int> repr(n);
+      Array<bool> has_proxy(n);
+      // the original subtree is a constant, computed by EvaluateConst
+      Array<bool> constant(n);
+      std::map<string,int> structures;
+
+      auto is_const = [&] (int i) { return steps[i]->GetType() == CF_Type_constant; };
+      auto const_val = [&] (int i) { return steps[i]->EvaluateConst(); };
+      auto replace = [&] (int i, shared_ptr<CoefficientFunction> newcf)
+        {
+          own_steps.Append (newcf);
+          steps[i] = newcf.get();
+          while (inputs[i].Size())
+            inputs.DecEntrySize(i);
+        };
+      auto same_kind = [&] (int i, int j)
+        {
+          return steps[i]->Dimensions() == steps[j]->Dimensions() &&
+            steps[i]->IsComplex() == steps[j]->IsComplex();
+        };
+
+      for (size_t i = 0; i < n; i++)
+        {
+          repr[i] = i;
+          auto in = inputs[i];
+          ArrayMem<int,10> orig(in.Size());
+          for (size_t j = 0; j < in.Size(); j++)
+            orig[j] = in[j];
+          for (auto & nr : in)
+            nr = repr[nr];
+
+          CoefficientFunction & stepcf = *steps[i];
+          CF_Type type = stepcf.GetType();
+          bool root = (i == n-1);
+          bool scalar = stepcf.Dimension() == 1 && !stepcf.IsComplex();
+          bool known = type != CF_Type_undefined && type != CF_Type_usertype &&
+            stepcf.GetDescription() != "unary operation 'undefined'";   // e.g. BSplines
+
+          has_proxy[i] = dynamic_cast<ProxyFunction*> (&stepcf) != nullptr;
+          for (auto nr : in)
+            has_proxy[i] = has_proxy[i] || has_proxy[nr];
+
+          // constant folding
+          constant[i] = (type == CF_Type_constant);
+          bool const_inputs = in.Size() > 0;
+          for (auto nr : orig)
+            const_inputs = const_inputs && constant[nr];
+          if (known && scalar && const_inputs)
+            {
+              try
+                {
+                  replace (i, make_shared<ConstantCoefficientFunction> (stepcf.EvaluateConst()));
+                  constant[i] = true;
+                  continue;
+                }
+              catch (Exception &) { ; }
+            }
+
+          // proxy-free, but zero
+          if (scalar && in.Size() && !has_proxy[i])
+            {
+              ProxyUserData ud;
+              Vector<bool> nz(1), nzd(1), nzdd(1);
+              stepcf.NonZeroPattern (ud, nz, nzd, nzdd);
+              if (!nz(0) && !nzd(0) && !nzdd(0))
+                {
+                  replace (i, make_shared<ConstantCoefficientFunction> (0));
+                  continue;
+                }
+            }
+
+          // algebraic simplification, python's 1*x and 0*x are scalings
+          if (auto scale = dynamic_cast<ScaleCoefficientFunction*> (&stepcf))
+            {
+              if (scale->GetScale() == 0 && scalar)
+                {
+                  replace (i, make_shared<ConstantCoefficientFunction> (0));
+                  continue;
+                }
+              if (scale->GetScale() == 1 && !root && same_kind(i, in[0]))
+                {
+                  repr[i] = in[0];
+                  continue;
+                }
+            }
+          if (in.Size() == 2 && (type == CF_Type_add || type == CF_Type_sub ||
+                                 type == CF_Type_mult || type == CF_Type_div))
+            {
+              int a = in[0], b = in[1];
+              auto has_value = [&] (int j, double val) { return is_const(j) && const_val(j) == val; };
+              int alias = -1;
+              bool zero = false;
+              switch (type)
+                {
+                case CF_Type_add:
+                  if (has_value(a, 0)) alias = b;
+                  if (has_value(b, 0)) alias = a;
+                  break;
+                case CF_Type_sub:
+                  if (has_value(b, 0)) alias = a;
+                  break;
+                case CF_Type_mult:
+                  if (has_value(a, 1)) alias = b;
+                  if (has_value(b, 1)) alias = a;
+                  if (has_value(a, 0) || has_value(b, 0)) zero = true;
+                  break;
+                case CF_Type_div:
+                  // 0/x is kept, 0/0 has to stay nan
+                  if (has_value(b, 1)) alias = a;
+                  break;
+                default:
+                  break;
+                }
+              if (zero && scalar)
+                {
+                  replace (i, make_shared<ConstantCoefficientFunction> (0));
+                  continue;
+                }
+              if (alias != -1 && !root && same_kind(i, alias))
+                {
+                  repr[i] = alias;
+                  continue;
+                }
+            }
+
+          // structural hashing
+          if (known && !root)
+            {
+              StructureArchive ar;
+              stepcf.DoArchive (ar);
+              string key = string(typeid(stepcf).name()) + '\0' + ar.Bytes();
+              for (auto nr : in)
+                key += ToString(nr) + ',';
+              auto pos = structures.find(key);
+              if (pos != structures.end())
+                repr[i] = pos->second;
+              else
+                structures[key] = i;
+            }
+        }
+
+      // keep the steps needed for the last one
+      Array<bool> used(n);
+      used = false;
+      used[n-1] = true;
+      for (int i = n-1; i >= 0; i--)
+        if (used[i])
+          for (auto nr : inputs[i])
+            used[nr] = true;
+
+      Array<int> newnr(n);
+      Array<CoefficientFunction*> newsteps;
+      for (size_t i = 0; i < n; i++)
+        if (used[i])
+          {
+            newnr[i] = newsteps.Size();
+            newsteps.Append (steps[i]);
+          }
+
+      DynamicTable<int> newinputs(newsteps.Size());
+      for (size_t i = 0; i < n; i++)
+        if (used[i])
+          for (auto nr : inputs[i])
+            newinputs.Add (newnr[i], newnr[nr]);
+
+      cout << IM(3) << "optimized compiled CF from " << n << " to " << newsteps.Size() << " steps" << endl;
+      steps = move(newsteps);
+      inputs = move(newinputs);
+
+      dim.SetSize0();
+      is_complex.SetSize0();
+      max_inputsize = 0;
+      for (size_t i = 0; i < steps.Size(); i++)
+        {
+          dim.Append (steps[i]->Dimension());
+          is_complex.Append (steps[i]->IsComplex());
+          max_inputsize = max2(size_t(inputs[i].Size()), max_inputsize);
+        }
+      totdim = 0;
+      for (int d : dim) totdim += d;
+    }
+
+    /*
+      Translates the steps to a register machine for real SIMD
+      evaluation. Common operations are executed by fused kernels,
+      components are aliases of rows of their input. Other steps are
+      called by their Evaluate. Registers are reused as soon as the
+      step is not needed anymore.
+    */
+    void SetupInterpreter ()
+    {
+      size_t n = steps.Size();
+      for (size_t i = 0; i < n; i++)
+        {
+          if (is_complex[i]) return;
+          for (auto nr : inputs[i])
+            if (nr < 0) return;
+        }
+
+      Array<int> alias(n);      // component of a register
+      Array<int> lastuse(n);
+      alias = -1;
+      lastuse = -1;
+      for (size_t i = 0; i+1 < n; i++)
+        if (auto comp = dynamic_cast<ComponentCoefficientFunction*> (steps[i]))
+          alias[i] = comp->GetComponent();
+      for (size_t i = 0; i < n; i++)
+        for (auto nr : inputs[i])
+          lastuse[nr] = i;
+      // aliases keep their input alive
+      for (int i = n-1; i >= 0; i--)
+        if (alias[i] != -1)
+          lastuse[inputs[i][0]] = max2(lastuse[inputs[i][0]], lastuse[i]);
+      
+      Array<int> rowowner;    // step owning a register row, or -1
+      regrow.SetSize(n);
+      regrow = -1;
+      for (size_t i = 0; i < n; i++)
+        {
+          CoefficientFunction & stepcf = *steps[i];
+          auto in = inputs[i];
+          auto indim = [&] (int j) { return steps[in[j]]->Dimension(); };
+          // two inputs of the result dimension, combined component by component
+          // (a square matrix product has the same dimensions)
+          bool elementwise = in.Size() == 2 && indim(0) == stepcf.Dimension() &&
+            indim(1) == stepcf.Dimension() && !dynamic_cast<MultMatMatCoefficientFunction*> (&stepcf);
+
+          if (alias[i] != -1)
+            {
+              regrow[i] = regrow[in[0]] + alias[i];
+              continue;
+            }
+
+          CFInstruction instr { CFInstruction::CALL, int(i), 0.0, stepcf.Dimension(), 0 };
+          if (stepcf.GetType() == CF_Type_constant)
+            {
+              instr.op = CFInstruction::CONST;
+              instr.val = stepcf.EvaluateConst();
+            }
+          else if (auto coord = dynamic_cast<CoordCoefficientFunction*> (&stepcf))
+            {
+              instr.op = CFInstruction::COORD;
+              instr.w = coord->GetDirection();
+            }
+          else if (auto scale = dynamic_cast<ScaleCoefficientFunction*> (&stepcf))
+            {
+              instr.op = CFInstruction::SCALE;
+              instr.val = scale->GetScale();
+            }
+          else if (dynamic_cast<MultScalVecCoefficientFunction*> (&stepcf))
+            instr.op = CFInstruction::SCALVEC;
+          else if (dynamic_cast<MultMatVecCoefficientFunction*> (&stepcf))
+            {
+              instr.op = CFInstruction::MATVEC;
+              instr.w = indim(1);
+            }
+          else if (dynamic_cast<VectorialCoefficientFunction*> (&stepcf))
+            instr.op = CFInstruction::VECTORIAL;
+          else if (elementwise && stepcf.GetType() == CF_Type_add) instr.op = CFInstruction::ADD;
+          else if (elementwise && stepcf.GetType() == CF_Type_sub) instr.op = CFInstruction::SUB;
+          else if (elementwise && stepcf.GetType() == CF_Type_mult) instr.op = CFInstruction::MULT;
+          else if (elementwise && stepcf.GetType() == CF_Type_div) instr.op = CFInstruction::DIV;
+          else if (stepcf.GetType() == CF_Type_mult && stepcf.Dimension() == 1 &&
+                   !dynamic_cast<MultMatMatCoefficientFunction*> (&stepcf) &&
+                   in.Size() == 2 && indim(0) == indim(1))
+            {
+              instr.op = CFInstruction::INNER;     // MultVecVec, T_MultVecVec
+              instr.w = indim(0);
+            }
+          program.Append (instr);
+
+          // the result row, not overlapping the inputs
+          if (i+1 < n)
+            {
+              int d = stepcf.Dimension();
+              int first = 0;
+              for ( ; first < rowowner.Size(); first++)
+                {
+                  int j = 0;
+                  while (j < d && first+j < rowowner.Size() && rowowner[first+j] == -1) j++;
+                  if (j == d || first+j == rowowner.Size()) break;
+                }
+              while (rowowner.Size() < first+d)
+                rowowner.Append (-1);
+              for (int j = 0; j < d; j++)
+                rowowner[first+j] = i;
+              regrow[i] = first;
+            }
+
+          // free registers not needed anymore
+          for (auto & owner : rowowner)
+            if (owner != -1 && lastuse[owner] <= int(i))
+              owner = -1;
+        }
+      nregrows = rowowner.Size();
+      cout << IM(3) << "interpreter uses " << nregrows << " register rows, " << totdim << " without reuse" << endl;
     }
 
+    void Interpret (const SIMD_BaseMappedIntegrationRule & ir, BareSliceMatrix<SIMD<double>> values) const
+    {
+      size_t nip = ir.Size();
+      ArrayMem<SIMD<double>,1000> regs(nip*nregrows);
+      ArrayMem<SIMD<double>*,100> ptr(steps.Size());
+      for (size_t i = 0; i+1 < steps.Size(); i++)
+        ptr[i] = &regs[0] + regrow[i]*nip;
+      ptr.Last() = &values(0,0);
+      ArrayMem<BareSliceMatrix<SIMD<double>>,100> in(max_inputsize);
+
+      for (auto & instr : program)
+        {
+          auto inputi = inputs[instr.step];
+          SIMD<double> * r = ptr[instr.step];
+          size_t dist = (size_t(instr.step)+1 == steps.Size()) ? values.Dist() : nip;
+          auto a = [&] (int j) -> const SIMD<double>* { return ptr[inputi[j]]; };
+          
+          switch (instr.op)
+            {
+            case CFInstruction::CALL:
+              for (int nr : Range(inputi))
+                new (&in[nr]) BareSliceMatrix<SIMD<double>> (nip, ptr[inputi[nr]],
+                                                             DummySize(dim[inputi[nr]], nip));
+              steps[instr.step] -> Evaluate (ir, in.Range(0, inputi.Size()),
+                                             BareSliceMatrix<SIMD<double>> (dist, r, DummySize(instr.h, nip)));
+              break;
+            case CFInstruction::CONST:
+              for (size_t i = 0; i < nip; i++)
+                r[i] = instr.val;
+              break;
+            case CFInstruction::COORD:
+              {
+                auto points = ir.GetPoints();
+                for (size_t i = 0; i < nip; i++)
+                  r[i] = points(i, instr.w);
+                break;
+              }
+            case CFInstruction::ADD:
+              InterpretElementwise (instr.h, nip, a(0), a(1), r, dist,
+                                    [] (SIMD<double> x, SIMD<double> y) { return x+y; });
+              break;
+            case CFInstruction::SUB:
+              InterpretElementwise (instr.h, nip, a(0), a(1), r, dist,
+                                    [] (SIMD<double> x, SIMD<double> y) { return x-y; });
+              break;
+            case CFInstruction::MULT:
+              InterpretElementwise (instr.h, nip, a(0), a(1), r, dist,
+                                    [] (SIMD<double> x, SIMD<double> y) { return x*y; });
+              break;
+            case CFInstruction::DIV:
+              InterpretElementwise (instr.h, nip, a(0), a(1), r, dist,
+                                    [] (SIMD<double> x, SIMD<double> y) { return x/y; });
+              break;
+            case CFInstruction::SCALE:
+              {
+                const SIMD<double> * x = a(0);
+                SIMD<double> s = instr.val;
+                for (int k = 0; k < instr.h; k++)
+                  for (size_t i = 0; i < nip; i++)
+                    r[k*dist+i] = s * x[k*nip+i];
+                break;
+              }
+            case CFInstruction::SCALVEC:
+              {
+                const SIMD<double> * s = a(0);
+                const SIMD<double> * x = a(1);
+                for (int k = 0; k < instr.h; k++)
+                  for (size_t i = 0; i < nip; i++)
+                    r[k*dist+i] = s[i] * x[k*nip+i];
+                break;
+              }
+            case CFInstruction::INNER:
+              switch (instr.w)
+                {
+                case 2: InterpretInnerProduct<2> (2, nip, a(0), a(1), r); break;
+                case 3: InterpretInnerProduct<3> (3, nip, a(0), a(1), r); break;
+                default: InterpretInnerProduct<-1> (instr.w, nip, a(0), a(1), r); break;
+                }
+              break;
+            case CFInstruction::MATVEC:
+              if (instr.h == 2 && instr.w == 2)
+                InterpretMatVec<2,2> (2, 2, nip, a(0), a(1), r, dist);
+              else if (instr.h == 3 && instr.w == 3)
+                InterpretMatVec<3,3> (3, 3, nip, a(0), a(1), r, dist);
+              else
+                InterpretMatVec<-1,-1> (instr.h, instr.w, nip, a(0), a(1), r, dist);
+              break;
+            case CFInstruction::VECTORIAL:
+              {
+                int row = 0;
+                for (int j : Range(inputi))
+                  {
+                    const SIMD<double> * x = a(j);
+                    for (int k = 0; k < dim[inputi[j]]; k++, row++)
+                      for (size_t i = 0; i < nip; i++)
+                        r[row*dist+i] = x[k*nip+i];
+                  }
+                break;
+              }
+            }
+        }
+    }
+
+    size_t NumSteps() const { return steps.Size(); }
+
     void RealCompile(int maxderiv, bool wait)
     {
         std::vector<string> link_flags;
         if(cf->IsComplex())
             maxderiv = 0;
         stringstream s;
-        string pointer_code;
+        std::vector<std::pair<string,const void*>> pointers;
         string top_code = ""
              "#include<fem.hpp>\n"
              "using namespace ngfem;\n"
@@ -3535,7 +4068,7 @@ shared_ptr<CoefficientFunction> MakeCoordinateCoefficientFunction (int comp)
               steps[i]->GenerateCode(code, inputs[i],i);
             }
 
-            pointer_code += code.pointer;
+            pointers.insert(pointers.end(), code.pointers.begin(), code.pointers.end());
             top_code += code.top;
 
             // set results
@@ -3616,19 +4149,42 @@ shared_ptr<CoefficientFunction> MakeCoordinateCoefficientFunction (int comp)
                     link_flags.push_back(lib);
 
         }
+        // the pointer variables are set after loading, so the code does
+        // not depend on addresses and can be reused from the code cache
+        for (auto & p : pointers)
+        {
+#ifdef WIN32
+            s << "__declspec(dllexport) ";
+#endif
+            s << "void * " << p.first << " = nullptr;" << endl;
+        }
         s << "}" << endl;
         string file_code = top_code + s.str();
-        std::vector<string> codes;
-        codes.push_back(file_code);
-        if(pointer_code.size()) {
-          pointer_code = "extern \"C\" {\n" + pointer_code;
-          pointer_code += "}\n";
-          codes.push_back(pointer_code);
+
+        // number the pointers in the order of appearance, independent of other compiled CFs
+        std::map<string,string> renamed;
+        static regex pointer_name("compiled_code_pointer[0-9]+");
+        string code_renamed;
+        auto last = file_code.cbegin();
+        for (sregex_iterator it(file_code.cbegin(), file_code.cend(), pointer_name), end; it != end; ++it)
+        {
+            auto ins = renamed.insert (make_pair(it->str(), "compiled_code_pointer"+ToString(renamed.size())));
+            code_renamed.append (last, (*it)[0].first);
+            code_renamed += ins.first->second;
+            last = (*it)[0].second;
         }
+        code_renamed.append (last, file_code.cend());
+        for (auto & p : pointers)
+            p.first = renamed[p.first];
+
+        std::vector<string> codes;
+        codes.push_back(code_renamed);
 
         auto self = shared_from_this();
-        auto compile_func = [self, codes, link_flags, maxderiv] () {
+        auto compile_func = [self, codes, link_flags, maxderiv, pointers] () {
               self->library = CompileCode( codes, link_flags );
+              for (auto & p : pointers)
+                  *self->library->GetFunction<void**>(p.first) = const_cast<void*>(p.second);
               if(self->cf->IsComplex())
               {
                   self->compiled_function_simd_complex = self->library->GetFunction<lib_function_simd_complex>("CompiledEvaluateSIMD");
@@ -3943,6 +4499,11 @@ shared_ptr<CoefficientFunction> MakeCoordinateCoefficientFunction (int comp)
         return;
       }
 
+      if (program.Size())
+        {
+          Interpret (ir, values);
+          return;
+        }
       T_Evaluate (ir, values);
       return;
 
@@ -4385,6 +4946,12 @@ class RealCF : public CoefficientFunctionNoDerivative
     return cf;
   }
 
+  int NumCompiledSteps (shared_ptr<CoefficientFunction> cf)
+  {
+    auto compiled = dynamic_pointer_cast<CompiledCoefficientFunction> (cf);
+    return compiled ? compiled->NumSteps() : -1;
+  }
+
   
 }
 
@@ -1558,6 +1558,9 @@ INLINE shared_ptr<CoefficientFunction> BinaryOpCF(shared_ptr<CoefficientFunction
   
   NGS_DLL_HEADER
   shared_ptr<CoefficientFunction> Compile (shared_ptr<CoefficientFunction> c, bool realcompile=false, int maxderiv=2, bool wait=false);
+  /// number of steps after optimization, -1 if cf is not compiled
+  NGS_DLL_HEADER
+  int NumCompiledSteps (shared_ptr<CoefficientFunction> cf);
 }
 
 
@@ -208,6 +208,17 @@ namespace ngfem
     CalcElementMatrix(fel, eltrans, helmat, lh);
     elmat += helmat;
   }
+
+  void BilinearFormIntegrator ::    
+  CalcElementMatricesAdd (const FiniteElement & fel,
+                          FlatArray<const ElementTransformation*> eltrans,
+                          FlatMatrix<double> elmats,
+                          LocalHeap & lh) const
+  {
+    size_t ndof = elmats.Width();
+    for (size_t i = 0; i < eltrans.Size(); i++)
+      CalcElementMatrixAdd (fel, *eltrans[i], elmats.Rows(i*ndof, (i+1)*ndof), lh);
+  }
   
 
 
@@ -323,6 +323,18 @@ namespace ngfem
                             const ElementTransformation & eltrans, 
                             FlatMatrix<Complex> elmat,
                             LocalHeap & lh) const;
+
+    /**
+       Computes element matrices of several elements sharing the same
+       finite element (type, order and vertex ordering).
+       The matrices are stacked: element i adds to the rows
+       [i*ndof, (i+1)*ndof) of elmats.
+    */
+    virtual void
+      CalcElementMatricesAdd (const FiniteElement & fel,
+                              FlatArray<const ElementTransformation*> eltrans,
+                              FlatMatrix<double> elmats,
+                              LocalHeap & lh) const;
     
 
     
@@ -891,7 +891,11 @@ val : can be one of the following:
            py::arg("realcompile")=false,
            py::arg("maxderiv")=2,
            py::arg("wait")=false,
-          "compile list of individual steps, experimental improvement for deep trees")
+          "compile list of individual steps, experimental improvement for deep trees.\n"
+          "The steps are simplified: constant subtrees are folded, x*1, x+0, x-0, x/1\n"
+          "are replaced by x, 0*x by 0 (also if x is inf or nan), equal steps are merged")
+    .def_property_readonly ("compiled_steps", [] (shared_ptr<CF> coef) { return NumCompiledSteps(coef); },
+                            "number of steps of a compiled CF after simplification, -1 if not compiled")
 
 
     .def (py::pickle([] (CoefficientFunction & cf)
@@ -1672,6 +1676,12 @@ void NGS_DLL_HEADER ExportNgfem(py::module &m) {
                            
   m.def("GenerateL2ElementCode", &GenerateL2ElementCode);
 
+  m.def("SetCodeCacheDirectory", &SetCodeCacheDirectory, py::arg("dir"),
+        "libraries of compiled CoefficientFunctions are stored in dir and reused\n"
+        "if the generated code did not change, '' disables the cache.\n"
+        "The default is the environment variable NGS_CODE_CACHE");
+  m.def("GetCodeCacheDirectory", &GetCodeCacheDirectory);
+
 }
 
 
@@ -1555,6 +1555,201 @@ namespace ngfem
         T_CalcElementMatrixAdd<double,double,Complex> (fel, trafo, elmat, lh);
   }
 
+  void 
+  SymbolicBilinearFormIntegrator ::
+  CalcElementMatricesAdd (const FiniteElement & fel,
+                          FlatArray<const ElementTransformation*> trafos,
+                          FlatMatrix<double> elmats,
+                          LocalHeap & lh) const
+  {
+    int dim = ElementTopology::GetSpaceDim (fel.ElementType());
+    bool batch = simd_evaluate && element_vb == VOL &&
+      trafos.Size() > 1 && trafos.Size() <= SIMD<double>::Size() &&
+      gridfunction_cfs.Size() == 0 && !cf->IsComplex() && !fel.ComplexShapes() &&
+      typeid(fel) != typeid(const MixedFiniteElement&) &&
+      trafos[0]->SpaceDim() == dim;
+    for (auto trafo : trafos)
+      batch &= !trafo->IsComplex();
+
+    if (batch)
+      try
+        {
+          switch (dim)
+            {
+            case 1: T_CalcElementMatricesBatched<1> (fel, trafos, elmats, lh); return;
+            case 2: T_CalcElementMatricesBatched<2> (fel, trafos, elmats, lh); return;
+            case 3: T_CalcElementMatricesBatched<3> (fel, trafos, elmats, lh); return;
+            }
+        }
+      catch (ExceptionNOSIMD e)
+        {
+          cout << IM(4) << e.What() << endl
+               << "switching to scalar evaluation" << endl;
+          simd_evaluate = false;
+        }
+
+    BilinearFormIntegrator::CalcElementMatricesAdd (fel, trafos, elmats, lh);
+  }
+
+  /*
+    Element batching: the integration points of the reference element are
+    shared, so lane i of every SIMD point belongs to element i. Proxies,
+    coefficients and Jacobians are evaluated for all elements at once, and
+    the element matrices are reduced lane-wise.
+  */
+  template <int D>
+  void SymbolicBilinearFormIntegrator ::
+  T_CalcElementMatricesBatched (const FiniteElement & fel,
+                                FlatArray<const ElementTransformation*> trafos,
+                                FlatMatrix<double> elmats,
+                                LocalHeap & lh) const
+  {
+    static Timer t("SymbolicBFI::CalcElementMatrices batched", 2);
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    constexpr size_t SW = SIMD<double>::Size();
+    size_t nel = trafos.Size();
+    size_t ndof = elmats.Width();
+    HeapReset hr(lh);
+
+    // collect integration points with non-zero weight (skips SIMD padding)
+    const SIMD_IntegrationRule & sir = Get_SIMD_IntegrationRule (fel, lh);
+    ArrayMem<int,100> points;
+    for (size_t k = 0; k < sir.Size()*SW; k++)
+      if (sir[k/SW].Weight()[k%SW] != 0)
+        points.Append (k);
+
+    SIMD_IntegrationRule ir(points.Size()*SW, lh);
+    for (size_t q = 0; q < points.Size(); q++)
+      {
+        IntegrationPoint ip = sir[points[q]/SW][points[q]%SW];
+        ir[q] = SIMD<IntegrationPoint> ([ip] (int) { return ip; });
+      }
+
+    // map the points with every element, and interleave across lanes
+    // unused lanes repeat the last element
+    FlatArray<const SIMD_MappedIntegrationRule<D,D>*> emirs(SW, lh);
+    for (size_t e = 0; e < SW; e++)
+      emirs[e] = (e < nel) ?
+        &static_cast<const SIMD_MappedIntegrationRule<D,D>&> ((*trafos[e])(sir, lh)) : emirs[nel-1];
+
+    SIMD_MappedIntegrationRule<D,D> mir(ir, *trafos[0], -1, lh);
+    for (size_t q = 0; q < points.Size(); q++)
+      {
+        size_t blk = points[q]/SW, lane = points[q]%SW;
+        auto & mip = mir[q];
+        for (int i = 0; i < D; i++)
+          {
+            mip.Point()(i) = SIMD<double> ([&] (int e)
+                                           { return (*emirs[e])[blk].GetPoint()(i)[lane]; });
+            for (int j = 0; j < D; j++)
+              mip.Jacobian()(i,j) = SIMD<double> ([&] (int e)
+                                                  { return (*emirs[e])[blk].GetJacobian()(i,j)[lane]; });
+          }
+        mip.Compute();
+      }
+
+    ProxyUserData ud;
+    const_cast<ElementTransformation&>(*trafos[0]).userdata = &ud;
+
+    FlatMatrix<SIMD<double>> simd_elmat(ndof, ndof, lh);
+    simd_elmat = SIMD<double>(0.0);
+    bool symmetric_so_far = true;
+
+    int k1 = 0;
+    int k1nr = 0;
+    for (auto proxy1 : trial_proxies)
+      {
+        int l1 = 0;
+        int l1nr = 0;
+        for (auto proxy2 : test_proxies)
+          {
+            size_t dim_proxy1 = proxy1->Dimension();
+            size_t dim_proxy2 = proxy2->Dimension();
+            size_t tt_pair = l1nr*trial_proxies.Size()+k1nr;
+            bool is_nonzero = nonzeros_proxies(tt_pair);
+            bool is_diagonal = diagonal_proxies(tt_pair);
+
+            if (is_nonzero)
+              {
+                HeapReset hr(lh);
+                bool samediffop = same_diffops(tt_pair);
+
+                FlatMatrix<SIMD<double>> proxyvalues(dim_proxy1*dim_proxy2, ir.Size(), lh);
+                for (size_t k = 0, kk = 0; k < dim_proxy1; k++)
+                  for (size_t l = 0; l < dim_proxy2; l++, kk++)
+                    {
+                      if (is_diagonal ? k == l : nonzeros(l1+l, k1+k))
+                        {
+                          ud.trialfunction = proxy1;
+                          ud.trial_comp = k;
+                          ud.testfunction = proxy2;
+                          ud.test_comp = l;
+                          cf -> Evaluate (mir, proxyvalues.Rows(kk,kk+1));
+                        }
+                      else
+                        proxyvalues.Row(kk) = 0.0;
+                    }
+                for (size_t i = 0; i < ir.Size(); i++)
+                  proxyvalues.Col(i) *= mir[i].GetWeight();
+
+                IntRange r1 = proxy1->Evaluator()->UsedDofs(fel);
+                IntRange r2 = proxy2->Evaluator()->UsedDofs(fel);
+
+                FlatMatrix<SIMD<double>> bbmat1(ndof*dim_proxy1, ir.Size(), lh);
+                FlatMatrix<SIMD<double>> bdbmat1(ndof*dim_proxy2, ir.Size(), lh);
+                FlatMatrix<SIMD<double>> bbmat2 = samediffop ?
+                  bbmat1 : FlatMatrix<SIMD<double>>(ndof*dim_proxy2, ir.Size(), lh);
+                FlatMatrix<SIMD<double>> hbdbmat1(ndof, dim_proxy2*ir.Size(), &bdbmat1(0,0));
+                FlatMatrix<SIMD<double>> hbbmat2(ndof, dim_proxy2*ir.Size(), &bbmat2(0,0));
+
+                proxy1->Evaluator()->CalcMatrix(fel, mir, bbmat1);
+                if (!samediffop)
+                  proxy2->Evaluator()->CalcMatrix(fel, mir, bbmat2);
+
+                bdbmat1 = 0.0;
+                for (auto i : r1)
+                  for (size_t j = 0; j < dim_proxy2; j++)
+                    for (size_t k = 0; k < dim_proxy1; k++)
+                      {
+                        auto res = bdbmat1.Row(i*dim_proxy2+j);
+                        auto a = bbmat1.Row(i*dim_proxy1+k);
+                        auto b = proxyvalues.Row(k*dim_proxy2+j);
+                        res += pw_mult(a,b);
+                      }
+
+                // lane-wise reduction, every lane is one element matrix
+                symmetric_so_far &= samediffop && is_diagonal;
+                for (auto i : r2)
+                  for (auto j : r1)
+                    {
+                      if (symmetric_so_far && j > i) break;
+                      SIMD<double> sum(0.0);
+                      for (size_t k = 0; k < hbbmat2.Width(); k++)
+                        sum += hbbmat2(i,k) * hbdbmat1(j,k);
+                      simd_elmat(i,j) += sum;
+                    }
+                if (symmetric_so_far)
+                  for (auto i : r2)
+                    for (auto j : r1)
+                      if (j > i) simd_elmat(i,j) = simd_elmat(j,i);
+              }
+            l1 += proxy2->Dimension();
+            l1nr++;
+          }
+        k1 += proxy1->Dimension();
+        k1nr++;
+      }
+
+    for (size_t e = 0; e < nel; e++)
+      {
+        auto elmat = elmats.Rows(e*ndof, (e+1)*ndof);
+        for (size_t i = 0; i < ndof; i++)
+          for (size_t j = 0; j < ndof; j++)
+            elmat(i,j) += simd_elmat(i,j)[e];
+      }
+  }
+
 
   
 
@@ -613,6 +613,18 @@ public:
                           FlatMatrix<Complex> elmat,
                           LocalHeap & lh) const override;    
 
+    /// up to SIMD-width elements are evaluated together, one element per lane
+    virtual void 
+    CalcElementMatricesAdd (const FiniteElement & fel,
+                            FlatArray<const ElementTransformation*> trafos,
+                            FlatMatrix<double> elmats,
+                            LocalHeap & lh) const override;
+
+    template <int D>
+    void T_CalcElementMatricesBatched (const FiniteElement & fel,
+                                       FlatArray<const ElementTransformation*> trafos,
+                                       FlatMatrix<double> elmats,
+                                       LocalHeap & lh) const;
     
     template <typename SCAL, typename SCAL_SHAPES, typename SCAL_RES>
     void T_CalcElementMatrixAdd (const FiniteElement & fel,
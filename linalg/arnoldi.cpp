@@ -36,7 +36,9 @@ namespace ngla
 
 
     Matrix<SCAL> matH(m);
+    Vector<SCAL> hcol(m);
     Array<shared_ptr<BaseVector>> abv(m);
+    Array<const BaseVector*> pabv;
     for (int i = 0; i < m; i++)
       abv[i] = a.CreateVector();
 
@@ -80,30 +82,15 @@ namespace ngla
 	*hva = b * *hv;
 	*hvm = *inv * *hva;
 
-	for (int j = 0; j <= i; j++)
-	  {
-            /*
-            SCAL sum = 0.0;
-	    for (int k = 0; k < n; k++)
-	      sum += hvm.FV<SCAL>()(k) * matV(j,k);
-	    matH(j,i) = sum;
-	    for (int k = 0; k < n; k++)
-	      hvm.FV<SCAL>()(k) -= sum * matV(j,k);
-            */
-            /*
-            SCAL sum = 0.0;
-            FlatVector<SCAL> abvj = abv[j] -> FV<SCAL>();
-            FlatVector<SCAL> fv_hvm = hvm.FV<SCAL>();
-	    for (int k = 0; k < n; k++)
-	      sum += fv_hvm(k) * abvj(k);
-	    matH(j,i) = sum;
-	    for (int k = 0; k < n; k++)
-	      fv_hvm(k) -= sum * abvj(k);
-            */
-
-	    matH(j,i) = S_InnerProduct<SCAL> (*hvm, *abv[j]);
-	    *hvm -= matH(j,i) * *abv[j];
-	  }
+        // classical Gram-Schmidt with fused kernels, twice for stability
+        pabv.Append (abv[i].get());
+        for (int k = 0; k < 2; k++)
+          {
+            S_MultiInnerProduct<SCAL> (*hvm, pabv, hcol.Range(0,i+1));
+            matH.Col(i).Range(0,i+1) += hcol.Range(0,i+1);
+            hcol.Range(0,i+1) *= -1;
+            S_AddLinearCombination<SCAL> (*hvm, 1.0, hcol.Range(0,i+1), pabv);
+          }
 		
 	*hv = *hvm;
 	*hv2 = *hv;
@@ -160,6 +160,32 @@ namespace ngla
   }
 
 
+  double BaseVector :: AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+  {
+    Add (scal, v);
+    return InnerProductD (w);
+  }
+
+  void BaseVector :: MultiInnerProductD (FlatArray<const BaseVector*> vecs, FlatVector<double> res) const
+  {
+    for (size_t i = 0; i < vecs.Size(); i++)
+      res(i) = InnerProductD (*vecs[i]);
+  }
+
+  BaseVector & BaseVector :: AddLinearCombination (double scal, FlatVector<double> coefs,
+                                                   FlatArray<const BaseVector*> vecs)
+  {
+    size_t first = 0;
+    if (scal == 0 && vecs.Size())
+      Set (coefs(first++), *vecs[0]);
+    else
+      Scale (scal);
+    for (size_t i = first; i < vecs.Size(); i++)
+      Add (coefs(i), *vecs[i]);
+    return *this;
+  }
+
+
   double BaseVector :: InnerProductD (const BaseVector & v2) const
   {
     return dynamic_cast<const S_BaseVector<double>&> (*this) . 
@@ -669,6 +695,223 @@ namespace ngla
 
 
 
+
+
+
+  /*
+    Fused vector kernels. Each task works on blocks of the vectors
+    which stay in the L1 cache while all vectors are combined.
+   */
+  
+  constexpr size_t FUSED_BLOCK = 1024;
+
+  // x += scal * y, returns <x,z>
+  static double AddInnerProductKernel (double scal, double * px, const double * py,
+                                       const double * pz, size_t n)
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+    SIMD<double> sscal(scal), sum(0.0);
+    size_t i = 0;
+    for ( ; i+SW <= n; i += SW)
+      {
+        SIMD<double> xi = FMA (sscal, SIMD<double>(py+i), SIMD<double>(px+i));
+        xi.Store (px+i);
+        sum = FMA (xi, SIMD<double>(pz+i), sum);
+      }
+    double hsum = HSum(sum);
+    for ( ; i < n; i++)
+      {
+        px[i] += scal * py[i];
+        hsum += px[i] * pz[i];
+      }
+    return hsum;
+  }
+
+  // res[l] += <x, y_l>, l < K
+  template <int K>
+  static void MultiInnerProductKernel (const double * px, const double * const * py,
+                                       double * res, size_t n)
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+    SIMD<double> sum[K];
+    for (int l = 0; l < K; l++) sum[l] = SIMD<double>(0.0);
+    size_t i = 0;
+    for ( ; i+SW <= n; i += SW)
+      {
+        SIMD<double> xi(px+i);
+        for (int l = 0; l < K; l++)
+          sum[l] = FMA (xi, SIMD<double>(py[l]+i), sum[l]);
+      }
+    for (int l = 0; l < K; l++)
+      {
+        double hsum = HSum(sum[l]);
+        for (size_t j = i; j < n; j++)
+          hsum += px[j] * py[l][j];
+        res[l] += hsum;
+      }
+  }
+
+  // x = scal * x + sum_l coefs[l] * y_l
+  static void LinearCombinationKernel (double scal, double * px, const double * coefs,
+                                       const double * const * py, size_t k, size_t n)
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+    size_t i = 0;
+    for ( ; i+SW <= n; i += SW)
+      {
+        SIMD<double> sum = (scal == 0) ? SIMD<double>(0.0) : SIMD<double>(scal) * SIMD<double>(px+i);
+        for (size_t l = 0; l < k; l++)
+          sum = FMA (SIMD<double>(coefs[l]), SIMD<double>(py[l]+i), sum);
+        sum.Store (px+i);
+      }
+    for ( ; i < n; i++)
+      {
+        double sum = (scal == 0) ? 0.0 : scal * px[i];
+        for (size_t l = 0; l < k; l++)
+          sum += coefs[l] * py[l][i];
+        px[i] = sum;
+      }
+  }
+
+
+  template <>
+  double S_BaseVector<double> :: AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+  {
+    static Timer t("BaseVector::AddInnerProduct");
+    RegionTimer reg(t);
+
+    auto me = FVDouble();
+    auto fv = v.FVDouble();
+    auto fw = w.FVDouble();
+    if (me.Size() != fv.Size() || me.Size() != fw.Size())
+      throw Exception (string ("BaseVector::AddInnerProduct: size of me = ") +
+                       ToString(me.Size()) + " != size of others = " +
+                       ToString(fv.Size()) + ", " + ToString(fw.Size()));
+    t.AddFlops (2*me.Size());
+
+    double parts[16];
+    ParallelJob ([me,fv,fw,scal,&parts] (TaskInfo ti)
+                 {
+                   auto r = ::Range(me).Split (ti.task_nr, ti.ntasks);
+                   parts[ti.task_nr] = AddInnerProductKernel (scal, me.Addr(r.First()), fv.Addr(r.First()),
+                                                              fw.Addr(r.First()), r.Size());
+                 }, 16);
+    double sum = 0;
+    for (double part : parts) sum += part;
+    return sum;
+  }
+
+  template <>
+  double S_BaseVector<Complex> :: AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+  {
+    return BaseVector::AddInnerProductD (scal, v, w);
+  }
+
+  
+  template <>
+  void S_BaseVector<double> :: MultiInnerProductD (FlatArray<const BaseVector*> vecs,
+                                                   FlatVector<double> res) const
+  {
+    static Timer t("BaseVector::MultiInnerProduct");
+    RegionTimer reg(t);
+
+    size_t k = vecs.Size();
+    if (k == 0) return;
+
+    auto me = FVDouble();
+    Array<const double*> pvecs(k);
+    for (size_t l = 0; l < k; l++)
+      {
+        auto fv = vecs[l]->FVDouble();
+        if (fv.Size() != me.Size())
+          throw Exception (string ("BaseVector::MultiInnerProduct: size of me = ") +
+                           ToString(me.Size()) + " != size of other = " + ToString(fv.Size()));
+        pvecs[l] = fv.Data();
+      }
+    t.AddFlops (me.Size()*k);
+
+    Matrix<double> parts(16, k);
+    parts = 0.0;
+    ParallelJob ([me,&pvecs,&parts,k] (TaskInfo ti)
+                 {
+                   auto r = ::Range(me).Split (ti.task_nr, ti.ntasks);
+                   const double * py[4];
+                   for (size_t first = r.First(); first < r.Next(); first += FUSED_BLOCK)
+                     {
+                       size_t n = min2(FUSED_BLOCK, r.Next()-first);
+                       const double * px = me.Addr(first);
+                       double * pres = &parts(ti.task_nr, 0);
+                       size_t l = 0;
+                       for ( ; l+4 <= k; l += 4)
+                         {
+                           for (int j = 0; j < 4; j++) py[j] = pvecs[l+j]+first;
+                           MultiInnerProductKernel<4> (px, py, pres+l, n);
+                         }
+                       for ( ; l < k; l++)
+                         {
+                           py[0] = pvecs[l]+first;
+                           MultiInnerProductKernel<1> (px, py, pres+l, n);
+                         }
+                     }
+                 }, 16);
+
+    for (size_t l = 0; l < k; l++)
+      res(l) = 0.0;
+    for (size_t j = 0; j < 16; j++)
+      res.Range(0,k) += parts.Row(j);
+  }
+
+  template <>
+  void S_BaseVector<Complex> :: MultiInnerProductD (FlatArray<const BaseVector*> vecs,
+                                                    FlatVector<double> res) const
+  {
+    BaseVector::MultiInnerProductD (vecs, res);
+  }
+
+
+  template <>
+  BaseVector & S_BaseVector<double> :: AddLinearCombination (double scal, FlatVector<double> coefs,
+                                                             FlatArray<const BaseVector*> vecs)
+  {
+    static Timer t("BaseVector::AddLinearCombination");
+    RegionTimer reg(t);
+
+    size_t k = vecs.Size();
+    auto me = FVDouble();
+    Array<const double*> pvecs(k);
+    for (size_t l = 0; l < k; l++)
+      {
+        auto fv = vecs[l]->FVDouble();
+        if (fv.Size() != me.Size())
+          throw Exception (string ("BaseVector::AddLinearCombination: size of me = ") +
+                           ToString(me.Size()) + " != size of other = " + ToString(fv.Size()));
+        pvecs[l] = fv.Data();
+      }
+    t.AddFlops (me.Size()*(k+1));
+
+    ParallelForRange (me.Range(),
+                      [me,&pvecs,coefs,scal,k] (IntRange r)
+                      {
+                        Array<const double*> py(k);
+                        for (size_t first = r.First(); first < r.Next(); first += FUSED_BLOCK)
+                          {
+                            size_t n = min2(FUSED_BLOCK, r.Next()-first);
+                            for (size_t l = 0; l < k; l++) py[l] = pvecs[l]+first;
+                            LinearCombinationKernel (scal, me.Addr(first), coefs.Data(), &py[0], k, n);
+                          }
+                      });
+    return *this;
+  }
+
+  template <>
+  BaseVector & S_BaseVector<Complex> :: AddLinearCombination (double scal, FlatVector<double> coefs,
+                                                              FlatArray<const BaseVector*> vecs)
+  {
+    return BaseVector::AddLinearCombination (scal, coefs, vecs);
+  }
+
+
+
   template <class SCAL>
   FlatVector<double> S_BaseVector<SCAL> :: FVDouble () const 
   {
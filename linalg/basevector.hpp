@@ -233,6 +233,14 @@ namespace ngla
     virtual BaseVector & Add (double scal, const BaseVector & v);
     virtual BaseVector & Add (Complex scal, const BaseVector & v);
 
+    /// this += scal * v, returns InnerProduct (this, w) computed in the same pass
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w);
+    /// res(i) = InnerProduct (this, *vecs[i]), one sweep over this
+    virtual void MultiInnerProductD (FlatArray<const BaseVector*> vecs, FlatVector<double> res) const;
+    /// this = scal * this + sum_i coefs(i) * vecs[i], in one pass
+    virtual BaseVector & AddLinearCombination (double scal, FlatVector<double> coefs,
+                                               FlatArray<const BaseVector*> vecs);
+
     virtual ostream & Print (ostream & ost) const;
     virtual void Save(ostream & ost) const;
     virtual void Load(istream & ist);
@@ -489,6 +497,20 @@ namespace ngla
       return vec->Add (scal,v);
     }
 
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w)
+    {
+      return vec->AddInnerProductD (scal, v, w);
+    }
+    virtual void MultiInnerProductD (FlatArray<const BaseVector*> vecs, FlatVector<double> res) const
+    {
+      vec->MultiInnerProductD (vecs, res);
+    }
+    virtual BaseVector & AddLinearCombination (double scal, FlatVector<double> coefs,
+                                               FlatArray<const BaseVector*> vecs)
+    {
+      return vec->AddLinearCombination (scal, coefs, vecs);
+    }
+
     virtual ostream & Print (ostream & ost) const
     {
       return vec->Print (ost);
@@ -568,6 +590,11 @@ namespace ngla
     virtual double InnerProductD (const BaseVector & v2) const;
     virtual Complex InnerProductC (const BaseVector & v2) const;
 
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w);
+    virtual void MultiInnerProductD (FlatArray<const BaseVector*> vecs, FlatVector<double> res) const;
+    virtual BaseVector & AddLinearCombination (double scal, FlatVector<double> coefs,
+                                               FlatArray<const BaseVector*> vecs);
+
 
     virtual FlatVector<double> FVDouble () const;
     virtual FlatVector<Complex> FVComplex () const;
@@ -1012,6 +1039,68 @@ namespace ngla
     return InnerProduct( v2.FVComplex(), Conj(v1.FVComplex()) );
   }
 
+
+  /*
+    Fused kernels for Krylov space methods. The real versions
+    call the SIMD and task-parallel vector kernels, the complex ones
+    are composed of the single operations.
+  */
+
+  /// v1 += scal * v2, returns S_InnerProduct (v1, w)
+  template <class IPTYPE>
+  inline typename SCAL_TRAIT<IPTYPE>::SCAL
+  S_AddInnerProduct (BaseVector & v1, typename SCAL_TRAIT<IPTYPE>::SCAL scal,
+                     const BaseVector & v2, const BaseVector & w)
+  {
+    v1.Add (scal, v2);
+    return S_InnerProduct<IPTYPE> (v1, w);
+  }
+
+  template <> inline double
+  S_AddInnerProduct<double> (BaseVector & v1, double scal,
+                             const BaseVector & v2, const BaseVector & w)
+  {
+    return v1.AddInnerProductD (scal, v2, w);
+  }
+
+  /// res(i) = S_InnerProduct (*vecs[i], v)
+  template <class IPTYPE>
+  inline void S_MultiInnerProduct (const BaseVector & v, FlatArray<const BaseVector*> vecs,
+                                   FlatVector<typename SCAL_TRAIT<IPTYPE>::SCAL> res)
+  {
+    for (size_t i = 0; i < vecs.Size(); i++)
+      res(i) = S_InnerProduct<IPTYPE> (*vecs[i], v);
+  }
+
+  template <> inline void
+  S_MultiInnerProduct<double> (const BaseVector & v, FlatArray<const BaseVector*> vecs,
+                               FlatVector<double> res)
+  {
+    v.MultiInnerProductD (vecs, res);
+  }
+
+  /// v = scal * v + sum_i coefs(i) * vecs[i]
+  template <class SCAL>
+  inline void S_AddLinearCombination (BaseVector & v, SCAL scal, FlatVector<SCAL> coefs,
+                                      FlatArray<const BaseVector*> vecs)
+  {
+    size_t first = 0;
+    if (scal == 0.0 && vecs.Size())
+      v.Set (coefs(first++), *vecs[0]);
+    else
+      v.Scale (scal);
+    for (size_t i = first; i < vecs.Size(); i++)
+      v.Add (coefs(i), *vecs[i]);
+  }
+
+  template <> inline void
+  S_AddLinearCombination<double> (BaseVector & v, double scal, FlatVector<double> coefs,
+                                  FlatArray<const BaseVector*> vecs)
+  {
+    v.AddLinearCombination (scal, coefs, vecs);
+  }
+
+
   ///
   inline double L2Norm (const BaseVector & v)
   {
@@ -308,6 +308,298 @@ namespace ngla
 
 
 
+  void BaseBlockJacobiPrecond ::
+  ComputeColoring (const MatrixGraph & graph, bool symmetric)
+  {
+    static Timer t("BlockJacobi - coloring"); RegionTimer reg(t);
+    static Timer tgraph("BlockJacobi - coloring, block graph");
+    tgraph.Start();
+
+    size_t nblocks = blocktable->Size();
+
+    // the columns read (and for symmetric also written) by smoothing a block
+    auto footprint = [&] (size_t i, auto f)
+      {
+        for (int d : (*blocktable)[i])
+          for (int col : graph.GetRowIndices(d))
+            f(col);
+      };
+
+    // dof -> blocks containing the dof, dof -> blocks touching the dof
+    TableCreator<int> creator_contains, creator_touch;
+    for ( ; !creator_touch.Done(); creator_contains++, creator_touch++)
+      ParallelFor (nblocks, [&] (size_t i)
+                   {
+                     for (int d : (*blocktable)[i])
+                       creator_contains.Add (d, i);
+                     footprint (i, [&] (int col) { creator_touch.Add (col, i); });
+                   }, TasksPerThread(4));
+    Table<int> contains = creator_contains.MoveTable();
+    Table<int> touch = creator_touch.MoveTable();
+
+    // symmetric:     footprint(i) cap footprint(j) = 0
+    // non-symmetric: block(i) cap footprint(j) = 0, and vice versa
+    auto neighbours = [&] (size_t i, Array<int> & nbs)
+      {
+        nbs.SetSize0();
+        footprint (i, [&] (int col)
+                   {
+                     if (symmetric)
+                       nbs.Append (touch[col]);
+                     else if (col < contains.Size())
+                       nbs.Append (contains[col]);
+                   });
+        if (!symmetric)
+          for (int d : (*blocktable)[i])
+            if (d < touch.Size())
+              nbs.Append (touch[d]);
+        QuickSort (nbs);
+        size_t cnt = 0;
+        for (size_t k = 0; k < nbs.Size(); k++)
+          if (nbs[k] != int(i) && (cnt == 0 || nbs[k] != nbs[cnt-1]))
+            nbs[cnt++] = nbs[k];
+        nbs.SetSize (cnt);
+      };
+
+    TableCreator<int> creator_graph(nblocks);
+    for ( ; !creator_graph.Done(); creator_graph++)
+      ParallelForRange (nblocks, [&] (IntRange r)
+                        {
+                          Array<int> nbs;
+                          for (auto i : r)
+                            {
+                              neighbours (i, nbs);
+                              for (int j : nbs)
+                                creator_graph.Add (i, j);
+                            }
+                        }, TasksPerThread(4));
+    Table<int> blockgraph = creator_graph.MoveTable();
+    tgraph.Stop();
+
+    // greedy coloring, usedby[c] == i iff color c is taken by a neighbour of block i
+    Array<int> coloring(nblocks);
+    coloring = -1;
+    Array<int> usedby;
+    for (int i = 0; i < nblocks; i++)
+      {
+        for (int j : blockgraph[i])
+          if (coloring[j] >= 0)
+            usedby[coloring[j]] = i;
+        int color = 0;
+        while (color < usedby.Size() && usedby[color] == i)
+          color++;
+        if (color == usedby.Size())
+          usedby.Append (-1);
+        coloring[i] = color;
+      }
+    int ncolors = usedby.Size();
+
+    TableCreator<int> creator(ncolors);
+    for ( ; !creator.Done(); creator++)
+      for (size_t i = 0; i < nblocks; i++)
+        creator.Add (coloring[i], i);
+    block_coloring = creator.MoveTable();
+
+    cout << IM(3) << " using " << ncolors << " colors" << endl;
+
+    // calc balancing:
+    color_balance.SetSize (ncolors);
+    for (auto c : Range (block_coloring))
+      color_balance[c].Calc (block_coloring[c].Size(),
+                             [&] (size_t bi)
+                             {
+                               int costs = 0;
+                               for (auto d : (*blocktable)[block_coloring[c][bi]])
+                                 costs += graph.GetRowIndices(d).Size();
+                               return costs;
+                             });
+  }
+
+
+
+  BlockInverseBatches ::
+  BlockInverseBatches (const SparseMatrix<double> & mat,
+                       shared_ptr<Table<int>> ablocktable,
+                       const Table<int> & block_coloring)
+    : blocktable(ablocktable)
+  {
+    static Timer t("BlockInverseBatches ctor"); RegionTimer reg(t);
+    constexpr int SW = SIMD<double>::Size();
+
+    maxbs = 0;
+    for (auto block : *blocktable)
+      maxbs = max2 (maxbs, int(block.Size()));
+
+    // blocks of one color, sorted by size, are grouped to batches
+    firstbatch.SetSize (block_coloring.Size()+1);
+    firstbatch[0] = 0;
+    Array<int> sorted;
+    for (auto c : Range (block_coloring))
+      {
+        sorted.SetSize0();
+        for (int i : block_coloring[c])
+          if ((*blocktable)[i].Size())
+            sorted.Append (i);
+        QuickSort (sorted, [&] (int i, int j)
+                   { return (*blocktable)[i].Size() > (*blocktable)[j].Size(); });
+
+        for (size_t k = 0; k < sorted.Size(); k += SW)
+          {
+            batchsize.Append ((*blocktable)[sorted[k]].Size());
+            for (size_t l = k; l < k+SW; l++)
+              lanes.Append (l < sorted.Size() ? sorted[l] : -1);
+          }
+        firstbatch[c+1] = batchsize.Size();
+      }
+
+    batchstart.SetSize (batchsize.Size()+1);
+    batchstart[0] = 0;
+    for (auto b : Range (batchsize))
+      batchstart[b+1] = batchstart[b] + sqr (size_t(batchsize[b]));
+    data.SetSize (batchstart.Last());
+
+    ParallelForRange
+      (batchsize.Size(), [&] (IntRange r)
+       {
+         Matrix<> blockmat(maxbs);
+         for (auto b : r)
+           {
+             FlatMatrix<SIMD<double>> inv = Inverse(b);
+             inv = SIMD<double>(0.0);
+             FlatArray<int> blocks = Lanes(b);
+             for (int l = 0; l < SW; l++)
+               {
+                 if (blocks[l] < 0) continue;
+                 FlatArray<int> block = (*blocktable)[blocks[l]];
+                 QuickSort (block);
+                 size_t bs = block.Size();
+                 FlatMatrix<> hm (bs, bs, &blockmat(0,0));
+                 for (size_t j = 0; j < bs; j++)
+                   for (size_t k = 0; k < bs; k++)
+                     hm(j,k) = mat(block[j], block[k]);
+                 CalcInverse (hm);
+                 for (size_t j = 0; j < bs; j++)
+                   for (size_t k = 0; k < bs; k++)
+                     inv(j,k)[l] = hm(j,k);
+               }
+           }
+       }, TasksPerThread(4));
+
+    cout << IM(4) << " using " << batchsize.Size() << " batches of "
+         << SW << " blocks for " << blocktable->Size() << " blocks" << endl;
+  }
+
+
+  void BlockInverseBatches ::
+  SmoothColor (int c, const SparseMatrix<double> & mat,
+               FlatVector<double> x, FlatVector<double> b) const
+  {
+    constexpr int SW = SIMD<double>::Size();
+    ParallelForRange
+      (IntRange (firstbatch[c], firstbatch[c+1]), [&] (IntRange r)
+       {
+         Array<SIMD<double>> hx(maxbs), hy(maxbs);
+         for (auto bnr : r)
+           {
+             int n = batchsize[bnr];
+             FlatArray<int> blocks = Lanes(bnr);
+             hx.Range(0,n) = SIMD<double>(0.0);
+             for (int l = 0; l < SW; l++)
+               if (blocks[l] >= 0)
+                 {
+                   FlatArray<int> block = (*blocktable)[blocks[l]];
+                   for (size_t j = 0; j < block.Size(); j++)
+                     hx[j][l] = b(block[j]) - mat.RowTimesVector (block[j], x);
+                 }
+
+             MultBatchMatVec (n, n, Inverse(bnr), &hx[0], &hy[0]);
+
+             for (int l = 0; l < SW; l++)
+               if (blocks[l] >= 0)
+                 {
+                   FlatArray<int> block = (*blocktable)[blocks[l]];
+                   for (size_t j = 0; j < block.Size(); j++)
+                     x(block[j]) += hy[j][l];
+                 }
+           }
+       }, TasksPerThread(4));
+  }
+
+
+  void BlockInverseBatches ::
+  MultAdd (double s, FlatVector<double> x, FlatVector<double> y, bool transpose) const
+  {
+    constexpr int SW = SIMD<double>::Size();
+    // the blocks of one color are disjoint
+    for (size_t c = 0; c+1 < firstbatch.Size(); c++)
+      ParallelForRange
+        (IntRange (firstbatch[c], firstbatch[c+1]), [&] (IntRange r)
+         {
+           Array<SIMD<double>> hx(maxbs), hy(maxbs);
+           for (auto bnr : r)
+             {
+               int n = batchsize[bnr];
+               FlatArray<int> blocks = Lanes(bnr);
+               hx.Range(0,n) = SIMD<double>(0.0);
+               for (int l = 0; l < SW; l++)
+                 if (blocks[l] >= 0)
+                   {
+                     FlatArray<int> block = (*blocktable)[blocks[l]];
+                     for (size_t j = 0; j < block.Size(); j++)
+                       hx[j][l] = x(block[j]);
+                   }
+               
+               if (transpose)
+                 MultBatchMatTransVec (n, n, Inverse(bnr), &hx[0], &hy[0]);
+               else
+                 MultBatchMatVec (n, n, Inverse(bnr), &hx[0], &hy[0]);
+               
+               for (int l = 0; l < SW; l++)
+                 if (blocks[l] >= 0)
+                   {
+                     FlatArray<int> block = (*blocktable)[blocks[l]];
+                     for (size_t j = 0; j < block.Size(); j++)
+                       y(block[j]) += s * hy[j][l];
+                   }
+             }
+         }, TasksPerThread(4));
+  }
+
+
+  // batched inverses are available for double valued blocks only
+  template <class TM, class TV_ROW, class TV_COL>
+  static shared_ptr<BlockInverseBatches>
+  CreateBlockInverseBatches (const SparseMatrix<TM,TV_ROW,TV_COL> & mat,
+                             shared_ptr<Table<int>> blocktable, const Table<int> & coloring)
+  { return nullptr; }
+
+  static shared_ptr<BlockInverseBatches>
+  CreateBlockInverseBatches (const SparseMatrix<double,double,double> & mat,
+                             shared_ptr<Table<int>> blocktable, const Table<int> & coloring)
+  { return make_shared<BlockInverseBatches> (mat, blocktable, coloring); }
+
+  template <class TM, class TV_ROW, class TV_COL, class TVX>
+  static void SmoothColorBatched (const BlockInverseBatches & batches, int c,
+                                  const SparseMatrix<TM,TV_ROW,TV_COL> & mat,
+                                  FlatVector<TVX> x, FlatVector<TVX> b)
+  { throw Exception ("batched block smoother for double only"); }
+
+  static void SmoothColorBatched (const BlockInverseBatches & batches, int c,
+                                  const SparseMatrix<double,double,double> & mat,
+                                  FlatVector<double> x, FlatVector<double> b)
+  { batches.SmoothColor (c, mat, x, b); }
+
+  template <class TSCAL, class TVX>
+  static void MultAddBatched (const BlockInverseBatches & batches, TSCAL s,
+                              FlatVector<TVX> x, FlatVector<TVX> y, bool transpose)
+  { throw Exception ("batched block Jacobi for double only"); }
+
+  static void MultAddBatched (const BlockInverseBatches & batches, double s,
+                              FlatVector<double> x, FlatVector<double> y, bool transpose)
+  { batches.MultAdd (s, x, y, transpose); }
+
+
+
   ///
   template <class TM, class TV_ROW, class TV_COL>
   BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
@@ -346,146 +638,66 @@ namespace ngla
                       [] (size_t a, size_t b) { return a+b; },
                       size_t(0));
 
-    /*
-    size_t totmem = 0;
-    for (auto i : Range (*blocktable))
-      totmem += sqr ((*blocktable)[i].Size());
-    */
-    size_t totmem = 
-      ParallelReduce (blocktable->Size(),
-                      [&] (size_t i) { return sqr ((*blocktable)[i].Size()); },
-                      [] (size_t a, size_t b) { return a+b; },
-                      size_t(0));
-
-    bigmem.SetSize(totmem);
-    
-    totmem = 0;
-    for (auto i : Range (*blocktable))
-      {
-        size_t bs = (*blocktable)[i].Size();
-        new ( & invdiag[i] ) FlatMatrix<TM> (bs, bs, bigmem.Addr(totmem));
-        totmem += sqr (bs);
-      }
-
-
-    atomic<int> cnt(0);
-    SharedLoop2 sl(blocktable->Size());
+    ComputeColoring (mat, false);
 
-    /*
-    ParallelFor 
-      (Range(*blocktable), [&] (int i)
-    */
-    ParallelJob
-      ([&] (const TaskInfo & ti)
-       {
-         NgProfiler::StartThreadTimer (tpar, TaskManager::GetThreadId());         
-         for (int i : sl)
-       {
-         NgProfiler::StartThreadTimer (tprep, TaskManager::GetThreadId());
+    // double valued blocks are stored and applied in SIMD batches
+    batches = CreateBlockInverseBatches (mat, blocktable, block_coloring);
 
-        auto blocki = (*blocktable)[i];
-        QuickSort (blocki);
-	if (!blocki.Size()) 
-	  {
-            NgProfiler::StopThreadTimer (tprep, TaskManager::GetThreadId());                             
-	    invdiag[i] = 0;
-	    // return;
-            continue;
-	  }
-	
-        FlatMatrix<TM> & blockmat = invdiag[i];
-        NgProfiler::StopThreadTimer (tprep, TaskManager::GetThreadId());                 
-        NgProfiler::StartThreadTimer (tget, TaskManager::GetThreadId());
-	for (size_t j = 0; j < blocki.Size(); j++)
-	  for (size_t k = 0; k < blocki.Size(); k++)
-	    blockmat(j,k) = mat(blocki[j], blocki[k]);
-        NgProfiler::StopThreadTimer (tget, TaskManager::GetThreadId());                         
-        NgProfiler::StartThreadTimer (tinv, TaskManager::GetThreadId());
-	CalcInverse (blockmat);
-        NgProfiler::StopThreadTimer (tinv, TaskManager::GetThreadId());        
-        // }, TasksPerThread(10));
-       }
-         NgProfiler::StopThreadTimer (tpar, TaskManager::GetThreadId());                  
-       } );
-    
-    cout << IM(3) << "\rBuilding block " << blocktable->Size() << "/" << blocktable->Size() << flush;
-    *testout << "block coloring";
-
-    static Timer tcol("BlockJacobi-coloring");
-    tcol.Start();
-
-    size_t nblocks = blocktable->Size();
-    Array<int> coloring(nblocks);
-    coloring = -1;
-
-    int maxcolor = 0;
-    int basecol = 0;
-    Array<unsigned int> mask(mat.Width());
-    size_t found = 0;
-
-    do
+    if (!batches)
       {
-        mask = 0;
+        size_t totmem = 
+          ParallelReduce (blocktable->Size(),
+                          [&] (size_t i) { return sqr ((*blocktable)[i].Size()); },
+                          [] (size_t a, size_t b) { return a+b; },
+                          size_t(0));
         
-        for (auto i : Range(nblocks))
-          {
-            if (coloring[i] >= 0) continue;
-
-            unsigned check = 0;
-	    for (int d : (*blocktable)[i] )              
-              check |= mask[d];
-            
-            if (check != UINT_MAX) // 0xFFFFFFFF)
-              {
-                found++;
-                unsigned checkbit = 1;
-                int color = basecol;
-                while (check & checkbit)
-                  {
-                    color++;
-                    checkbit *= 2;
-                  }
-
-                coloring[i] = color;
-                if (color > maxcolor) maxcolor = color;
-                
-                for (int d : (*blocktable)[i] )
-                  for(auto coupling : mat.GetRowIndices(d))
-                    mask[coupling] |= checkbit;
-              }
-          }
-        basecol += 8*sizeof(unsigned int); // 32;
-      }
-    while (found < nblocks);
-    tcol.Stop();    
-
-    TableCreator<int> creator(maxcolor+1);
-    for ( ; !creator.Done(); creator++)
-      for (size_t i = 0; i < nblocks; i++)
-          creator.Add (coloring[i], i);
-    block_coloring = creator.MoveTable();
-
-    cout << IM(4) << " using " << maxcolor+1 << " colors" << endl;
-
-    // calc balancing:
-
-    color_balance.SetSize (block_coloring.Size());
-
-    for (auto c : Range (block_coloring))
-      {
-        color_balance[c].Calc (block_coloring[c].Size(),
-                               [&] (size_t bi)
-                               {
-                                 int costs = 0;
-                                 size_t blocknr = block_coloring[c][bi];
-
-                                 for (auto d : (*blocktable)[blocknr])
-                                   costs += mat.GetRowIndices(d).Size();
-                                 return costs;
-                               });
-
+        // the inverses of one color are stored contiguously, in smoothing order
+        bigmem.SetSize(totmem);
+        
+        totmem = 0;
+        for (auto c : Range (block_coloring))
+          for (auto i : block_coloring[c])
+            {
+              size_t bs = (*blocktable)[i].Size();
+              new ( & invdiag[i] ) FlatMatrix<TM> (bs, bs, bigmem.Addr(totmem));
+              totmem += sqr (bs);
+            }
+        
+        SharedLoop2 sl(blocktable->Size());
+        
+        ParallelJob
+          ([&] (const TaskInfo & ti)
+           {
+             NgProfiler::StartThreadTimer (tpar, TaskManager::GetThreadId());         
+             for (int i : sl)
+               {
+                 NgProfiler::StartThreadTimer (tprep, TaskManager::GetThreadId());
+                 
+                 auto blocki = (*blocktable)[i];
+                 QuickSort (blocki);
+                 if (!blocki.Size()) 
+                   {
+                     NgProfiler::StopThreadTimer (tprep, TaskManager::GetThreadId());
+                     invdiag[i] = 0;
+                     continue;
+                   }
+                 
+                 FlatMatrix<TM> & blockmat = invdiag[i];
+                 NgProfiler::StopThreadTimer (tprep, TaskManager::GetThreadId());                 
+                 NgProfiler::StartThreadTimer (tget, TaskManager::GetThreadId());
+                 for (size_t j = 0; j < blocki.Size(); j++)
+                   for (size_t k = 0; k < blocki.Size(); k++)
+                     blockmat(j,k) = mat(blocki[j], blocki[k]);
+                 NgProfiler::StopThreadTimer (tget, TaskManager::GetThreadId());                         
+                 NgProfiler::StartThreadTimer (tinv, TaskManager::GetThreadId());
+                 CalcInverse (blockmat);
+                 NgProfiler::StopThreadTimer (tinv, TaskManager::GetThreadId());        
+               }
+             NgProfiler::StopThreadTimer (tpar, TaskManager::GetThreadId());                  
+           } );
       }
-
+    
+    cout << IM(3) << "\rBuilding block " << blocktable->Size() << "/" << blocktable->Size() << endl;
     cout << IM(3) << "\rBlockJacobi Preconditioner built" << endl;
   }
 
@@ -509,6 +721,12 @@ namespace ngla
     FlatVector<TVX> fx = x.FV<TVX> ();
     FlatVector<TVX> fy = y.FV<TVX> ();
 
+    if (batches)
+      {
+        MultAddBatched (*batches, s, fx, fy, false);
+        return;
+      }
+
 
     for (int c : Range(block_coloring))        
       {
@@ -549,6 +767,12 @@ namespace ngla
     FlatVector<TVX> fx = x.FV<TVX> ();
     FlatVector<TVX> fy = y.FV<TVX> ();
 
+    if (batches)
+      {
+        MultAddBatched (*batches, s, fx, fy, true);
+        return;
+      }
+
     for (int c = 0; c < block_coloring.Size(); c++)
       {
         ParallelForRange
@@ -589,122 +813,17 @@ namespace ngla
   {
     static Timer timer ("BlockJacobiPrecond::GSSmooth");
     RegionTimer reg(timer);
-    timer.AddFlops (nze);
+    timer.AddFlops (steps*nze);
     
     FlatVector<TVX> fb = b.FV<TVX> (); 
     FlatVector<TVX> fx = x.FV<TVX> ();
 
-#ifdef OLD
-    for (int k = 0; k < steps; k++)
-      for (int c : Range(block_coloring))              
-        {
-          /*
-          ParallelForRange
-            (color_balance[c], [&] (IntRange r)
-             {
-               VectorMem<100,TVX> hxmax(maxbs);
-               VectorMem<100,TVX> hymax(maxbs);
-               
-               for (size_t i : block_coloring[c].Range(r))
-                 {
-                   FlatArray<int> block = (*blocktable)[i];
-                   size_t bs = block.Size();
-                   if (!bs) continue;
-                   
-                   FlatVector<TVX> hx = hxmax.Range(0,bs);
-                   FlatVector<TVX> hy = hymax.Range(0,bs);
-                   
-                   for (size_t j = 0; j < bs; j++)
-                     {
-                       auto jj = block[j];
-                       hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
-                     }
-                   
-                   hy = (invdiag[i]) * hx;
-                   fx(block) += hy;
-                 }
-               
-             });
-          */
-
-          auto col = block_coloring[c];
-          SharedLoop2 sl(col.Range());
-          
-          task_manager -> CreateJob
-              ( [&] (const TaskInfo & ti) 
-                {
-                  VectorMem<100,TVX> hxmax(maxbs);
-                  VectorMem<100,TVX> hymax(maxbs);
-
-                  for (auto mynr : sl)
-                    {
-                      size_t i = col[mynr];
-                      FlatArray<int> block = (*blocktable)[i];
-                      size_t bs = block.Size();
-                      if (!bs) continue;
-                      
-                      FlatVector<TVX> hx = hxmax.Range(0,bs);
-                      FlatVector<TVX> hy = hymax.Range(0,bs);
-                      
-                      for (size_t j = 0; j < bs; j++)
-                        {
-                          auto jj = block[j];
-                          hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
-                        }
-                      
-                      hy = (invdiag[i]) * hx;
-                      fx(block) += hy;
-                    }
-                });
-            
-        }
-#endif
-
-    Array<SharedLoop2> loops(block_coloring.Size());
-    
     for (int k = 0; k < steps; k++)
-      {
-        for (int c : Range(block_coloring))
-          loops[c].Reset (block_coloring[c].Range());
-
-        task_manager -> CreateJob
-          ( [&] (const TaskInfo & ti) 
-            {
-              VectorMem<100,TVX> hxmax(maxbs);
-              VectorMem<100,TVX> hymax(maxbs);
-              
-              for (int c : Range(block_coloring))              
-                {
-                  auto col = block_coloring[c];
-                  // SharedLoop2 sl(col.Range());
-
-                  for (auto mynr : loops[c])
-                    {
-                      size_t i = col[mynr];
-                      FlatArray<int> block = (*blocktable)[i];
-                      size_t bs = block.Size();
-                      if (!bs) continue;
-                      
-                      FlatVector<TVX> hx = hxmax.Range(0,bs);
-                      FlatVector<TVX> hy = hymax.Range(0,bs);
-                      
-                      for (size_t j = 0; j < bs; j++)
-                        {
-                          auto jj = block[j];
-                          hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
-                        }
-                      
-                      hy = (invdiag[i]) * hx;
-                      fx(block) += hy;
-                    }
-                }
-            });
-      }
+      for (int c : Range(block_coloring))
+        SmoothColor (c, fx, fb);
   }
   
 
-  
-
   template <class TM, class TV_ROW, class TV_COL>
   void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
   GSSmoothBack (BaseVector & x, const BaseVector & b,
@@ -712,46 +831,286 @@ namespace ngla
   {
     static Timer timer ("BlockJacobiPrecond::GSSmoothBack");
     RegionTimer reg(timer);
-    timer.AddFlops (nze);
+    timer.AddFlops (steps*nze);
 
-    const FlatVector<TVX> fb = b.FV<TVX> (); 
+    FlatVector<TVX> fb = b.FV<TVX> (); 
     FlatVector<TVX> fx = x.FV<TVX> ();
 
     for (int k = 0; k < steps; k++)
-      for (int c = block_coloring.Size()-1; c >=0; c--) 
-        {
-          ParallelForRange
-            (color_balance[c], [&] (IntRange r)
-             {
-               VectorMem<100,TVX> hxmax(maxbs);
-               VectorMem<100,TVX> hymax(maxbs);
-               
-               for (size_t i : block_coloring[c].Range(r))
+      for (int c = block_coloring.Size()-1; c >= 0; c--) 
+        SmoothColor (c, fx, fb);
+  }
+
+
+  template <class TM, class TV_ROW, class TV_COL>
+  void BlockJacobiPrecond<TM, TV_ROW, TV_COL> ::
+  SmoothColor (int c, FlatVector<TVX> fx, FlatVector<TVX> fb) const
+  {
+    if (batches)
+      {
+        SmoothColorBatched (*batches, c, mat, fx, fb);
+        return;
+      }
+
+    // blocks of one color don't couple, the ParallelForRange
+    // is the synchronization point between the colors
+    ParallelForRange
+      (color_balance[c], [&] (IntRange r)
+       {
+         VectorMem<100,TVX> hxmax(maxbs);
+         VectorMem<100,TVX> hymax(maxbs);
+         
+         for (size_t i : block_coloring[c].Range(r))
+           {
+             FlatArray<int> block = (*blocktable)[i];
+             size_t bs = block.Size();
+             if (!bs) continue;
+             
+             FlatVector<TVX> hx = hxmax.Range(0,bs); 
+             FlatVector<TVX> hy = hymax.Range(0,bs); 
+             
+             for (size_t j = 0; j < bs; j++)
+               {
+                 auto jj = block[j];
+                 hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
+               }
+             
+             hy = (invdiag[i]) * hx;
+             fx(block) += hy;
+           }
+       });
+  }
+
+
+
+
+
+
+  BandCholeskyBatches ::
+  BandCholeskyBatches (shared_ptr<Table<int>> ablocktable,
+                       const Table<int> & block_coloring,
+                       FlatArray<int> blockbw, TFactor factor)
+    : blocktable(ablocktable)
+  {
+    static Timer t("BandCholeskyBatches ctor"); RegionTimer reg(t);
+    constexpr int SW = SIMD<double>::Size();
+
+    maxbs = 0;
+    for (auto block : *blocktable)
+      maxbs = max2 (maxbs, int(block.Size()));
+
+    // blocks of one color, sorted by size, are grouped to batches
+    firstbatch.SetSize (block_coloring.Size()+1);
+    firstbatch[0] = 0;
+    Array<int> sorted;
+    for (auto c : Range (block_coloring))
+      {
+        sorted.SetSize0();
+        for (int i : block_coloring[c])
+          if ((*blocktable)[i].Size())
+            sorted.Append (i);
+        QuickSort (sorted, [&] (int i, int j)
+                   { return (*blocktable)[i].Size() > (*blocktable)[j].Size(); });
+
+        for (size_t k = 0; k < sorted.Size(); k += SW)
+          {
+            int bw = 0;
+            for (size_t l = k; l < k+SW; l++)
+              {
+                lanes.Append (l < sorted.Size() ? sorted[l] : -1);
+                if (l < sorted.Size())
+                  bw = max2 (bw, blockbw[sorted[l]]);
+              }
+            batchsize.Append ((*blocktable)[sorted[k]].Size());
+            batchbw.Append (bw);
+          }
+        firstbatch[c+1] = batchsize.Size();
+      }
+
+    batchstart.SetSize (batchsize.Size()+1);
+    batchstart[0] = 0;
+    for (auto b : Range (batchsize))
+      batchstart[b+1] = batchstart[b] +
+        FlatBandCholeskyFactors<double>::RequiredMem (batchsize[b], batchbw[b]);
+    data.SetSize (batchstart.Last());
+
+    ParallelForRange
+      (batchsize.Size(), [&] (IntRange r)
+       {
+         Array<double> mem;
+         for (auto b : r)
+           {
+             SIMD<double> * hm = &data[batchstart[b]];
+             for (size_t j = batchstart[b]; j < batchstart[b+1]; j++)
+               data[j] = SIMD<double>(0.0);
+             // the diagonal of unused rows stays 0, they solve to 0
+             FlatBandCholeskyFactors<SIMD<double>> fac (batchsize[b], batchbw[b], hm);
+             FlatArray<int> blocks = Lanes(b);
+             for (int l = 0; l < SW; l++)
+               {
+                 if (blocks[l] < 0) continue;
+                 int bs = (*blocktable)[blocks[l]].Size();
+                 int bw = blockbw[blocks[l]];
+                 mem.SetSize (FlatBandCholeskyFactors<double>::RequiredMem (bs, bw));
+                 FlatBandCholeskyFactors<double> inv (bs, bw, &mem[0]);
+                 factor (blocks[l], bw, inv);
+                 for (int j = 0; j < bs; j++)
+                   {
+                     hm[j][l] = mem[j];
+                     for (int k = max2(0, j-bw+1); k < j; k++)
+                       fac(j,k)[l] = inv(j,k);
+                   }
+               }
+           }
+       }, TasksPerThread(4));
+
+    cout << IM(4) << " using " << batchsize.Size() << " batches of "
+         << SW << " band factors for " << blocktable->Size() << " blocks" << endl;
+  }
+
+
+  void BandCholeskyBatches :: Solve (size_t b, SIMD<double> * x) const
+  {
+    int n = batchsize[b];
+    int bw = batchbw[b];
+    const SIMD<double> * hm = &data[batchstart[b]];
+
+    // L y = x, then D, then L^T
+    size_t jj = n;
+    for (int i = 0; i < n; i++)
+      {
+        SIMD<double> sum(0.0);
+        for (int j = max2(0, i-bw+1); j < i; j++, jj++)
+          sum += hm[jj] * x[j];
+        x[i] -= sum;
+      }
+
+    for (int i = 0; i < n; i++)
+      x[i] *= hm[i];
+
+    for (int i = n-1; i >= 0; i--)
+      {
+        int firstj = max2(0, i-bw+1);
+        jj -= i-firstj;
+        SIMD<double> val = x[i];
+        for (int j = firstj; j < i; j++)
+          x[j] -= hm[jj+j-firstj] * val;
+      }
+  }
+
+
+  void BandCholeskyBatches ::
+  SmoothColor (int c, const SparseMatrixSymmetric<double> & mat,
+               FlatVector<double> x, FlatVector<double> y) const
+  {
+    constexpr int SW = SIMD<double>::Size();
+    ParallelForRange
+      (IntRange (firstbatch[c], firstbatch[c+1]), [&] (IntRange r)
+       {
+         Array<SIMD<double>> hx(maxbs);
+         for (auto bnr : r)
+           {
+             int n = batchsize[bnr];
+             FlatArray<int> blocks = Lanes(bnr);
+             hx.Range(0,n) = SIMD<double>(0.0);
+             // d = P_i (y - L x)
+             for (int l = 0; l < SW; l++)
+               if (blocks[l] >= 0)
                  {
-                   FlatArray<int> block = (*blocktable)[i];
-                   size_t bs = block.Size();
-                   if (!bs) continue;
-                   
-                   FlatVector<TVX> hx = hxmax.Range(0,bs); 
-                   FlatVector<TVX> hy = hymax.Range(0,bs); 
-                   
-                   for (size_t j = 0; j < bs; j++)
+                   FlatArray<int> block = (*blocktable)[blocks[l]];
+                   for (size_t j = 0; j < block.Size(); j++)
+                     hx[j][l] = y(block[j]) - mat.RowTimesVectorNoDiag (block[j], x);
+                 }
+
+             Solve (bnr, &hx[0]);
+
+             // x += P_i w,  y -= (D L^t) P_i w
+             for (int l = 0; l < SW; l++)
+               if (blocks[l] >= 0)
+                 {
+                   FlatArray<int> block = (*blocktable)[blocks[l]];
+                   for (size_t j = 0; j < block.Size(); j++)
                      {
-                       auto jj = block[j];
-                       hx(j) = fb(jj) - mat.RowTimesVector (jj, fx);
+                       x(block[j]) += hx[j][l];
+                       mat.AddRowTransToVector (block[j], -hx[j][l], y);
                      }
-                   
-                   hy = (invdiag[i]) * hx;
-                   fx(block) += hy;
                  }
-             });
-        }
-   }
+           }
+       }, TasksPerThread(4));
+  }
+
+
+  void BandCholeskyBatches ::
+  MultAdd (double s, FlatVector<double> x, FlatVector<double> y) const
+  {
+    constexpr int SW = SIMD<double>::Size();
+    // the blocks of one color are disjoint
+    for (size_t c = 0; c+1 < firstbatch.Size(); c++)
+      ParallelForRange
+        (IntRange (firstbatch[c], firstbatch[c+1]), [&] (IntRange r)
+         {
+           Array<SIMD<double>> hx(maxbs);
+           for (auto bnr : r)
+             {
+               int n = batchsize[bnr];
+               FlatArray<int> blocks = Lanes(bnr);
+               hx.Range(0,n) = SIMD<double>(0.0);
+               for (int l = 0; l < SW; l++)
+                 if (blocks[l] >= 0)
+                   {
+                     FlatArray<int> block = (*blocktable)[blocks[l]];
+                     for (size_t j = 0; j < block.Size(); j++)
+                       hx[j][l] = x(block[j]);
+                   }
+
+               Solve (bnr, &hx[0]);
+
+               for (int l = 0; l < SW; l++)
+                 if (blocks[l] >= 0)
+                   {
+                     FlatArray<int> block = (*blocktable)[blocks[l]];
+                     for (size_t j = 0; j < block.Size(); j++)
+                       y(block[j]) += s * hx[j][l];
+                   }
+             }
+         }, TasksPerThread(4));
+  }
+
+
+  // batched band factors are available for double valued blocks only
+  template <class TM, class TV, class FUNC>
+  static shared_ptr<BandCholeskyBatches>
+  CreateBandCholeskyBatches (const SparseMatrixSymmetric<TM,TV> & mat,
+                             shared_ptr<Table<int>> blocktable, const Table<int> & coloring,
+                             FlatArray<int> blockbw, FUNC factor)
+  { return nullptr; }
 
+  template <class FUNC>
+  static shared_ptr<BandCholeskyBatches>
+  CreateBandCholeskyBatches (const SparseMatrixSymmetric<double,double> & mat,
+                             shared_ptr<Table<int>> blocktable, const Table<int> & coloring,
+                             FlatArray<int> blockbw, FUNC factor)
+  { return make_shared<BandCholeskyBatches> (blocktable, coloring, blockbw, factor); }
 
+  template <class TM, class TV, class TVX>
+  static void SmoothColorBatched (const BandCholeskyBatches & batches, int c,
+                                  const SparseMatrixSymmetric<TM,TV> & mat,
+                                  FlatVector<TVX> x, FlatVector<TVX> y)
+  { throw Exception ("batched symmetric block smoother for double only"); }
 
+  static void SmoothColorBatched (const BandCholeskyBatches & batches, int c,
+                                  const SparseMatrixSymmetric<double,double> & mat,
+                                  FlatVector<double> x, FlatVector<double> y)
+  { batches.SmoothColor (c, mat, x, y); }
 
+  template <class TSCAL, class TVX>
+  static void MultAddBatched (const BandCholeskyBatches & batches, TSCAL s,
+                              FlatVector<TVX> x, FlatVector<TVX> y)
+  { throw Exception ("batched symmetric block Jacobi for double only"); }
 
+  static void MultAddBatched (const BandCholeskyBatches & batches, double s,
+                              FlatVector<double> x, FlatVector<double> y)
+  { batches.MultAdd (s, x, y); }
 
 
 
@@ -781,35 +1140,47 @@ namespace ngla
     blockbw.SetSize(n);
 
 
-    // int alloc = n;
-    int memneed[NBLOCKS];
-    for (int i = 0; i < NBLOCKS; i++)
-      memneed[i] = 0;
-
-    {
-      LocalHeap lh (20000 + 5*sizeof(int)*maxbs, "blockjacobi-heap"); 
-      Array<int> block_inv(amat.Height());
-      block_inv = -1;
+    ParallelJob
+      ([&] (const TaskInfo & ti)
+       {
+         LocalHeap lh (20000 + 5*sizeof(int)*maxbs, "blockjacobi-heap"); 
+         Array<int> block_inv(amat.Height());
+         block_inv = -1;
 
-      for (int i = 0; i < blocktable->Size(); i++)
-	{
-	  int bs = (*blocktable)[i].Size();
-	  
-	  if (!bs) continue;
+         for (int i : Range(n).Split (ti.task_nr, ti.ntasks))
+           {
+             int bs = (*blocktable)[i].Size();
+             blocksize[i] = bs;
+             blockbw[i] = 0;
+             if (!bs) continue;
 	  
-	  blockbw[i] = Reorder ((*blocktable)[i], mat, block_inv, lh);
-	  blocksize[i] = bs;
+             blockbw[i] = Reorder ((*blocktable)[i], mat, block_inv, lh);
+             lh.CleanUp();
+           }
+       });
 
-	  blockstart[i] = memneed[i%NBLOCKS];
-	  memneed[i%NBLOCKS] += FlatBandCholeskyFactors<TM>::RequiredMem (bs, blockbw[i]);
-	  lh.CleanUp();
-	}
-    }
+    ComputeColoring (mat, true);
+
+    // the factors of one color are stored contiguously, in smoothing order
+    size_t memneed = 0;
+    for (auto c : Range (block_coloring))
+      for (auto i : block_coloring[c])
+        {
+          blockstart[i] = memneed;
+          if (blocksize[i])
+            memneed += FlatBandCholeskyFactors<TM>::RequiredMem (blocksize[i], blockbw[i]);
+        }
 
+    // double valued blocks are factored and applied in SIMD batches
     if (!lowmem)
+      batches = CreateBandCholeskyBatches
+        (mat, blocktable, block_coloring, blockbw,
+         [&] (int i, int bw, FlatBandCholeskyFactors<TM> & inv)
+         { ComputeBlockFactor ((*blocktable)[i], bw, inv); });
+
+    if (!lowmem && !batches)
       {
-	for (int i = 0; i < NBLOCKS; i++)
-	  data[i].SetSize(memneed[i]);
+	data.SetSize(memneed);
 
         clock_t prevtime = clock();
         atomic<int> cnt(0);
@@ -836,7 +1207,7 @@ namespace ngla
                         
                         try
                           {
-                            FlatBandCholeskyFactors<TM> inv (bs, bw, &data[i%NBLOCKS][blockstart[i]]);
+                            FlatBandCholeskyFactors<TM> inv (bs, bw, &data[blockstart[i]]);
                             ComputeBlockFactor ((*blocktable)[i], bw, inv);
                           }
                         catch (Exception & e)
@@ -856,83 +1227,6 @@ namespace ngla
 
 
 
-    *testout << "block coloring";
-    
-    int nblocks = blocktable->Size();
-    Array<int> coloring(nblocks);
-    Array<unsigned int> mask(mat.Width());
-    int current_color = 0;
-    coloring = -1;
-    int colored_blocks = 0;
-
-    
-    // symmetric,   rows(block[i]) cap row(block[j]) = 0
-    while(colored_blocks<nblocks) 
-      {
-	mask = 0;
-	for (int i = 0; i < nblocks; i++) 
-	  {
-	    if (coloring[i]>-1) continue;
-	    bool is_free = true;
-	    for (int d : (*blocktable)[i] )
-	      for(auto coupling : mat.GetRowIndices(d)) 
-		if(mask[coupling]) 
-		  {
-		    is_free = false;
-		    break;
-		  }
-	      
-	    if(is_free) 
-	      {
-		coloring[i] = current_color;
-		colored_blocks++;
-		for (int d : (*blocktable)[i]) 
-		  for(auto coupling : mat.GetRowIndices(d)) 
-		      mask[coupling] = 1;
-	      }
-	  }
-	current_color++;
-      }
-
-
-    
-    TableCreator<int> creator(current_color);
-    for ( ; !creator.Done(); creator++)
-      for (int i=0; i<nblocks; i++)
-          creator.Add(coloring[i],i);
-    block_coloring = creator.MoveTable();
-
-    cout << IM(3) <<  " using " << current_color << " colors" << endl;
-    
-    /*
-    *testout << "matrix.h = " << mat.Height() << endl;
-    *testout << "smoothing blocks = " << blocktable.Size() << endl;
-    
-    *testout << "coloring: " << endl << block_coloring << endl;
-    *testout << "blocktable: " << endl << blocktable << endl;
-    *testout << "matrix: " << endl << mat << endl;
-    */
-
-    // calc balancing:
-
-    color_balance.SetSize (block_coloring.Size());
-
-    for (auto c : Range (block_coloring))
-      {
-        color_balance[c].Calc (block_coloring[c].Size(),
-                               [&] (int bi)
-                               {
-                                 int blocknr = block_coloring[c][bi];
-                                 FlatArray<int> block = (*blocktable)[blocknr];
-                                 int costs = 0;
-                                 for (int i=0; i<block.Size(); i++)
-                                   costs += mat.GetRowIndices(block[i]).Size();
-                                 return costs;
-                               });
-      }
-
-  
-
     cout << IM(3) << "\rBlockJacobi Preconditioner built" << endl;
   }
 
@@ -988,25 +1282,36 @@ namespace ngla
     FlatVector<TVX> fx = x.FV<TVX> ();
     FlatVector<TVX> fy       = y.FV<TVX> ();
 
-    Vector<TVX> hxmax(maxbs);
-    Vector<TVX> hymax(maxbs);
-
-    for (int i = 0; i < blocktable->Size(); i++)
+    if (batches)
       {
-	int bs = (*blocktable)[i].Size();
-	if (!bs) continue;
+        MultAddBatched (*batches, s, fx, fy);
+        return;
+      }
 
-	FlatVector<TVX> hx = hxmax.Range (0, bs); 
-	FlatVector<TVX> hy = hymax.Range (0, bs); 
+    for (int c : Range(block_coloring))
+      ParallelForRange
+        (color_balance[c], [&] (IntRange r)
+         {
+           Vector<TVX> hxmax(maxbs);
+           Vector<TVX> hymax(maxbs);
 
-	for (int j = 0; j < bs; j++)
-	  hx(j) = fx((*blocktable)[i][j]);
+           for (int i : block_coloring[c].Range(r))
+             {
+               int bs = (*blocktable)[i].Size();
+               if (!bs) continue;
+
+               FlatVector<TVX> hx = hxmax.Range (0, bs); 
+               FlatVector<TVX> hy = hymax.Range (0, bs); 
+
+               for (int j = 0; j < bs; j++)
+                 hx(j) = fx((*blocktable)[i][j]);
 	
-	InvDiag(i).Mult (hx, hy);
+               InvDiag(i).Mult (hx, hy);
 
-	for (int j = 0; j < bs; j++)
-	  fy((*blocktable)[i][j]) += s * hy(j);
-      }
+               for (int j = 0; j < bs; j++)
+                 fy((*blocktable)[i][j]) += s * hy(j);
+             }
+         });
   }
 
 
@@ -1037,7 +1342,13 @@ namespace ngla
       mat.AddRowTransToVector (j, -fx(j), fy);
 
     
-    if (task_manager)
+    if (batches)
+
+      for (int k = 1; k <= steps; k++)
+        for (int c = 0; c < block_coloring.Size(); c++)
+          SmoothColorBatched (*batches, c, mat, fx, fy);
+
+    else if (task_manager)
       
       for (int k = 1; k <= steps; k++)
         for (int c = 0; c < block_coloring.Size(); c++)
@@ -1066,7 +1377,12 @@ namespace ngla
     FlatVector<TVX> fy = y.FV<TVX> ();
 
 
-    if (task_manager)
+    if (batches)
+
+      for (int c = 0; c < block_coloring.Size(); c++)
+        SmoothColorBatched (*batches, c, mat, fx, fy);
+
+    else if (task_manager)
       
       for (int c = 0; c < block_coloring.Size(); c++)
         ParallelFor (color_balance[c], [&] (int bi)
@@ -1137,7 +1453,12 @@ namespace ngla
     FlatVector<TVX> fy = y.FV<TVX> ();
 
 
-    if (task_manager)
+    if (batches)
+
+      for (int c = block_coloring.Size()-1; c >= 0; c--)
+        SmoothColorBatched (*batches, c, mat, fx, fy);
+
+    else if (task_manager)
       
       for (int c = block_coloring.Size()-1; c >= 0; c--)
         ParallelFor (color_balance[c], [&] (int bi)
@@ -67,6 +67,16 @@ namespace ngla
 		 FlatArray<int> usedflags,        // in and out: array of -1, size = graph.size
 		 LocalHeap & lh);
 
+  protected:
+    /**
+       Greedy coloring of the block-connectivity graph, sets
+       block_coloring and color_balance. Blocks of one color can be
+       smoothed in parallel. symmetric: the blocks also update a
+       partial residual, so their matrix rows must not share columns.
+    */
+    void ComputeColoring (const MatrixGraph & graph, bool symmetric);
+  public:
+
     /*
     virtual void SetCoarseType ( string act) 
     {
@@ -104,6 +114,49 @@ namespace ngla
 
 
 
+  /**
+     Inverses of double valued blocks. Blocks of similar size within
+     one color are grouped to batches of SIMD<double>::Size() blocks.
+     A batch is stored interleaved (lane l belongs to the l-th block,
+     smaller blocks are padded by zeros), and is applied by one
+     batched matrix-vector kernel.
+  */
+  class NGS_DLL_HEADER BlockInverseBatches
+  {
+    shared_ptr<Table<int>> blocktable;
+    int maxbs;
+    /// the blocks of every batch, -1 for unused lanes
+    Array<int> lanes;
+    /// size and first entry in data for every batch
+    Array<int> batchsize;
+    Array<size_t> batchstart;
+    /// the batches of color c are firstbatch[c] <= b < firstbatch[c+1]
+    Array<size_t> firstbatch;
+    Array<SIMD<double>> data;
+  public:
+    BlockInverseBatches (const SparseMatrix<double> & mat,
+                         shared_ptr<Table<int>> ablocktable,
+                         const Table<int> & block_coloring);
+
+    FlatArray<int> Lanes (size_t b) const
+    { return lanes.Range (b*SIMD<double>::Size(), (b+1)*SIMD<double>::Size()); }
+
+    FlatMatrix<SIMD<double>> Inverse (size_t b) const
+    {
+      return FlatMatrix<SIMD<double>> (batchsize[b], batchsize[b],
+                                       const_cast<SIMD<double>*> (&data[batchstart[b]]));
+    }
+
+    /// x += inv * (b - mat * x) for all blocks of color c
+    void SmoothColor (int c, const SparseMatrix<double> & mat,
+                      FlatVector<double> x, FlatVector<double> b) const;
+
+    /// y += s * inv * x, or with the transposed inverses
+    void MultAdd (double s, FlatVector<double> x, FlatVector<double> y, bool transpose) const;
+  };
+
+
+
   /**
      A block-Jacobi preconditioner.
      The blocks are specified by a table container
@@ -117,8 +170,10 @@ namespace ngla
     const SparseMatrix<TM,TV_ROW,TV_COL> & mat;
     /// inverses of the small blocks
     Array<FlatMatrix<TM>> invdiag;
-    /// the data for the inverses
+    /// the data for the inverses, stored contiguously in smoothing order
     Array<TM> bigmem;
+    /// SIMD batches of the inverses, used instead of invdiag for double
+    shared_ptr<BlockInverseBatches> batches;
 
   public:
     // typedef typename mat_traits<TM>::TV_ROW TVX;
@@ -156,6 +211,9 @@ namespace ngla
 
     virtual void GSSmoothBack (BaseVector & x, const BaseVector & b,
 			       int steps = 1) const;
+
+    /// one Gauss-Seidel step for all blocks of color c, in parallel
+    void SmoothColor (int c, FlatVector<TVX> fx, FlatVector<TVX> fb) const;
   
     virtual void GSSmoothResiduum (BaseVector & x, const BaseVector & b,
 				   BaseVector & res, int steps = 1) const 
@@ -193,6 +251,48 @@ namespace ngla
   /* **************** SYMMETRIC ****************** */
 
 
+  /**
+     Band Cholesky factors of double valued symmetric blocks, grouped to
+     batches of SIMD<double>::Size() blocks of one color as in
+     BlockInverseBatches. A batch is stored interleaved in the layout of
+     FlatBandCholeskyFactors, with the largest size and bandwidth of its
+     blocks. Entries outside a block's own band are zero.
+  */
+  class NGS_DLL_HEADER BandCholeskyBatches
+  {
+    shared_ptr<Table<int>> blocktable;
+    int maxbs;
+    /// the blocks of every batch, -1 for unused lanes
+    Array<int> lanes;
+    /// size, bandwidth and first entry in data for every batch
+    Array<int> batchsize, batchbw;
+    Array<size_t> batchstart;
+    /// the batches of color c are firstbatch[c] <= b < firstbatch[c+1]
+    Array<size_t> firstbatch;
+    Array<SIMD<double>> data;
+  public:
+    /// factor (i, bw, inv) computes the factors of block i
+    typedef function<void(int,int,FlatBandCholeskyFactors<double>&)> TFactor;
+
+    BandCholeskyBatches (shared_ptr<Table<int>> ablocktable,
+                         const Table<int> & block_coloring,
+                         FlatArray<int> blockbw, TFactor factor);
+
+    FlatArray<int> Lanes (size_t b) const
+    { return lanes.Range (b*SIMD<double>::Size(), (b+1)*SIMD<double>::Size()); }
+
+    /// x = A^{-1} x for all blocks of batch b
+    void Solve (size_t b, SIMD<double> * x) const;
+
+    /// symmetric block Gauss-Seidel step for color c, y is the partial residual
+    void SmoothColor (int c, const SparseMatrixSymmetric<double> & mat,
+                      FlatVector<double> x, FlatVector<double> y) const;
+
+    /// y += s * A^{-1} x
+    void MultAdd (double s, FlatVector<double> x, FlatVector<double> y) const;
+  };
+
+
   ///
   template <class TM, class TV>
   class BlockJacobiPrecondSymmetric : 
@@ -202,14 +302,12 @@ namespace ngla
   protected:
     const SparseMatrixSymmetric<TM,TV> & mat;
 
-    // 
-    enum { NBLOCKS = 20 };
-    // DynamicMem<int> blockstart, blocksize, blockbw;
-    // DynamicMem<TM> data[NBLOCKS];
-
-    Array<int> blockstart, blocksize, blockbw;
-    Array<TM> data[NBLOCKS];
-
+    Array<int> blocksize, blockbw;
+    /// band Cholesky factors, stored contiguously in smoothing order
+    Array<size_t> blockstart;
+    Array<TM> data;
+    /// SIMD batches of the factors, used instead of data for double
+    shared_ptr<BandCholeskyBatches> batches;
 
     bool lowmem;
   public:
@@ -233,7 +331,7 @@ namespace ngla
     {
       return FlatBandCholeskyFactors<TM> (blocksize[i], 
 					  blockbw[i], 
-					  const_cast<TM*>(&data[i%NBLOCKS][blockstart[i]]));
+					  const_cast<TM*>(&data[blockstart[i]]));
     }
 
     void ComputeBlockFactor (FlatArray<int> block, int bw, FlatBandCholeskyFactors<TM> & inv) const;
@@ -602,6 +602,9 @@ namespace ngla
 	
 	double lwstart = log(Abs(wdn));
 	double lerr = log(err);
+
+        SCAL one = 1.0;
+        const BaseVector * pw = &*w;
 	
 	while (n++ < maxsteps && Abs(wdn) > err && !(sh && sh->ShouldTerminate()))
 	  {
@@ -612,18 +615,23 @@ namespace ngla
 	    
 	    al = wd / kss;
 	    u += al * s;
-	    d -= al * w;
 
 	    if (c)
-	      w = (*c) * d;
+              {
+                d -= al * w;
+                w = (*c) * d;
+                wdn = S_InnerProduct<IPTYPE> (d, w);
+              }
 	    else
-	      w = d;
-	    wdn = S_InnerProduct<IPTYPE> (d, w);
+              {
+                wdn = S_AddInnerProduct<IPTYPE> (d, -al, w, d);
+                w = d;
+              }
 
 	    be = wdn / wd;
-	    
-	    s *= be;
-	    s += w;
+
+            // s = be * s + w
+            S_AddLinearCombination<SCAL> (s, be, FlatVector<SCAL> (1, &one), FlatArray<const BaseVector*> (1, &pw));
 
 	    if (printrates ) cout << IM(1) << n << " " << sqrt (Abs (wdn)) << endl;
 	    if ( sh )
@@ -648,6 +656,409 @@ namespace ngla
 
 
 
+  template <class IPTYPE>
+  inline typename SCAL_TRAIT<IPTYPE>::SCAL
+  LocalInnerProduct (const BaseVector & v1, const BaseVector & v2);
+
+  template <> inline double
+  LocalInnerProduct<double> (const BaseVector & v1, const BaseVector & v2)
+  {
+    return InnerProduct (v1.FVDouble(), v2.FVDouble());
+  }
+
+  template <> inline Complex
+  LocalInnerProduct<Complex> (const BaseVector & v1, const BaseVector & v2)
+  {
+    return InnerProduct (v1.FVComplex(), v2.FVComplex());
+  }
+
+  template <> inline Complex
+  LocalInnerProduct<ComplexConjugate> (const BaseVector & v1, const BaseVector & v2)
+  {
+    return InnerProduct (v1.FVComplex(), Conj(v2.FVComplex()));
+  }
+
+  template <> inline Complex
+  LocalInnerProduct<ComplexConjugate2> (const BaseVector & v1, const BaseVector & v2)
+  {
+    return InnerProduct (v2.FVComplex(), Conj(v1.FVComplex()));
+  }
+
+
+  /*
+    Several inner products, whose local contributions are summed up
+    over all processes by one non-blocking reduction.
+    Not parallel vectors are multiplied directly.
+  */
+  template <class IPTYPE>
+  class FusedInnerProducts
+  {
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    Vector<SCAL> values;
+    bool parallel = false;
+#ifdef PARALLEL
+    MPI_Request request;
+    bool started = false;
+#endif
+  public:
+    FusedInnerProducts (int n) : values(n) { ; }
+
+    void SetSize (int n) { values.SetSize(n); }
+
+    SCAL operator[] (int i) const { return values(i); }
+
+    void Set (int i, const BaseVector & v1, const BaseVector & v2)
+    {
+      PARALLEL_STATUS st1 = v1.GetParallelStatus();
+      PARALLEL_STATUS st2 = v2.GetParallelStatus();
+
+      if (st1 == NOT_PARALLEL && st2 == NOT_PARALLEL)
+        {
+          values(i) = S_InnerProduct<IPTYPE> (v1, v2);
+          return;
+        }
+
+      // one vector cumulated, the other one distributed
+      if (st1 == DISTRIBUTED && st2 == DISTRIBUTED)
+        v1.Cumulate();
+      else if (st1 == CUMULATED && st2 == CUMULATED)
+        v1.Distribute();
+
+      values(i) = LocalInnerProduct<IPTYPE> (v1, v2);
+      parallel = true;
+    }
+
+    void Start ()
+    {
+#ifdef PARALLEL
+      if (!parallel || MyMPI_GetNTasks() == 1) return;
+      MPI_Iallreduce (MPI_IN_PLACE, &values(0), values.Size()*sizeof(SCAL)/sizeof(double),
+                      MPI_DOUBLE, MPI_SUM, ngs_comm, &request);
+      started = true;
+#endif
+    }
+
+    void Wait ()
+    {
+#ifdef PARALLEL
+      static Timer t("dummy - Wait fused inner products");
+      RegionTimer r(t);
+      if (started)
+        MPI_Wait (&request, MPI_STATUS_IGNORE);
+      started = false;
+      parallel = false;
+#endif
+    }
+  };
+
+
+
+  template <class IPTYPE>
+  void PipelinedCGSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer timer ("pipelined CG solver");
+    RegionTimer reg (timer);
+
+    try
+      {
+	// Solve A x = f
+	if(sh)
+	  sh->SetThreadPercentage(0);
+
+        auto r = f.CreateVector();   // residual
+        auto u = f.CreateVector();   // C r
+        auto w = f.CreateVector();   // A u
+        auto m = f.CreateVector();   // C w
+        auto nv = f.CreateVector();  // A m
+        auto p = f.CreateVector();   // search direction
+        auto s = f.CreateVector();   // A p
+        auto q = f.CreateVector();   // C s
+        auto z = f.CreateVector();   // A q
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+	  {
+	    r = f - (*a) * x;
+	  }
+
+	if (c)
+	  u = (*c) * r;
+	else
+	  u = r;
+        w = (*a) * u;
+
+        FusedInnerProducts<IPTYPE> ip(2);
+        SCAL gamma, gamma_old = 0, delta, al = 0, al_old = 0, be;
+	double err = 0, lwstart = 0, lerr = 0;
+        int n = 0;
+
+        while (true)
+          {
+            ip.Set (0, r, u);
+            ip.Set (1, w, u);
+            ip.Start();
+
+            if (c)
+              m = (*c) * w;
+            else
+              m = w;
+            nv = (*a) * m;
+
+            ip.Wait();
+            gamma = ip[0];
+            delta = ip[1];
+
+            if (n == 0)
+              {
+                err = stop_absolute ? prec * prec : prec * prec * Abs (gamma);
+                lwstart = log(Abs(gamma));
+                lerr = log(err);
+              }
+            else if (sh)
+	      sh->SetThreadPercentage(100.*max2(double(n)/double(maxsteps),
+						(lwstart-log(Abs(gamma)))/(lwstart-lerr)));
+
+            if (printrates) cout << IM(1) << n << " " << sqrt(Abs(gamma)) << endl;
+
+            if (n >= maxsteps || Abs(gamma) <= err || (sh && sh->ShouldTerminate()))
+              break;
+
+            if (n == 0)
+              {
+                if (delta == 0.0) break;
+                al = gamma / delta;
+                p = u; s = w; q = m; z = nv;
+              }
+            else
+              {
+                be = gamma / gamma_old;
+                SCAL kss = delta - be * gamma / al_old;
+                if (kss == 0.0) break;
+                al = gamma / kss;
+
+                p *= be; p += u;
+                s *= be; s += w;
+                q *= be; q += m;
+                z *= be; z += nv;
+              }
+
+            x += al * p;
+            r -= al * s;
+            u -= al * q;
+            w -= al * z;
+
+            gamma_old = gamma;
+            al_old = al;
+            n++;
+          }
+
+	const_cast<int&> (steps) = n;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in PipelinedCGSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in PipelinedCGSolver::Mult\n"));
+      }
+  }
+
+
+
+  template <class IPTYPE>
+  void SStepCGSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer timer ("s-step CG solver");
+    static Timer timerbasis ("s-step CG solver - basis");
+    static Timer timerupdate ("s-step CG solver - update");
+    RegionTimer reg (timer);
+
+    try
+      {
+	// Solve A x = f
+	if(sh)
+	  sh->SetThreadPercentage(0);
+
+        auto r = f.CreateVector();   // residual
+        auto z = f.CreateVector();   // C r, updated recursively
+        auto hv = f.CreateVector();  // C A v_{s-1}
+
+        // the basis v_j is overwritten by the search directions p_j,
+        // and av_j by a p_j
+        Array<AutoVector> v(s), av(s), cap(s), pold(s), apold(s), capold(s);
+        for (int j = 0; j < s; j++)
+          {
+            v[j].AssignPointer (f.CreateVector());
+            av[j].AssignPointer (f.CreateVector());
+            cap[j].AssignPointer (f.CreateVector());
+            pold[j].AssignPointer (f.CreateVector());
+            apold[j].AssignPointer (f.CreateVector());
+            capold[j].AssignPointer (f.CreateVector());
+          }
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+	  {
+	    r = f - (*a) * x;
+	  }
+
+	if (c)
+	  z = (*c) * r;
+	else
+	  z = r;
+
+        Matrix<SCAL> g(s, s), d(s, s), cm(s, s), b(s, s), wmat(s, s), invw(s, s), invwold(s, s);
+        Vector<SCAL> rv(s), al(s);
+        FusedInnerProducts<IPTYPE> ip(s);
+
+	double err = 0, lwstart = 0, lerr = 0;
+        int n = 0;
+        bool first = true;
+
+        while (true)
+          {
+            {
+              RegionTimer rb(timerbasis);
+              *v[0] = z;
+              for (int j = 0; j < s; j++)
+                {
+                  *av[j] = (*a) * *v[j];
+                  if (j+1 < s)
+                    {
+                      if (c)
+                        *v[j+1] = (*c) * *av[j];
+                      else
+                        *v[j+1] = *av[j];
+                    }
+                }
+            }
+
+            // rv_i = (r, v_i), g_ij = (A v_j, v_i), and for the
+            // conjugation against the previous block
+            // cm_ij = (v_j, A p_i^old), d_ij = (A p_j^old, v_i)
+            int nip = first ? s + s*s : s + 3*s*s;
+            ip.SetSize (nip);
+            for (int i = 0, k = 0; i < s; i++)
+              {
+                ip.Set (k++, r, *v[i]);
+                for (int j = 0; j < s; j++)
+                  ip.Set (k++, *av[j], *v[i]);
+                if (!first)
+                  for (int j = 0; j < s; j++)
+                    {
+                      ip.Set (k++, *v[j], *apold[i]);
+                      ip.Set (k++, *apold[j], *v[i]);
+                    }
+              }
+            ip.Start();
+
+            if (c)
+              hv = (*c) * *av[s-1];
+            else
+              hv = *av[s-1];
+
+            ip.Wait();
+            for (int i = 0, k = 0; i < s; i++)
+              {
+                rv(i) = ip[k++];
+                for (int j = 0; j < s; j++)
+                  g(i,j) = ip[k++];
+                if (!first)
+                  for (int j = 0; j < s; j++)
+                    {
+                      cm(i,j) = ip[k++];
+                      d(i,j) = ip[k++];
+                    }
+              }
+
+            SCAL wdn = rv(0);
+            if (n == 0)
+              {
+                err = stop_absolute ? prec * prec : prec * prec * Abs (wdn);
+                lwstart = log(Abs(wdn));
+                lerr = log(err);
+              }
+            else if (sh)
+	      sh->SetThreadPercentage(100.*max2(double(n)/double(maxsteps),
+						(lwstart-log(Abs(wdn)))/(lwstart-lerr)));
+
+            if (printrates) cout << IM(1) << n << " " << sqrt(Abs(wdn)) << endl;
+
+            if (n >= maxsteps || Abs(wdn) <= err || (sh && sh->ShouldTerminate()))
+              break;
+
+            // A-conjugate the new block against the previous one:
+            // p = v - p^old b,  b = (p^old,A p^old)^{-1} (v, A p^old)
+            wmat = g;
+            if (!first)
+              {
+                b = invwold * cm;
+                wmat -= d * b;
+              }
+            invw = wmat;
+            CalcInverse (invw);
+            al = invw * rv;
+
+            RegionTimer ru(timerupdate);
+            for (int j = 0; j < s; j++)
+              {
+                *cap[j] = (j+1 < s) ? *v[j+1] : *hv;
+                if (!first)
+                  for (int l = 0; l < s; l++)
+                    *cap[j] -= b(l,j) * *capold[l];
+              }
+            if (!first)
+              for (int j = 0; j < s; j++)
+                for (int l = 0; l < s; l++)
+                  {
+                    *v[j] -= b(l,j) * *pold[l];
+                    *av[j] -= b(l,j) * *apold[l];
+                  }
+
+            for (int j = 0; j < s; j++)
+              {
+                x += al(j) * *v[j];
+                r -= al(j) * *av[j];
+                z -= al(j) * *cap[j];
+              }
+
+            v.Swap (pold);
+            av.Swap (apold);
+            cap.Swap (capold);
+            invwold = invw;
+            first = false;
+            n += s;
+          }
+
+	const_cast<int&> (steps) = n;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in SStepCGSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in SStepCGSolver::Mult\n"));
+      }
+  }
+
+
+
 
 
   template <class IPTYPE>
@@ -878,6 +1289,8 @@ namespace ngla
 	auto hv = f.CreateVector();
 
         Array<AutoVector> vi(maxsteps);
+        Array<const BaseVector*> pvi, lcvecs;
+        Vector<SCAL> hcol(maxsteps), coefs(maxsteps+1);
         Matrix<SCAL> h(maxsteps+1, maxsteps);
         Matrix<SCAL> h2(maxsteps+1, maxsteps);
         Vector<SCAL> gammai(maxsteps), ci(maxsteps), si(maxsteps);
@@ -929,12 +1342,18 @@ namespace ngla
                 av = hv;
               }
 
-            for (int i = 0; i <= j; i++)
-              h2(i,j) = h(i,j) = S_InnerProduct<IPTYPE> (*vi[i], av);
+            pvi.Append (&*vi[j]);
+            S_MultiInnerProduct<IPTYPE> (av, pvi, hcol.Range(0,j+1));
+            h.Col(j).Range(0,j+1) = hcol.Range(0,j+1);
+            h2.Col(j).Range(0,j+1) = hcol.Range(0,j+1);
 
-            w = av;
-            for (int i = 0; i <= j; i++)
-              w -= h(i,j) * (*vi[i]);
+            // w = av - sum_i h(i,j) vi in one pass
+            coefs(0) = 1.0;
+            coefs.Range(1,j+2) = -hcol.Range(0,j+1);
+            lcvecs.SetSize (j+2);
+            lcvecs[0] = &*av;
+            lcvecs.Range(1,j+2) = pvi;
+            S_AddLinearCombination<SCAL> (w, 0.0, coefs.Range(0,j+2), lcvecs);
 
             v = (1.0 / sqrt (S_InnerProduct<IPTYPE> (w, w))) * w;
             h2(j+1,j) = h(j+1,j) = S_InnerProduct<IPTYPE> (v, av);
@@ -972,8 +1391,8 @@ namespace ngla
             y(i) = sum / h(i,i);
           }
 
-        for (int i = 0; i <= j; i++)
-          x += y(i) * *vi[i];
+        if (j >= 0)
+          S_AddLinearCombination<SCAL> (x, 1.0, y.Range(0,j+1), pvi.Range(0,j+1));
 
 	const_cast<int&> (steps) = j;
 	
@@ -1319,6 +1738,14 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
   template class CGSolver<Complex>;
   template class CGSolver<ComplexConjugate>;
   template class CGSolver<ComplexConjugate2>;
+  template class PipelinedCGSolver<double>;
+  template class PipelinedCGSolver<Complex>;
+  template class PipelinedCGSolver<ComplexConjugate>;
+  template class PipelinedCGSolver<ComplexConjugate2>;
+  template class SStepCGSolver<double>;
+  template class SStepCGSolver<Complex>;
+  template class SStepCGSolver<ComplexConjugate>;
+  template class SStepCGSolver<ComplexConjugate2>;
   template class BiCGStabSolver<double>;
   template class BiCGStabSolver<Complex>;
   template class BiCGStabSolver<ComplexConjugate>;
@@ -125,6 +125,67 @@ namespace ngla
   };
 
 
+  /**
+     Pipelined conjugate gradient solver (Ghysels, Vanroose).
+     Both inner products of an iteration are summed up by one
+     non-blocking reduction, which overlaps with the preconditioner
+     and the matrix application.
+  */
+  template <class IPTYPE>
+  class NGS_DLL_HEADER PipelinedCGSolver : public KrylovSpaceSolver
+  {
+  public:
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ///
+    PipelinedCGSolver ()
+      : KrylovSpaceSolver () { ; }
+    ///
+    PipelinedCGSolver (const BaseMatrix & aa)
+      : KrylovSpaceSolver (aa) { ; }
+
+    ///
+    PipelinedCGSolver (const BaseMatrix & aa, const BaseMatrix & ac)
+      : KrylovSpaceSolver (aa, ac) { ; }
+
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
+  /**
+     s-step conjugate gradient solver (Chronopoulos, Gear).
+     Every outer step builds the monomial Krylov basis
+     z, CAz, ..., (CA)^{s-1} z, and needs only one non-blocking
+     reduction for s steps of CG. Larger s than 4 or 5 may suffer
+     from the ill-conditioned basis.
+  */
+  template <class IPTYPE>
+  class NGS_DLL_HEADER SStepCGSolver : public KrylovSpaceSolver
+  {
+    int s = 4;
+  public:
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ///
+    SStepCGSolver ()
+      : KrylovSpaceSolver () { ; }
+    ///
+    SStepCGSolver (const BaseMatrix & aa)
+      : KrylovSpaceSolver (aa) { ; }
+
+    ///
+    SStepCGSolver (const BaseMatrix & aa, const BaseMatrix & ac)
+      : KrylovSpaceSolver (aa, ac) { ; }
+
+    /// number of CG steps per reduction
+    void SetSStep (int as) { s = max2(as, 1); }
+    ///
+    int GetSStep () const { return s; }
+
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
   /// The BiCGStab solver
   template <class IPTYPE>
   class NGS_DLL_HEADER BiCGStabSolver : public KrylovSpaceSolver
@@ -79,10 +79,88 @@ namespace ngla
       }
   }
 
+  void ChebyshevIteration :: 
+  Smooth (BaseVector & x, const BaseVector & b, int steps) const
+  {
+    static Timer t("ChebyshevIteration::Smooth");
+    RegionTimer reg(t);
+
+    if (steps < 1) return;
+
+    auto r = b.CreateVector();
+    auto w = b.CreateVector();
+    auto xold = b.CreateVector();
+
+    // the eigenvalues of c*a are in [1-lmax, 1-lmin]
+    double gamma = 2 / (2-lmin-lmax);
+    double rho = (lmax-lmin) / (2-lmin-lmax);
+
+    r = b - (*a) * x;
+    c->Mult (r, w);
+    xold = x;
+    x += gamma * w;
+
+    // three-term recurrence, the new iterate overwrites the oldest one
+    BaseVector * px = &x;
+    BaseVector * pold = &xold;
+    double sigma = 2;
+    for (int m = 1; m < steps; m++)
+      {
+        sigma = 4 / (4 - sqr(rho) * sigma);
+
+        r = b - (*a) * *px;
+        c->Mult (r, w);
+
+        double coefs[2] = { sigma, sigma*gamma };
+        const BaseVector * vecs[2] = { px, &w };
+        pold->AddLinearCombination (1-sigma, FlatVector<double> (2, coefs),
+                                    FlatArray<const BaseVector*> (2, vecs));
+        swap (px, pold);
+      }
+    if (px != &x)
+      x = *px;
+  }
+
   AutoVector ChebyshevIteration :: CreateVector () const
   {
     return a->CreateVector();
   }
 
 
+  double EstimateMaxEigenvalue (const BaseMatrix & a, const BaseMatrix & c, int steps)
+  {
+    static Timer t("EstimateMaxEigenvalue");
+    RegionTimer reg(t);
+
+    auto v = a.CreateVector();
+    auto w = a.CreateVector();
+    auto cw = a.CreateVector();
+
+    v.SetRandom();
+    
+    // Rayleigh quotient of c*a in the a-inner product, 
+    // both inner products are computed in one sweep
+    double lam = 0;
+    Vector<double> ip(2);
+    const BaseVector * vecs[2] = { &v, &cw };
+    for (int i = 0; i < steps; i++)
+      {
+        a.Mult (v, w);
+        c.Mult (w, cw);
+        if (w.IsComplex())
+          {
+            ip(0) = S_InnerProduct<ComplexConjugate> (v, w).real();
+            ip(1) = S_InnerProduct<ComplexConjugate> (cw, w).real();
+          }
+        else
+          w.MultiInnerProductD (FlatArray<const BaseVector*> (2, vecs), ip);
+
+        if (ip(0) <= 0 || ip(1) <= 0) break;
+        lam = ip(1) / ip(0);
+        v = (1/sqrt(ip(1))) * cw;
+      }
+    return lam;
+  }
+
+
 }
@@ -31,10 +31,16 @@ namespace ngla
     void SetBounds (double almin, double almax);
     ///
     virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+    /// applies a Chebyshev polynomial of degree steps, starting from the initial guess x
+    void Smooth (BaseVector & x, const BaseVector & b, int steps) const;
     ///
     virtual AutoVector CreateVector () const;
   };
 
+  /// estimates the largest eigenvalue of c*a by power iteration (a, c spd)
+  NGS_DLL_HEADER double EstimateMaxEigenvalue (const BaseMatrix & a, const BaseMatrix & c,
+                                               int steps);
+
 }
 
 #endif
@@ -101,15 +101,23 @@ namespace ngla
   template <class SCAL>
   ElementByElementMatrix<SCAL> :: ~ElementByElementMatrix ()
   {
-    for (int i = 0; i < ne; i++)
-      if (!clone.Test(i))
-	{
-	  delete [] &(elmats[i](0,0));
-	  if (rowdnums[i].Size() > 0)
-	    delete [] &(rowdnums[i])[0];
-	  if (coldnums[i].Size() > 0)
-	    delete [] &(coldnums[i])[0];
-	}
+    for (char * chunk : arena)
+      delete [] chunk;
+  }
+
+  template <class SCAL>
+  char * ElementByElementMatrix<SCAL> :: AllocateArena (size_t bytes)
+  {
+    lock_guard<mutex> guard(arena_mutex);
+    if (arena_used + bytes > arena_size)
+      {
+        arena_size = max2 (bytes, size_t(1) << 20);
+        arena.Append (new char[arena_size]);
+        arena_used = 0;
+      }
+    char * ptr = arena.Last() + arena_used;
+    arena_used += bytes;
+    return ptr;
   }
   
   template <class SCAL>
@@ -472,18 +480,21 @@ namespace ngla
       if (coldnums_in[i] >= 0) usedcols.Append(i);
     int sc = usedcols.Size();
 
-    FlatMatrix<SCAL> mat (sr,sc, new SCAL[sr*sc]);
+    size_t matbytes = ArenaBytes<SCAL> (sr*sc), rowbytes = ArenaBytes<int> (sr);
+    char * mem = AllocateArena (matbytes + rowbytes + ArenaBytes<int> (sc));
+
+    FlatMatrix<SCAL> mat (sr,sc, reinterpret_cast<SCAL*> (mem));
     // mat = elmat.Rows(usedrows).Cols(usedcols);
 
     for (int i = 0; i < sr; i++)
       for (int j = 0; j < sc; j++)
         mat(i,j) = elmat(usedrows[i], usedcols[j]);
 
-    FlatArray<int> dnr(sr, new int[sr]);
+    FlatArray<int> dnr(sr, reinterpret_cast<int*> (mem + matbytes));
     for (int i = 0; i < sr; i++)
       dnr[i] = rowdnums_in[usedrows[i]];
     
-    FlatArray<int> dnc(sc, new int[sc]);
+    FlatArray<int> dnc(sc, reinterpret_cast<int*> (mem + matbytes + rowbytes));
     for (int j = 0; j < sc; j++)
       dnc[j] = coldnums_in[usedcols[j]];
 
@@ -523,11 +534,14 @@ namespace ngla
 //       for (int j = 0; j < sc; j++)
 //         mat(i,j) = elmat(usedrows[i], usedcols[j]);
 
-    FlatArray<int> dnr(sr, new int[sr]);
+    size_t rowbytes = ArenaBytes<int> (sr);
+    char * mem = AllocateArena (rowbytes + ArenaBytes<int> (sc));
+
+    FlatArray<int> dnr(sr, reinterpret_cast<int*> (mem));
     for (int i = 0; i < sr; i++)
       dnr[i] = rowdnums_in[usedrows[i]];
     
-    FlatArray<int> dnc(sc, new int[sc]);
+    FlatArray<int> dnc(sc, reinterpret_cast<int*> (mem + rowbytes));
     for (int j = 0; j < sc; j++)
       dnc[j] = coldnums_in[usedcols[j]];
 
@@ -30,6 +30,15 @@ namespace ngla
     BitArray clone;
     int max_row_size = 0;
     int max_col_size = 0;
+    /// element matrices and dof numbers are stored in large chunks
+    Array<char*> arena;
+    size_t arena_used = 0, arena_size = 0;
+    mutex arena_mutex;
+
+    /// one allocation per element, holding the matrix and the dof numbers
+    char * AllocateArena (size_t bytes);
+    template <typename T>
+    static size_t ArenaBytes (size_t n) { return (n*sizeof(T) + 15) & size_t(-16); }
   public:
     ElementByElementMatrix (int h, int ane, bool isymmetric=false);
     ElementByElementMatrix (int h, int w, int ane, bool isymmetric=false);
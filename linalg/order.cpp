@@ -7,6 +7,7 @@
 
 
 #include <la.hpp>
+#include <algorithm>
 namespace ngla
 {
   using namespace ngla;
@@ -520,8 +521,8 @@ namespace ngla
     }
     
     // t4.Start();
-    // calc master degrees in new clique
-    if (anymaster)
+    // calc master degrees in new clique, not needed for prescribed order
+    if (anymaster && !prescribed_order.Size())
       {
         CliqueEl * p3 = anymaster;
         do
@@ -577,6 +578,8 @@ namespace ngla
     if (n > 5000)
       cout << IM(4) << "order " << flush;
 
+    size_t nextprescribed = 0;
+
     int locked_dofs = 0;
     for (int i = 0; i < n; i++)
       if (vertices[i].Eliminated())                
@@ -608,6 +611,18 @@ namespace ngla
 	    EliminateSlaveVertex (minj);
 	  }
 
+	else if (prescribed_order.Size())
+	  {
+	    // next vertex of prescribed order, eliminated with its master
+	    while (vertices[prescribed_order[nextprescribed]].Eliminated())
+	      nextprescribed++;
+	    minj = vertices[prescribed_order[nextprescribed]].Master();
+	    priqueue.Invalidate(minj);
+
+	    blocknr[i] = i;
+	    EliminateMasterVertex (minj);
+	  }
+
 	else
 	  {
 	    // find new master vertex
@@ -777,4 +792,206 @@ namespace ngla
     list[nr].degree = 0;
   }
 
+
+
+
+  /*
+    Nested dissection:
+    Bisect the graph, order the two parts recursively and the separator last.
+    Bisection is by the coordinate median along the largest extent,
+    or by the middle level of a level structure from a pseudo-peripheral vertex.
+  */
+
+  NestedDissectionOrdering ::
+  NestedDissectionOrdering (const Table<int> & agraph, FlatArray<Vec<3>> acoords,
+                            int aminsize)
+    : graph(agraph), coords(acoords), minsize(max(aminsize, 1)),
+      mark(agraph.Size()), level(agraph.Size())
+  {
+    mark = -1;
+    level = -1;
+    if (coords.Size() != graph.Size())
+      coords.Assign (FlatArray<Vec<3>>(0, nullptr));
+  }
+
+  void NestedDissectionOrdering :: Order (FlatArray<int> vertices)
+  {
+    static Timer t("NestedDissectionOrdering::Order");
+    RegionTimer reg(t);
+
+    order.SetSize (vertices.Size());
+    Array<int> verts;
+    verts = vertices;
+    Dissect (verts, 0);
+  }
+
+  void NestedDissectionOrdering :: Dissect (FlatArray<int> verts, size_t first)
+  {
+    Array<int> part0, part1, sep;
+    if (verts.Size() > minsize)
+      {
+        if (coords.Size())
+          BisectGeometric (verts, part0, part1, sep);
+        else
+          BisectLevels (verts, part0, part1, sep);
+      }
+    
+    if (part0.Size() == 0 || part1.Size() == 0)
+      {
+        order.Range(first, first+verts.Size()) = verts;
+        return;
+      }
+
+    Dissect (part0, first);
+    Dissect (part1, first+part0.Size());
+    order.Range(first+part0.Size()+part1.Size(), first+verts.Size()) = sep;
+  }
+
+  int NestedDissectionOrdering :: BFS (int start, Array<int> & visited)
+  {
+    int id = mark[start];
+    visited.SetSize0();
+    visited.Append (start);
+    level[start] = 0;
+    for (size_t j = 0; j < visited.Size(); j++)
+      {
+        int v = visited[j];
+        for (int w : graph[v])
+          if (mark[w] == id && level[w] == -1)
+            {
+              level[w] = level[v]+1;
+              visited.Append (w);
+            }
+      }
+    return level[visited.Last()]+1;
+  }
+
+  void NestedDissectionOrdering ::
+  BisectLevels (FlatArray<int> verts, Array<int> & part0,
+                Array<int> & part1, Array<int> & sep)
+  {
+    int id = markcnt++;
+    for (int v : verts)
+      {
+        mark[v] = id;
+        level[v] = -1;
+      }
+
+    Array<int> visited;
+    int nlevels = BFS (verts[0], visited);
+
+    if (visited.Size() < verts.Size())
+      {
+        // not connected: collect components up to half of the vertices
+        part0 = visited;
+        for (int v : verts)
+          if (level[v] == -1 && 2*part0.Size() < verts.Size())
+            {
+              BFS (v, visited);
+              part0.Append (visited);
+            }
+        for (int v : verts)
+          if (level[v] == -1)
+            part1.Append (v);
+        return;
+      }
+
+    // find pseudo-peripheral vertex
+    for (int k = 0; k < 5; k++)
+      {
+        int cand = visited.Last();
+        for (int v : verts) level[v] = -1;
+        int nl = BFS (cand, visited);
+        if (nl <= nlevels) break;
+        nlevels = nl;
+      }
+    if (nlevels < 3) return;
+
+    Array<int> cnt(nlevels);
+    cnt = 0;
+    for (int v : verts)
+      cnt[level[v]]++;
+
+    int sum = 0, mid = 1;
+    for (int l = 0; l < nlevels; l++)
+      {
+        sum += cnt[l];
+        if (2*sum >= verts.Size())
+          {
+            mid = l;
+            break;
+          }
+      }
+    mid = min(max(mid, 1), nlevels-2);
+
+    // separator vertices without neighbours in the upper part move to lower part
+    for (int v : verts)
+      if (level[v] < mid)
+        part0.Append (v);
+      else if (level[v] > mid)
+        part1.Append (v);
+      else
+        {
+          bool coupling = false;
+          for (int w : graph[v])
+            if (mark[w] == id && level[w] > mid)
+              coupling = true;
+          if (coupling)
+            sep.Append (v);
+          else
+            part0.Append (v);
+        }
+  }
+
+  void NestedDissectionOrdering ::
+  BisectGeometric (FlatArray<int> verts, Array<int> & part0,
+                   Array<int> & part1, Array<int> & sep)
+  {
+    Vec<3> pmin = coords[verts[0]], pmax = coords[verts[0]];
+    for (int v : verts)
+      for (int k = 0; k < 3; k++)
+        {
+          pmin(k) = min(pmin(k), coords[v](k));
+          pmax(k) = max(pmax(k), coords[v](k));
+        }
+
+    int dir = 0;
+    for (int k = 1; k < 3; k++)
+      if (pmax(k)-pmin(k) > pmax(dir)-pmin(dir))
+        dir = k;
+
+    if (pmax(dir) == pmin(dir))
+      {
+        BisectLevels (verts, part0, part1, sep);
+        return;
+      }
+
+    Array<int> sorted;
+    sorted = verts;
+    size_t half = sorted.Size()/2;
+    nth_element (&sorted[0], &sorted[half], &sorted[0]+sorted.Size(),
+                 [&] (int a, int b) { return coords[a](dir) < coords[b](dir); });
+
+    int id = markcnt++;
+    for (size_t i = 0; i < sorted.Size(); i++)
+      {
+        mark[sorted[i]] = id;
+        level[sorted[i]] = (i < half) ? 0 : 1;
+      }
+
+    // vertices of the lower half coupling to the upper half form the separator
+    for (int v : sorted.Range(0, half))
+      {
+        bool coupling = false;
+        for (int w : graph[v])
+          if (mark[w] == id && level[w] == 1)
+            coupling = true;
+        if (coupling)
+          sep.Append (v);
+        else
+          part0.Append (v);
+      }
+    part1 = sorted.Range(half, sorted.Size());
+  }
+
 }
@@ -136,6 +136,8 @@ namespace ngla
     MDOPriorityQueue priqueue;
     ///
     ngstd::BlockAllocator ball;
+    /// if set, masters are eliminated in this order instead of by minimum degree
+    Array<int> prescribed_order;
   public:
     ///
     MinimumDegreeOrdering (int an);
@@ -151,6 +153,8 @@ namespace ngla
     void EliminateSlaveVertex (int v);
     ///
     void Order();
+    /// use given elimination order (e.g. from nested dissection)
+    void SetPrescribedOrder (Array<int> && aorder) { prescribed_order = move(aorder); }
     /// 
     ~MinimumDegreeOrdering();
 
@@ -198,6 +202,45 @@ namespace ngla
   };
 
 
+
+  /**
+     Nested dissection ordering.
+     Bisects by coordinates if available, otherwise by a
+     level structure of the graph. Separators are ordered last.
+   */
+  class NGS_DLL_HEADER NestedDissectionOrdering
+  {
+    /// symmetric graph, without diagonal
+    const Table<int> & graph;
+    /// optional coordinates of vertices
+    FlatArray<Vec<3>> coords;
+    /// parts up to this size are not dissected further
+    int minsize;
+
+    Array<int> mark;
+    Array<int> level;
+    int markcnt = 0;
+  public:
+    /// elimination order of the vertices
+    Array<int> order;
+    
+    NestedDissectionOrdering (const Table<int> & agraph,
+                              FlatArray<Vec<3>> acoords = FlatArray<Vec<3>>(0, nullptr),
+                              int aminsize = 64);
+
+    /// order the given vertices
+    void Order (FlatArray<int> vertices);
+  protected:
+    void Dissect (FlatArray<int> verts, size_t first);
+    void BisectGeometric (FlatArray<int> verts, Array<int> & part0,
+                          Array<int> & part1, Array<int> & sep);
+    void BisectLevels (FlatArray<int> verts, Array<int> & part0,
+                       Array<int> & part1, Array<int> & sep);
+    /// breadth first search within marked vertices, returns number of levels
+    int BFS (int start, Array<int> & visited);
+  };
+
+
 }
 
 
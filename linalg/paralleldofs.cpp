@@ -158,6 +158,113 @@ namespace ngla
 
   }
 
+
+  template <typename SCAL>
+  HaloExchange<SCAL> & ParallelDofs :: GetHaloExchange (int es) const
+  {
+    auto & cache = HaloCache (SCAL(0));
+    if (cache.Size() <= es)
+      cache.SetSize (es+1);
+    if (!cache[es])
+      cache[es] = make_shared<HaloExchange<SCAL>> (*this, es);
+    return *cache[es];
+  }
+
+  template HaloExchange<double> & ParallelDofs :: GetHaloExchange<double> (int es) const;
+  template HaloExchange<Complex> & ParallelDofs :: GetHaloExchange<Complex> (int es) const;
+
+
+
+  template <typename SCAL>
+  HaloExchange<SCAL> :: HaloExchange (const ParallelDofs & apardofs, int aes)
+    : pardofs(apardofs), es(aes)
+  {
+    for (int p : pardofs.GetDistantProcs())
+      procs.Append (p);
+
+    Array<int> sizes(procs.Size());
+    for (size_t i = 0; i < procs.Size(); i++)
+      sizes[i] = es * pardofs.GetExchangeDofs(procs[i]).Size();
+    sendbuf = Table<SCAL> (sizes);
+    recvbuf = Table<SCAL> (sizes);
+
+    MPI_Datatype type = MyGetMPIType<SCAL>();
+    MPI_Comm comm = pardofs.GetCommunicator();
+    sendrequests.SetSize (procs.Size());
+    recvrequests.SetSize (procs.Size());
+    for (size_t i = 0; i < procs.Size(); i++)
+      {
+        MPI_Send_init (sendbuf[i].Addr(0), sizes[i], type, procs[i], MPI_TAG_HALO,
+                       comm, &sendrequests[i]);
+        MPI_Recv_init (recvbuf[i].Addr(0), sizes[i], type, procs[i], MPI_TAG_HALO,
+                       comm, &recvrequests[i]);
+      }
+  }
+
+  template <typename SCAL>
+  HaloExchange<SCAL> :: ~HaloExchange ()
+  {
+    int finalized;
+    MPI_Finalized (&finalized);
+    if (finalized) return;
+    for (auto & r : sendrequests) MPI_Request_free (&r);
+    for (auto & r : recvrequests) MPI_Request_free (&r);
+  }
+
+  template <typename SCAL>
+  void HaloExchange<SCAL> :: Start (FlatVector<SCAL> vec)
+  {
+    static Timer t("HaloExchange::Start");
+    RegionTimer reg(t);
+
+    busy = true;
+    if (!procs.Size()) return;
+
+    // receives first, so that messages do not need to be buffered
+    MPI_Startall (recvrequests.Size(), &recvrequests[0]);
+
+    for (size_t i = 0; i < procs.Size(); i++)
+      {
+        FlatArray<int> exdofs = pardofs.GetExchangeDofs(procs[i]);
+        SCAL * buf = sendbuf[i].Addr(0);
+        if (es == 1)
+          for (size_t k = 0; k < exdofs.Size(); k++)
+            buf[k] = vec(exdofs[k]);
+        else
+          for (size_t k = 0; k < exdofs.Size(); k++)
+            for (int j = 0; j < es; j++)
+              buf[k*es+j] = vec(exdofs[k]*es+j);
+      }
+
+    MPI_Startall (sendrequests.Size(), &sendrequests[0]);
+  }
+
+  template <typename SCAL>
+  void HaloExchange<SCAL> :: FinishAdd (FlatVector<SCAL> vec)
+  {
+    static Timer t("HaloExchange::Finish");
+    RegionTimer reg(t);
+
+    for (size_t cnt = 0; cnt < procs.Size(); cnt++)
+      {
+        int i = MyMPI_WaitAny (recvrequests);
+        FlatArray<int> exdofs = pardofs.GetExchangeDofs(procs[i]);
+        SCAL * buf = recvbuf[i].Addr(0);
+        if (es == 1)
+          for (size_t k = 0; k < exdofs.Size(); k++)
+            vec(exdofs[k]) += buf[k];
+        else
+          for (size_t k = 0; k < exdofs.Size(); k++)
+            for (int j = 0; j < es; j++)
+              vec(exdofs[k]*es+j) += buf[k*es+j];
+      }
+    MyMPI_WaitAll (sendrequests);
+    busy = false;
+  }
+
+  template class HaloExchange<double>;
+  template class HaloExchange<Complex>;
+
 }
 
 #endif
@@ -14,6 +14,8 @@ namespace ngla
 
 #ifdef PARALLEL
 
+  template <typename SCAL> class HaloExchange;
+
   /**
      Handles the distribution of degrees of freedom for vectors and matrices
    */
@@ -43,6 +45,13 @@ namespace ngla
     
     /// am I the master process ?
     BitArray ismasterdof;
+
+    /// halo exchanges for real and complex vectors, by entry size
+    mutable Array<shared_ptr<HaloExchange<double>>> halo_double;
+    mutable Array<shared_ptr<HaloExchange<Complex>>> halo_complex;
+
+    Array<shared_ptr<HaloExchange<double>>> & HaloCache (double) const { return halo_double; }
+    Array<shared_ptr<HaloExchange<Complex>>> & HaloCache (Complex) const { return halo_complex; }
     
   public:
     /**
@@ -93,6 +102,10 @@ namespace ngla
 
     void EnumerateGlobally (shared_ptr<BitArray> freedofs, Array<int> & globnum, int & num_glob_dofs) const;
 
+    /// exchange object for vectors with entries of es scalars, created on first use
+    template <typename SCAL>
+    HaloExchange<SCAL> & GetHaloExchange (int es) const;
+
 
     template <typename T>
     void ReduceDofData (FlatArray<T> data, MPI_Op op) const;
@@ -111,6 +124,33 @@ namespace ngla
 
   };
 
+
+  /**
+     Adds the values at shared dofs from all neighbours.
+     Uses persistent requests on contiguous buffers, so the
+     communication is set up only once. One exchange at a time.
+   */
+  template <typename SCAL>
+  class NGS_DLL_HEADER HaloExchange
+  {
+    const ParallelDofs & pardofs;
+    int es;
+    Array<int> procs;
+    Table<SCAL> sendbuf, recvbuf;
+    Array<MPI_Request> sendrequests, recvrequests;
+    bool busy = false;
+  public:
+    HaloExchange (const ParallelDofs & apardofs, int aes);
+    ~HaloExchange ();
+
+    bool IsBusy () const { return busy; }
+
+    /// pack values at exchange dofs, and start all transfers
+    void Start (FlatVector<SCAL> vec);
+    /// wait for the transfers, and add the received values
+    void FinishAdd (FlatVector<SCAL> vec);
+  };
+
 #else
   class ParallelDofs 
   {
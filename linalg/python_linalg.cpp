@@ -5,6 +5,46 @@
 using namespace ngla;
 
 
+template <typename T>
+shared_ptr<SparseMatrix<T>> CreateSparseMatrix (const Array<int> & elsperrow, int width, SparseMatrix<T> *)
+{ return make_shared<SparseMatrix<T>> (elsperrow, width); }
+
+template <typename T>
+shared_ptr<SparseMatrixSymmetric<T>> CreateSparseMatrix (const Array<int> & elsperrow, int width, SparseMatrixSymmetric<T> *)
+{ return make_shared<SparseMatrixSymmetric<T>> (elsperrow); }
+
+// pickling of sparse matrices: row sizes, then graph and values in bulk
+template <typename TMAT>
+py::tuple SparseMatrixGetState (const TMAT & mat)
+{
+  auto str = make_shared<stringstream>();
+  {
+    BinaryOutArchive ar(str);
+    Array<int> elsperrow(mat.Height());
+    for (int i = 0; i < mat.Height(); i++)
+      elsperrow[i] = mat.GetRowIndices(i).Size();
+    int width = mat.Width();
+    ar & elsperrow & width;
+    const_cast<TMAT&>(mat).DoArchive(ar);
+  }
+  return py::make_tuple(py::bytes(str->str()));
+}
+
+template <typename TMAT>
+shared_ptr<TMAT> SparseMatrixSetState (py::tuple state)
+{
+  char * buffer;
+  Py_ssize_t len;
+  PyBytes_AsStringAndSize (state[0].ptr(), &buffer, &len);
+  BinaryInArchive ar(FlatArray<char> (len, buffer));
+  Array<int> elsperrow;
+  int width;
+  ar & elsperrow & width;
+  auto mat = CreateSparseMatrix (elsperrow, width, (TMAT*)nullptr);
+  mat->DoArchive(ar);
+  return mat;
+}
+
 template<typename T>
 void ExportSparseMatrix(py::module m)
 {
@@ -63,10 +103,15 @@ void ExportSparseMatrix(py::module m)
 
     .def("__matmul__", [] (const SparseMatrix<double> & a, const SparseMatrix<double> & b)
          { return MatMult(a,b); })
+    .def(py::pickle(&SparseMatrixGetState<SparseMatrix<T>>,
+                    &SparseMatrixSetState<SparseMatrix<T>>))
     ;
 
   py::class_<SparseMatrixSymmetric<T>, shared_ptr<SparseMatrixSymmetric<T>>, SparseMatrix<T>>
-    (m, (string("SparseMatrixSymmetric") + typeid(T).name()).c_str());
+    (m, (string("SparseMatrixSymmetric") + typeid(T).name()).c_str())
+    .def(py::pickle(&SparseMatrixGetState<SparseMatrixSymmetric<T>>,
+                    &SparseMatrixSetState<SparseMatrixSymmetric<T>>))
+    ;
 }
 
 void NGS_DLL_HEADER ExportNgla(py::module &m) {
@@ -518,6 +563,7 @@ freedofs : BitArray
 inverse : string
   Solver to use, allowed values are:
     sparsecholesky - internal solver of NGSolve for symmetric matrices
+    sparsecholesky_nd - as sparsecholesky, with nested dissection ordering
     umfpack        - solver by Suitesparse/UMFPACK (if NGSolve was configured with USE_UMFPACK=ON)
     pardiso        - PARDISO, either provided by libpardiso (USE_PARDISO=ON) or Intel MKL (USE_MKL=ON).
                      If neither Pardiso nor Intel MKL was linked at compile-time, NGSolve will look
@@ -589,6 +635,8 @@ inverse : string
     (m, "ParallelMatrix", "MPI-distributed matrix")
     .def(py::init<shared_ptr<BaseMatrix>, shared_ptr<ParallelDofs>>())
     .def_property_readonly("local_mat", [](ParallelMatrix & mat) { return mat.GetMatrix(); })
+    .def_property("overlap", &ParallelMatrix::GetOverlap, &ParallelMatrix::SetOverlap,
+                  "overlap the vector exchange with the product of the interior rows")
     ;
 
   py::class_<FETI_Jump_Matrix, shared_ptr<FETI_Jump_Matrix>, BaseMatrix>
@@ -605,7 +653,35 @@ inverse : string
   ExportSparseMatrix<Mat<2,2,Complex>>(m);
   ExportSparseMatrix<Mat<3,3,double>>(m);
   ExportSparseMatrix<Mat<3,3,Complex>>(m);
-  
+
+  py::class_<SparseMatrixSELL, shared_ptr<SparseMatrixSELL>, BaseMatrix>
+    (m, "SparseMatrixSELL",
+     "sliced ELLPACK copy of a sparse matrix for SIMD matrix-vector products,\n"
+     "falls back to the CSR matrix for block-, complex- or symmetric matrices")
+    .def(py::init<> ([] (shared_ptr<BaseSparseMatrix> mat, int sigma, double maxfill)
+                     {
+                       return make_shared<SparseMatrixSELL> (mat, sigma, maxfill);
+                     }),
+         py::arg("mat"), py::arg("sigma")=256, py::arg("maxfill")=1.5)
+    .def_property_readonly("uses_csr", &SparseMatrixSELL::UsesCSR)
+    ;
+
+  py::class_<SparseMatrixFloat, shared_ptr<SparseMatrixFloat>, BaseSparseMatrix>
+    (m, "SparseMatrixFloat",
+     "sparse matrix with values in single precision, accumulating in double precision")
+    .def(py::init<> ([] (shared_ptr<BaseSparseMatrix> mat)
+                     {
+                       return CreateFloatMatrix (*mat);
+                     }),
+         py::arg("mat"), "single precision copy of a real sparse matrix")
+    .def("Assign", [] (SparseMatrixFloat & self, shared_ptr<BaseSparseMatrix> mat)
+         {
+           auto matd = dynamic_pointer_cast<SparseMatrixTM<double>> (mat);
+           if (!matd) throw Exception ("SparseMatrixFloat::Assign needs a real scalar matrix");
+           self.Assign (*matd);
+         }, py::arg("mat"), "copy values from a matrix with the same graph")
+    ;
+
   py::class_<BaseBlockJacobiPrecond, shared_ptr<BaseBlockJacobiPrecond>, BaseMatrix>
     (m, "BlockSmoother",
      "block Jacobi and block Gauss-Seidel smoothing")
@@ -669,6 +745,58 @@ inverse : string
           )
     ;
 
+  m.def("PipelinedCGSolver", [](const BaseMatrix & mat, const BaseMatrix & pre,
+                                bool iscomplex, bool printrates,
+                                double precision, int maxsteps)
+        {
+          KrylovSpaceSolver * solver;
+          if(mat.IsComplex()) iscomplex = true;
+
+          if (iscomplex)
+            solver = new PipelinedCGSolver<Complex> (mat, pre);
+          else
+            solver = new PipelinedCGSolver<double> (mat, pre);
+          solver->SetPrecision(precision);
+          solver->SetMaxSteps(maxsteps);
+          solver->SetPrintRates (printrates);
+          return shared_ptr<KrylovSpaceSolver>(solver);
+        },
+        "pipelined CG Solver, one non-blocking reduction per iteration overlapping with pre and mat",
+        py::arg("mat"), py::arg("pre"), py::arg("complex") = false, py::arg("printrates")=true,
+        py::arg("precision")=1e-8, py::arg("maxsteps")=200
+        )
+    ;
+
+  m.def("SStepCGSolver", [](const BaseMatrix & mat, const BaseMatrix & pre,
+                            int sstep, bool iscomplex, bool printrates,
+                            double precision, int maxsteps)
+        {
+          KrylovSpaceSolver * solver;
+          if(mat.IsComplex()) iscomplex = true;
+
+          if (iscomplex)
+            {
+              auto hsolver = new SStepCGSolver<Complex> (mat, pre);
+              hsolver->SetSStep(sstep);
+              solver = hsolver;
+            }
+          else
+            {
+              auto hsolver = new SStepCGSolver<double> (mat, pre);
+              hsolver->SetSStep(sstep);
+              solver = hsolver;
+            }
+          solver->SetPrecision(precision);
+          solver->SetMaxSteps(maxsteps);
+          solver->SetPrintRates (printrates);
+          return shared_ptr<KrylovSpaceSolver>(solver);
+        },
+        "s-step CG Solver, one non-blocking reduction per sstep iterations",
+        py::arg("mat"), py::arg("pre"), py::arg("sstep")=4, py::arg("complex") = false,
+        py::arg("printrates")=true, py::arg("precision")=1e-8, py::arg("maxsteps")=200
+        )
+    ;
+
   m.def("GMRESSolver", [](const BaseMatrix & mat, const BaseMatrix & pre,
                                            bool printrates, 
                                            double precision, int maxsteps)
@@ -0,0 +1,159 @@
+/*********************************************************************/
+/* File:   sellmatrix.cpp                                            */
+/* Date:   17. Oct. 2026                                             */
+/*********************************************************************/
+
+/*
+   sliced ELLPACK storage for SIMD matrix-vector products
+*/
+
+#include <la.hpp>
+
+namespace ngla
+{
+
+  SparseMatrixSELL :: SparseMatrixSELL (shared_ptr<BaseSparseMatrix> acsr,
+                                        int asigma, double maxfill)
+    : csr(acsr), sigma(max(asigma, int(C)))
+  {
+    static Timer t("SparseMatrixSELL - build graph");
+    RegionTimer reg(t);
+
+    csrd = dynamic_pointer_cast<SparseMatrixTM<double>> (csr);
+    // SparseMatrix<double,Complex,Complex> is also a SparseMatrixTM<double>, but acts on complex vectors
+    use_csr = !dynamic_pointer_cast<SparseMatrix<double>> (csr) || csr->IsComplex() ||
+      dynamic_pointer_cast<SparseMatrixSymmetric<double>> (csr);
+    if (use_csr) return;
+
+    const MatrixGraph & graph = *csrd;
+    int h = graph.Size();
+    size_t nchunks = (h+C-1) / C;
+
+    Array<int> rowlen(h);
+    for (int i = 0; i < h; i++)
+      rowlen[i] = graph.GetRowIndices(i).Size();
+
+    // sort rows by decreasing length within windows of sigma rows
+    Array<int> perm(h);
+    for (int i = 0; i < h; i++) perm[i] = i;
+    for (int first = 0; first < h; first += sigma)
+      QuickSortI (FlatArray<int> (rowlen), perm.Range(first, min(first+sigma, h)),
+                  [] (int a, int b) { return a > b; });
+
+    rows.SetSize (nchunks*C);
+    rows = -1;
+    rows.Range(0, h) = perm;
+
+    firstcol.SetSize (nchunks+1);
+    firstcol[0] = 0;
+    for (size_t c = 0; c < nchunks; c++)
+      {
+        int maxlen = 0;
+        for (int l = 0; l < C; l++)
+          if (rows[c*C+l] != -1)
+            maxlen = max(maxlen, rowlen[rows[c*C+l]]);
+        firstcol[c+1] = firstcol[c] + maxlen;
+      }
+
+    size_t ncols = firstcol[nchunks];
+    if (ncols*C > maxfill * graph.NZE())
+      {
+        cout << IM(3) << "SparseMatrixSELL: fill " << double(ncols*C)/graph.NZE()
+             << " too large, using CSR" << endl;
+        use_csr = true;
+        rows.SetSize(0);
+        firstcol.SetSize(0);
+        return;
+      }
+
+    // padding refers to column 0 with value 0
+    colnr.SetSize (ncols*C);
+    data.SetSize (ncols);
+
+    ParallelFor (Range(nchunks), [&] (size_t c)
+      {
+        for (int l = 0; l < C; l++)
+          {
+            int row = rows[c*C+l];
+            FlatArray<int> ind = row != -1 ? graph.GetRowIndices(row) : FlatArray<int>(0, nullptr);
+            for (size_t j = firstcol[c], k = 0; j < firstcol[c+1]; j++, k++)
+              colnr[j*C+l] = (k < ind.Size()) ? ind[k] : 0;
+          }
+      });
+
+    Update();
+  }
+
+  SparseMatrixSELL :: ~SparseMatrixSELL ()
+  { ; }
+
+  void SparseMatrixSELL :: Update()
+  {
+    if (use_csr) return;
+
+    static Timer t("SparseMatrixSELL - copy values");
+    RegionTimer reg(t);
+
+    size_t nchunks = firstcol.Size()-1;
+    ParallelFor (Range(nchunks), [&] (size_t c)
+      {
+        FlatArray<int> crows = rows.Range(c*C, (c+1)*C);
+        for (size_t j = firstcol[c], k = 0; j < firstcol[c+1]; j++, k++)
+          data[j] = SIMD<double> ([&] (int l) -> double
+                                  {
+                                    if (crows[l] == -1) return 0.0;
+                                    FlatVector<double> vals = csrd->GetRowValues(crows[l]);
+                                    return (k < vals.Size()) ? vals(k) : 0.0;
+                                  });
+      });
+  }
+
+  void SparseMatrixSELL :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    if (use_csr)
+      {
+        csr->MultAdd (s, x, y);
+        return;
+      }
+
+    static Timer t("SparseMatrixSELL::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (csr->NZE());
+
+    FlatVector<double> fx = x.FV<double>();
+    FlatVector<double> fy = y.FV<double>();
+    size_t nchunks = firstcol.Size()-1;
+
+    ParallelForRange (IntRange(nchunks), [&] (IntRange r)
+      {
+        for (auto c : r)
+          {
+            SIMD<double> sum(0.0);
+            const int * pcol = &colnr[firstcol[c]*C];
+            for (size_t j = firstcol[c]; j < firstcol[c+1]; j++, pcol += C)
+              sum = FMA (data[j], SIMD<double> ([pcol,fx] (int l) { return fx(pcol[l]); }), sum);
+            sum *= s;
+            for (int l = 0; l < C; l++)
+              {
+                int row = rows[c*C+l];
+                if (row != -1) fy(row) += sum[l];
+              }
+          }
+      }, TasksPerThread(4));
+  }
+
+  ostream & SparseMatrixSELL :: Print (ostream & ost) const
+  {
+    ost << "SELL-" << C << "-" << sigma << " matrix, "
+        << (use_csr ? "using CSR fallback" : "SIMD storage") << endl;
+    return static_cast<const BaseMatrix&> (*csr).Print (ost);
+  }
+
+  void SparseMatrixSELL :: MemoryUsage (Array<MemoryUsageStruct*> & mu) const
+  {
+    mu.Append (new MemoryUsageStruct ("SparseMatrixSELL",
+                                      data.Size()*sizeof(SIMD<double>) + colnr.Size()*sizeof(int)
+                                      + rows.Size()*sizeof(int), 3));
+    static_cast<const BaseMatrix&> (*csr).MemoryUsage (mu);
+  }
+
+}
@@ -0,0 +1,84 @@
+#ifndef FILE_NGS_SELLMATRIX
+#define FILE_NGS_SELLMATRIX
+
+/**************************************************************************/
+/* File:   sellmatrix.hpp                                                 */
+/* Date:   17. Oct. 2026                                                  */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  /**
+     Sliced ELLPACK (SELL-C-sigma) copy of a real, scalar sparse matrix.
+
+     Rows are sorted by length within windows of sigma rows, and
+     C = SIMD<double>::Size() consecutive rows form a chunk. A chunk
+     is stored column-major padded to its longest row, such that
+     every SIMD lane processes one row.
+
+     The graph is taken from the CSR matrix, values are copied by
+     Update(). If the matrix is not real-scalar and non-symmetric,
+     or the padding overhead is larger than maxfill, all operations
+     fall back to the CSR matrix.
+  */
+  class NGS_DLL_HEADER SparseMatrixSELL : public S_BaseMatrix<double>
+  {
+    static constexpr int C = SIMD<double>::Size();
+
+    /// the original CSR matrix
+    shared_ptr<BaseSparseMatrix> csr;
+    /// the csr matrix if it is real and scalar
+    shared_ptr<SparseMatrixTM<double>> csrd;
+    /// sorting window
+    int sigma;
+    /// use csr matrix for MultAdd
+    bool use_csr;
+
+    /// first SIMD-column of chunk
+    Array<size_t> firstcol;
+    /// row of lane, -1 for padding
+    Array<int> rows;
+    /// column numbers, C per SIMD-column
+    Array<int> colnr;
+    /// values, one SIMD per SIMD-column
+    Array<SIMD<double>> data;
+
+  public:
+    SparseMatrixSELL (shared_ptr<BaseSparseMatrix> acsr,
+                      int asigma = 256, double maxfill = 1.5);
+    virtual ~SparseMatrixSELL ();
+
+    /// copy values from the CSR matrix (graph must not have changed)
+    virtual void Update() override;
+
+    bool UsesCSR () const { return use_csr; }
+    shared_ptr<BaseSparseMatrix> GetCSRMatrix () const { return csr; }
+
+    virtual bool IsComplex() const override { return csr->IsComplex(); }
+    virtual int VHeight() const override { return csr->VHeight(); }
+    virtual int VWidth() const override { return csr->VWidth(); }
+    virtual size_t NZE () const override { return csr->NZE(); }
+
+    virtual AutoVector CreateRowVector () const override { return csr->CreateRowVector(); }
+    virtual AutoVector CreateColVector () const override { return csr->CreateColVector(); }
+    virtual AutoVector CreateVector () const override { return csr->CreateVector(); }
+
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    virtual void MultAdd (Complex s, const BaseVector & x, BaseVector & y) const override
+    { csr->MultAdd (s, x, y); }
+    virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override
+    { csr->MultTransAdd (s, x, y); }
+    virtual void MultTransAdd (Complex s, const BaseVector & x, BaseVector & y) const override
+    { csr->MultTransAdd (s, x, y); }
+
+    virtual shared_ptr<BaseMatrix> InverseMatrix (shared_ptr<BitArray> subset = nullptr) const override
+    { return csr->InverseMatrix (subset); }
+
+    virtual ostream & Print (ostream & ost) const override;
+    virtual void MemoryUsage (Array<MemoryUsageStruct*> & mu) const override;
+  };
+
+}
+
+#endif
@@ -8,14 +8,6 @@
 
 #include <la.hpp>
 
-#include "concurrentqueue.h" 
-
-
-typedef moodycamel::ConcurrentQueue<int> TQueue; 
-typedef moodycamel::ProducerToken TPToken; 
-typedef moodycamel::ConsumerToken TCToken; 
- 
-
 
 namespace ngla
 {
@@ -33,6 +25,23 @@ namespace ngla
 
 
 
+  /// size of the factor and predicted flops for an ordering, as computed by Allocate
+  template <class TM>
+  static void CalcFactorStatistics (const Array<int> & order, const Array<MDOVertex> & vertices,
+                                    const int * blocknr, int nused,
+                                    size_t & nze, double & flops)
+  {
+    nze = 0;
+    flops = 0;
+    for (int i = 0; i < nused; i++)
+      {
+        size_t cnti = vertices[order[blocknr[i]]].nconnected - (i-blocknr[i]);
+        nze += cnti;
+        flops += double(cnti)*cnti;
+      }
+    flops *= mat_traits<TM>::HEIGHT * mat_traits<TM>::HEIGHT * mat_traits<TM>::HEIGHT;
+  }
+
   template <class TM>
   SparseCholeskyTM<TM> :: 
   SparseCholeskyTM (const SparseMatrixTM<TM> & a, 
@@ -115,6 +124,62 @@ namespace ngla
 	}
     */
 
+    bool nested_dissection = (a.GetInverseType() == SPARSECHOLESKY_ND);
+    size_t mdo_nze = 0;
+    double mdo_flops = 0;
+    if (nested_dissection)
+      {
+        static Timer tnd("SparseCholesky - nested dissection");
+        RegionTimer regnd(tnd);
+
+        auto used = [&] (int i) { return !mdo->vertices[i].Eliminated(); };
+        auto coupled = [&] (int i, int j)
+          {
+            if (!used(i) || !used(j)) return false;
+            if (cluster) return (*cluster)[i] == (*cluster)[j];
+            return true;
+          };
+
+        TableCreator<int> creator(n);
+        for ( ; !creator.Done(); creator++)
+          for (int i = 0; i < n; i++)
+            for (int col : a.GetRowIndices(i))
+              if (col < i && coupled (i, col))
+                {
+                  creator.Add (i, col);
+                  creator.Add (col, i);
+                }
+        Table<int> graph = creator.MoveTable();
+
+        Array<int> usedverts;
+        for (int i = 0; i < n; i++)
+          if (used(i)) usedverts.Append (i);
+
+        Array<Vec<3>> coords = a.GetDofCoordinates();
+        NestedDissectionOrdering nd(graph, coords);
+        nd.Order (usedverts);
+        mdo->SetPrescribedOrder (move(nd.order));
+
+        if (printmessage_importance >= 3)
+          {
+            // minimum degree ordering of the same graph, for comparison
+            MinimumDegreeOrdering mdo2(n);
+            for (int i = 0; i < n; i++)
+              if (!used(i))
+                mdo2.SetUnusedVertex(i);
+            for (int i : usedverts)
+              {
+                mdo2.AddEdge (i, i);
+                for (int j : graph[i])
+                  if (j < i)
+                    mdo2.AddEdge (i, j);
+              }
+            mdo2.Order();
+            CalcFactorStatistics<TM> (mdo2.order, mdo2.vertices, &mdo2.blocknr[0], mdo2.nused,
+                                  mdo_nze, mdo_flops);
+          }
+      }
+
     if (printstat)
       cout << IM(4) << "start ordering" << endl;
     
@@ -135,6 +200,14 @@ namespace ngla
     Allocate (mdo->order,  mdo->vertices, &mdo->blocknr[0]);
     ta.Stop();
 
+    cout << IM(3) << "SparseCholesky, "
+         << (nested_dissection ? "nested dissection" : "minimum degree")
+         << " ordering: nze = " << nze
+         << ", predicted flops = " << factor_flops << endl;
+    if (nested_dissection)
+      cout << IM(3) << "SparseCholesky, minimum degree ordering: nze = " << mdo_nze
+           << ", predicted flops = " << mdo_flops << endl;
+
     tf.Start();
     delete mdo;
     mdo = 0;
@@ -285,12 +358,16 @@ namespace ngla
     long int cnt = 0;
     long int cnt_master = 0;
 
+    factor_flops = 0;
     for (int i = 0; i < nused; i++)
       {
-	cnt += vertices[aorder[blocknrs[i]]].nconnected - (i-blocknrs[i]);
+        long int cnti = vertices[aorder[blocknrs[i]]].nconnected - (i-blocknrs[i]);
+	cnt += cnti;
 	if (blocknrs[i] == i)
 	  cnt_master += vertices[aorder[i]].nconnected;
+        factor_flops += double(cnti)*cnti;
       }
+    factor_flops *= mat_traits<TM>::HEIGHT * mat_traits<TM>::HEIGHT * mat_traits<TM>::HEIGHT;
 
     nze = cnt;
 
@@ -877,6 +954,7 @@ namespace ngla
       }
 
     static Timer factor_timer("SparseCholesky::Factor SPD");
+    static Timer factor_tree("SparseCholesky::Factor SPD - elimination tree");
     static Timer factor_dense1("SparseCholesky::Factor SPD - setup dense cholesky");
     static Timer factor_dense("SparseCholesky::Factor SPD - dense cholesky");
 
@@ -897,27 +975,17 @@ namespace ngla
     size_t * hfirstinrow_ri = firstinrow_ri.Addr(0);
     int * hrowindex2 = rowindex2.Addr(0);
     TM * hlfact = lfact.Addr(0);
-    
-    Array<TM> tmpmem;
-    for (size_t i1 = 0; i1 < n;  )
-      {
-	size_t last_same = i1;
-	while (last_same < n && blocknrs[last_same] == blocknrs[i1])
-          {
-            last_same++;
 
-	    if (n > 2000 && (last_same) % 1000 == 999)
-	      {
-		if ((last_same) % 10000 == 9999)
-		  cout << IM(4) << "+" << flush;
-		else
-		  cout << IM(4) << "." << flush;
-	      }
-          }
-
-        
-        // timerb.Start();
 
+    /*
+      eliminate the supernode [i1, last_same): dense LDL^T of the
+      diagonal block, then merge the Schur complement into the
+      rows of later supernodes. If supernodes are factored
+      concurrently (independent subtrees of the elimination tree),
+      the merge into the common ancestors must be atomic.
+    */
+    auto factor_supernode = [&] (size_t i1, size_t last_same, Array<TM> & tmpmem, bool atomic)
+      {
 	// rows in same block ...
 	size_t mi = last_same - i1;
         size_t nk = hfirstinrow[i1+1] - hfirstinrow[i1] + 1;
@@ -1001,8 +1069,11 @@ namespace ngla
                     firstj++;
                     firstj_ri++;
                   }
-                
-                lfact[firstj] += sum[k];
+
+                if (atomic)
+                  MyAtomicAdd (lfact[firstj], sum[k]);
+                else
+                  lfact[firstj] += sum[k];
                 firstj++;
                 firstj_ri++;
               }
@@ -1027,12 +1098,74 @@ namespace ngla
 	    for (auto j = first; j < last; j++, j_ri++)
 	      {
 		TM q = diag[i2] * lfact[j];
-		diag[rowindex2[j_ri]] -= Trans (lfact[j]) * q;
+                if (atomic)
+                  MyAtomicAdd (diag[rowindex2[j_ri]], -Trans (lfact[j]) * q);
+                else
+                  diag[rowindex2[j_ri]] -= Trans (lfact[j]) * q;
 	      }
 	  }
         // timerc2.Stop();
-	i1 = last_same;
-        // timerc.Stop();
+      };
+
+
+    // supernodes are the dofs of identical blocknr
+    Array<size_t> supernodes;
+    supernodes.Append (0);
+    for (size_t i = 1; i < n; i++)
+      if (blocknrs[i] != blocknrs[i-1])
+        supernodes.Append (i);
+    if (n > 0) supernodes.Append (n);
+    size_t nsuper = supernodes.Size()-1;
+
+    if (TaskManager::GetNumThreads() > 1 && nsuper > 100)
+      {
+        // the elimination tree of supernodes: the parent is the
+        // supernode of the first external dof. Independent subtrees
+        // are factored in parallel.
+        factor_tree.Start();
+        Array<int> supernode_of(n);
+        for (size_t s = 0; s < nsuper; s++)
+          supernode_of.Range(supernodes[s], supernodes[s+1]) = s;
+
+        Array<int> parent(nsuper);
+        for (size_t s = 0; s < nsuper; s++)
+          {
+            // rows of a supernode share their row indices, count the entries of row i1
+            size_t i1 = supernodes[s], last_same = supernodes[s+1];
+            size_t firsti_ri = hfirstinrow_ri[i1] + last_same-i1-1;
+            size_t nexternal = hfirstinrow[i1+1]-hfirstinrow[i1] - (last_same-i1-1);
+            parent[s] = nexternal ? supernode_of[hrowindex2[firsti_ri]] : -1;
+          }
+
+        TableCreator<int> creator(nsuper), creator_trans(nsuper);
+        for ( ; !creator.Done(); creator++, creator_trans++)
+          for (size_t s = 0; s < nsuper; s++)
+            if (parent[s] != -1)
+              {
+                creator.Add (s, parent[s]);
+                creator_trans.Add (parent[s], s);
+              }
+        Table<int> etree = creator.MoveTable();
+        Table<int> etree_trans = creator_trans.MoveTable();
+        factor_tree.Stop();
+
+        RunParallelDependency (etree, etree_trans,
+                               [&] (int s)
+                               {
+                                 Array<TM> tmpmem;
+                                 factor_supernode (supernodes[s], supernodes[s+1], tmpmem, true);
+                               });
+      }
+    else
+      {
+        Array<TM> tmpmem;
+        for (size_t s = 0; s < nsuper; s++)
+          {
+            factor_supernode (supernodes[s], supernodes[s+1], tmpmem, false);
+
+            if (n > 2000 && s % 1000 == 999)
+              cout << IM(4) << "." << flush;
+          }
       }
 
     size_t j = 0;
@@ -1193,89 +1326,6 @@ namespace ngla
 
 
   
-  static TQueue queue;
-
-
-  template <typename TFUNC>
-  void RunParallelDependency (const Table<int> & dag,
-                              const Table<int> & trans_dag, // transposed dag
-                              TFUNC func)
-  {
-    Array<atomic<int>> cnt_dep(dag.Size());
-    for (auto i : Range(cnt_dep))
-      cnt_dep[i].store (trans_dag[i].Size(), memory_order_relaxed);
-    
-    Array<int> ready(dag.Size());
-    ready.SetSize0();
-    int num_final = 0;
-
-    for (int j : Range(cnt_dep))
-      {
-        if (cnt_dep[j] == 0) ready.Append(j);
-        if (dag[j].Size() == 0) num_final++;
-      }
-
-
-    if (!task_manager)
-      {
-        while (ready.Size())
-          {
-            int size = ready.Size();
-            int nr = ready[size-1];
-            ready.SetSize(size-1);
-            
-            func(nr);
-            
-            for (int j : dag[nr])
-              {
-                cnt_dep[j]--;
-                if (cnt_dep[j] == 0)
-                  ready.Append(j);
-              }
-          }
-        return;
-      }
-
-    atomic<int> cnt_final(0);
-    SharedLoop sl(Range(ready));
-
-    task_manager -> CreateJob 
-      ([&] (const TaskInfo & ti)
-       {
-        TPToken ptoken(queue); 
-        TCToken ctoken(queue); 
-        
-        for (int i : sl)
-          queue.enqueue (ptoken, ready[i]);
-
-        while (1)
-           {
-             if (cnt_final >= num_final) break;
-
-             int nr;
-             if(!queue.try_dequeue_from_producer(ptoken, nr)) 
-               if(!queue.try_dequeue(ctoken, nr))  
-                 continue; 
-             
-             if (dag[nr].Size() == 0)
-               cnt_final++;
-
-             func(nr);
-
-             for (int j : dag[nr])
-               {
-                 if (--cnt_dep[j] == 0)
-                   queue.enqueue (ptoken, j);
-               }
-           }
-       });
-  }
-
-
-
-
-
-
   template <class TM, class TV_ROW, class TV_COL>
   void SparseCholesky<TM, TV_ROW, TV_COL> :: 
   SolveReordered (FlatVector<TVX> hy) const
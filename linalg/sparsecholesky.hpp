@@ -68,6 +68,8 @@ namespace ngla
     int nused;
     // number of non-zero entries in the L-factor
     size_t nze;
+    // predicted flops for the factorization
+    double factor_flops = 0;
 
     // the reordering (original dofnr i -> order[i])
     Array<int> order;
@@ -952,11 +952,12 @@ namespace ngla
     else if (ainversetype == "mumps")         SetInverseType ( MUMPS );
     else if (ainversetype == "masterinverse") SetInverseType ( MASTERINVERSE );
     else if (ainversetype == "sparsecholesky") SetInverseType ( SPARSECHOLESKY );
+    else if (ainversetype == "sparsecholesky_nd") SetInverseType ( SPARSECHOLESKY_ND );
     else if (ainversetype == "umfpack")       SetInverseType ( UMFPACK );
     else
       {
         throw Exception (ToString("undefined inverse ")+ainversetype+
-                         "\nallowed is: 'sparsecholesky', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'umfpack'");
+                         "\nallowed is: 'sparsecholesky', 'sparsecholesky_nd', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'umfpack'");
       }
     return old_invtype;
   }
@@ -1055,6 +1056,44 @@ namespace ngla
   }
   
 
+  template <class TM>
+  void SparseMatrixTM<TM> ::
+  GetElementPositions (FlatArray<int> dnums1, FlatArray<int> dnums2,
+                       FlatArray<size_t> pos, bool lower_only) const
+  {
+    size_t w = dnums2.Size();
+    for (size_t i = 0; i < dnums1.Size(); i++)
+      for (size_t j = 0; j < w; j++)
+        {
+          int row = dnums1[i], col = dnums2[j];
+          if (row == -1 || col == -1 || (lower_only && col > row))
+            pos[i*w+j] = numeric_limits<size_t>::max();
+          else
+            pos[i*w+j] = this->GetPosition (row, col);
+        }
+  }
+
+  template <class TM>
+  void SparseMatrixTM<TM> ::
+  AddElementMatrixPositions (FlatArray<size_t> pos, size_t h, size_t w,
+                             BareSliceMatrix<TSCAL> elmat1, bool use_atomic)
+  {
+    ThreadRegionTimer reg (timer_addelmat_nonsym, TaskManager::GetThreadId());
+    NgProfiler::AddThreadFlops (timer_addelmat_nonsym, TaskManager::GetThreadId(), h*w);
+
+    Scalar2ElemMatrix<TM, TSCAL> elmat (elmat1);
+    for (size_t i = 0; i < h; i++)
+      for (size_t j = 0; j < w; j++)
+        {
+          size_t p = pos[i*w+j];
+          if (p == numeric_limits<size_t>::max()) continue;
+          if (use_atomic)
+            MyAtomicAdd (data[p], elmat(i,j));
+          else
+            data[p] += elmat(i,j);
+        }
+  }
+
   template <class TM>
   void SparseMatrixTM<TM> :: SetZero ()
   {
@@ -1141,6 +1180,28 @@ namespace ngla
               fy(row) += s * RowTimesVector (row, fx);
         });
   }
+
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseMatrix<TM,TV_ROW,TV_COL> ::
+  MultAddRows (double s, const BaseVector & x, BaseVector & y,
+               FlatArray<int> rows) const
+  {
+    static Timer timer("SparseMatrix::MultAddRows");
+    RegionTimer reg (timer);
+
+    FlatVector<TVX> fx = x.FV<TVX>();
+    FlatVector<TVY> fy = y.FV<TVY>();
+
+    ParallelForRange
+      (rows.Size(), [&] (IntRange r)
+       {
+         for (size_t i : r)
+           {
+             int row = rows[i];
+             fy(row) += s * RowTimesVector (row, fx);
+           }
+       });
+  }
   
   
 
@@ -1195,13 +1256,19 @@ namespace ngla
   template <class TM, class TV_ROW, class TV_COL>
   void SparseMatrix<TM,TV_ROW,TV_COL> :: DoArchive (Archive & ar)
   {
-    ar & this->size;
-    ar & this->width;
-    ar & this->nze;
-    ar & firsti;
-    ar & colnr;
-    ar & data;
-    cout << "sparsemat, doarch, sizeof (firstint) = " << firsti.Size() << endl;
+    // input requires a matrix with the same graph layout, as created
+    // by the pickling from the row sizes
+    int h = this->size, w = this->width;
+    size_t n = this->nze;
+    ar & h & w & n;
+    if (ar.Input() && (h != this->size || w != this->width || n != this->nze))
+      throw Exception ("SparseMatrix::DoArchive: matrix layout does not match archive");
+    ar.Do (&firsti[0], firsti.Size());
+    if (this->nze)
+      {
+        ar.Do (&colnr[0], this->nze);
+        ar.Do (reinterpret_cast<double*> (&data[0]), this->nze * sizeof(TM) / sizeof(double));
+      }
   }
 
 
@@ -1945,6 +2012,126 @@ namespace ngla
     return MatMult<double, double, double>(mata, matb);
   }
 
+
+
+  SparseMatrixFloat :: SparseMatrixFloat (const SparseMatrixTM<double> & amat)
+    : BaseSparseMatrix (amat, false), data(nze)
+  {
+    Assign (amat);
+  }
+
+  SparseMatrixFloat :: ~SparseMatrixFloat ()
+  { ; }
+
+  void SparseMatrixFloat :: Assign (const SparseMatrixTM<double> & amat)
+  {
+    static Timer t("SparseMatrixFloat::Assign");
+    RegionTimer reg(t);
+
+    if (amat.NZE() != nze)
+      throw Exception ("SparseMatrixFloat::Assign: graph does not match");
+
+    FlatVector<double> fv = amat.AsVector().FV<double>();
+    ParallelFor (balance, [&](int row)
+                 {
+                   for (size_t j = firsti[row]; j < firsti[row+1]; j++)
+                     data[j] = fv(j);
+                 });
+  }
+
+  AutoVector SparseMatrixFloat :: CreateRowVector () const
+  {
+    return make_shared<VVector<double>> (width);
+  }
+
+  AutoVector SparseMatrixFloat :: CreateColVector () const
+  {
+    return make_shared<VVector<double>> (size);
+  }
+
+  AutoVector SparseMatrixFloat :: CreateVector () const
+  {
+    return make_shared<VVector<double>> (size);
+  }
+
+  void SparseMatrixFloat :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SparseMatrixFloat::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (nze);
+
+    FlatVector<double> fx = x.FV<double>();
+    FlatVector<double> fy = y.FV<double>();
+
+    ParallelFor (balance, [&](int row)
+                 {
+                   fy(row) += s * RowTimesVector (row, fx);
+                 });
+  }
+
+  void SparseMatrixFloat :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SparseMatrixFloat::MultTransAdd"); RegionTimer reg(t);
+    t.AddFlops (nze);
+
+    FlatVector<double> fx = x.FV<double>();
+    FlatVector<double> fy = y.FV<double>();
+
+    for (int i = 0; i < size; i++)
+      AddRowTransToVector (i, s*fx(i), fy);
+  }
+
+  ostream & SparseMatrixFloat :: Print (ostream & ost) const
+  {
+    for (int i = 0; i < size; i++)
+      {
+	ost << "Row " << i << ":";
+	for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+	  ost << "   " << colnr[j] << ": " << data[j];
+	ost << "\n";
+      }
+    return ost;
+  }
+
+  void SparseMatrixFloat :: MemoryUsage (Array<MemoryUsageStruct*> & mu) const
+  {
+    mu.Append (new MemoryUsageStruct ("SparseMatrixFloat", nze*sizeof(float), 1));
+    MatrixGraph::MemoryUsage (mu);
+  }
+
+  void SparseMatrixSymmetricFloat :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SparseMatrixSymmetricFloat::MultAdd"); RegionTimer reg(t);
+    t.AddFlops (2*nze);
+
+    FlatVector<double> fx = x.FV<double>();
+    FlatVector<double> fy = y.FV<double>();
+
+    for (int i = 0; i < size; i++)
+      {
+        size_t first = firsti[i], last = firsti[i+1];
+        double sum = 0;
+        double sxi = s * fx(i);
+        for (size_t j = first; j < last; j++)
+          {
+            int col = colnr[j];
+            double val = data[j];
+            sum += val * fx(col);
+            if (col != i) fy(col) += val * sxi;
+          }
+        fy(i) += s * sum;
+      }
+  }
+
+  shared_ptr<SparseMatrixFloat> CreateFloatMatrix (const BaseSparseMatrix & mat)
+  {
+    if (dynamic_cast<const SparseMatrixSymmetric<double>*> (&mat))
+      return make_shared<SparseMatrixSymmetricFloat> (dynamic_cast<const SparseMatrixTM<double>&> (mat));
+    if (auto matd = dynamic_cast<const SparseMatrixTM<double>*> (&mat))
+      return make_shared<SparseMatrixFloat> (*matd);
+    throw Exception (string("CreateFloatMatrix: only real scalar matrices supported, got ")
+                     + typeid(mat).name());
+  }
+
   template <class TM, class TV>
   shared_ptr<BaseSparseMatrix>
   SparseMatrixSymmetric<TM,TV> :: Restrict (const SparseMatrixTM<double> & prol,
@@ -162,6 +162,8 @@ namespace ngla
     /// sparse direct solver
     mutable INVERSETYPE inversetype = default_inversetype;    // C++11 :-) Windows VS2013
     bool spd = false;
+    /// computes coordinates of dofs, used for geometric nested dissection
+    function<Array<Vec<3>>()> dofcoordinates;
     
   public:
     BaseSparseMatrix (int as, int max_elsperrow)
@@ -182,7 +184,7 @@ namespace ngla
     { ; }   
 
     BaseSparseMatrix (const BaseSparseMatrix & amat)
-      : BaseMatrix(amat), MatrixGraph (amat, 0)
+      : BaseMatrix(amat), MatrixGraph (amat, 0), dofcoordinates(amat.dofcoordinates)
     { ; }   
 
     virtual ~BaseSparseMatrix ();
@@ -232,6 +234,14 @@ namespace ngla
       throw Exception ("BaseSparseMatrix::Restrict");
     }
 
+    /// y += s A x computed only for the given rows (exactly)
+    virtual bool SupportsMultAddRows () const { return false; }
+    virtual void MultAddRows (double s, const BaseVector & x, BaseVector & y,
+                              FlatArray<int> rows) const
+    {
+      throw Exception ("BaseSparseMatrix::MultAddRows");
+    }
+
     virtual INVERSETYPE SetInverseType ( INVERSETYPE ainversetype ) const override
     {
 
@@ -247,6 +257,11 @@ namespace ngla
 
     void SetSPD (bool aspd = true) { spd = aspd; }
     bool IsSPD () const { return spd; }
+
+    /// coordinates are computed on demand
+    void SetDofCoordinates (function<Array<Vec<3>>()> acoords) { dofcoordinates = acoords; }
+    Array<Vec<3>> GetDofCoordinates () const
+    { return dofcoordinates ? dofcoordinates() : Array<Vec<3>>(); }
     virtual size_t NZE () const override { return nze; }
   };
 
@@ -342,6 +357,14 @@ namespace ngla
     virtual void AddElementMatrixSymmetric(FlatArray<int> dnums,
                                            BareSliceMatrix<TSCAL> elmat,
                                            bool use_atomic = false);
+
+    /// positions of element matrix entries (i,j) in data, max size_t for skipped entries
+    void GetElementPositions (FlatArray<int> dnums1, FlatArray<int> dnums2,
+                              FlatArray<size_t> pos, bool lower_only) const;
+
+    /// add element matrix at positions from GetElementPositions
+    void AddElementMatrixPositions (FlatArray<size_t> pos, size_t h, size_t w,
+                                    BareSliceMatrix<TSCAL> elmat, bool use_atomic = false);
     
     virtual BaseVector & AsVector() 
     {
@@ -467,6 +490,10 @@ namespace ngla
     virtual void MultAdd1 (double s, const BaseVector & x, BaseVector & y,
 			   const BitArray * ainner = NULL,
 			   const Array<int> * acluster = NULL) const override;
+
+    virtual bool SupportsMultAddRows () const override { return true; }
+    virtual void MultAddRows (double s, const BaseVector & x, BaseVector & y,
+                              FlatArray<int> rows) const override;
     
     virtual void DoArchive (Archive & ar) override;
   };
@@ -638,8 +665,9 @@ namespace ngla
     virtual void MultAdd2 (double s, const BaseVector & x, BaseVector & y,
 			   const BitArray * ainner = NULL,
 			   const Array<int> * acluster = NULL) const override;
-    
 
+    /// only the lower triangle is stored, rows are not independent
+    virtual bool SupportsMultAddRows () const override { return false; }
 
 
 
@@ -680,6 +708,79 @@ namespace ngla
     virtual shared_ptr<BaseMatrix> InverseMatrix (shared_ptr<const Array<int>> clusters) const override;
   };
 
+
+
+  /**
+     A real sparse matrix with values stored in single precision.
+     Products are accumulated in double precision, vectors are double.
+     Built from an assembled double matrix, and used where half the
+     memory traffic is worth the rounding, e.g. inside preconditioners.
+  */
+  class NGS_DLL_HEADER SparseMatrixFloat : public BaseSparseMatrix,
+                                           public S_BaseMatrix<double>
+  {
+  protected:
+    NumaDistributedArray<float> data;
+
+  public:
+    SparseMatrixFloat (const SparseMatrixTM<double> & amat);
+    virtual ~SparseMatrixFloat ();
+
+    int Height() const { return size; }
+    int Width() const { return width; }
+    virtual int VHeight() const override { return size; }
+    virtual int VWidth() const override { return width; }
+
+    FlatArray<float> GetRowValues(int i) const
+    { return FlatArray<float> (firsti[i+1]-firsti[i], data+firsti[i]); }
+
+    /// copy values from a double matrix with the same graph
+    void Assign (const SparseMatrixTM<double> & amat);
+
+    double RowTimesVector (int row, FlatVector<double> vec) const
+    {
+      double sum = 0;
+      for (size_t j = firsti[row]; j < firsti[row+1]; j++)
+	sum += double(data[j]) * vec(colnr[j]);
+      return sum;
+    }
+
+    void AddRowTransToVector (int row, double el, FlatVector<double> vec) const
+    {
+      for (size_t j = firsti[row]; j < firsti[row+1]; j++)
+        vec(colnr[j]) += double(data[j]) * el;
+    }
+
+    virtual AutoVector CreateRowVector () const override;
+    virtual AutoVector CreateColVector () const override;
+    virtual AutoVector CreateVector () const override;
+
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    virtual ostream & Print (ostream & ost) const override;
+    virtual void MemoryUsage (Array<MemoryUsageStruct*> & mu) const override;
+  };
+
+
+  /// A symmetric sparse matrix storing the lower triangle in single precision
+  class NGS_DLL_HEADER SparseMatrixSymmetricFloat : public SparseMatrixFloat
+  {
+  public:
+    SparseMatrixSymmetricFloat (const SparseMatrixTM<double> & amat)
+      : SparseMatrixFloat (amat) { ; }
+
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override
+    {
+      MultAdd (s, x, y);
+    }
+  };
+
+  /// single precision copy of a real double matrix, keeps symmetric storage
+  NGS_DLL_HEADER shared_ptr<SparseMatrixFloat> CreateFloatMatrix (const BaseSparseMatrix & mat);
+
+
   shared_ptr<SparseMatrixTM<double>> TransposeMatrix (const SparseMatrixTM<double> & mat);
 
   shared_ptr<SparseMatrixTM<double>>
@@ -930,6 +930,81 @@ namespace ngmg
 
 
 
+  ChebyshevSmoother :: 
+  ChebyshevSmoother  (const MeshAccess & ama,
+                      const BilinearForm & abiform, const Flags & aflags)
+    : Smoother(aflags), biform(abiform)
+  {
+    degree = int (flags.GetNumFlag ("chebyshevdegree", 2));
+    ratio = flags.GetNumFlag ("chebyshevratio", 30);
+    eigensteps = int (flags.GetNumFlag ("eigensteps", 10));
+    Update();
+  }
+
+  ChebyshevSmoother :: ~ChebyshevSmoother()
+  { ; }
+
+  void ChebyshevSmoother :: Update (bool force_update)
+  {
+    static Timer t("ChebyshevSmoother::Update");
+    RegionTimer reg(t);
+
+    int nlevels = biform.GetNLevels();
+    if (nlevels <= 0) return;
+
+    // coarse levels are kept, the finest level is always recomputed
+    int startlevel = (updateall || force_update) ? 0 : min2(jac.Size(), size_t(nlevels-1));
+    jac.SetSize (nlevels);
+    cheby.SetSize (nlevels);
+
+    for (int i = startlevel; i < nlevels; i++)
+      {
+	if (!biform.GetMatrixPtr(i))
+	  {
+	    jac[i] = nullptr;
+	    cheby[i] = nullptr;
+	    continue;
+	  }
+
+	const BaseMatrix & mat = biform.GetMatrix(i);
+	jac[i] = dynamic_cast<const BaseSparseMatrix&> (mat)
+	  .CreateJacobiPrecond(biform.GetFESpace()->GetFreeDofs());
+
+	// 10% safety margin, the power iteration approaches lmax from below
+	double lmax = 1.1 * EstimateMaxEigenvalue (mat, *jac[i], eigensteps);
+	cheby[i] = make_shared<ChebyshevIteration> (mat, *jac[i], degree);
+	cheby[i] -> SetBounds (1-lmax, 1-lmax/ratio);
+      }
+  }
+
+  void ChebyshevSmoother :: PreSmooth (int level, BaseVector & u, 
+				       const BaseVector & f, int steps) const
+  {
+    cheby[level]->Smooth (u, f, steps*degree);
+  }
+
+  void ChebyshevSmoother :: PostSmooth (int level, BaseVector & u, 
+				        const BaseVector & f, int steps) const
+  {
+    // the polynomial is symmetric in D^{-1} A, same as pre-smoothing
+    cheby[level]->Smooth (u, f, steps*degree);
+  }
+
+  void ChebyshevSmoother :: 
+  Residuum (int level, BaseVector & u, 
+	    const BaseVector & f, BaseVector & d) const
+  {
+    d = f - biform.GetMatrix(level) * u;
+  }
+  
+  AutoVector ChebyshevSmoother :: CreateVector(int level) const
+  {
+    return biform.GetMatrix(level).CreateVector();
+  }
+
+
+
+
 
 
 
@@ -217,6 +217,46 @@ namespace ngmg
   };
 
 
+  /**
+     Chebyshev polynomial smoother, preconditioned by the diagonal.
+     The largest eigenvalue is estimated by power iteration in Update,
+     smoothing needs only matrix-vector products and vector updates.
+  */
+  class ChebyshevSmoother : public Smoother
+  {
+    ///
+    const BilinearForm & biform;
+    ///
+    Array<shared_ptr<BaseJacobiPrecond>> jac;
+    ///
+    Array<shared_ptr<ChebyshevIteration>> cheby;
+    /// polynomial degree per smoothing step
+    int degree;
+    /// smoothing interval is [lmax/ratio, lmax]
+    double ratio;
+    /// power iterations for the eigenvalue estimate
+    int eigensteps;
+  public:
+    ///
+    ChebyshevSmoother (const MeshAccess & ama,
+                       const BilinearForm & abiform, const Flags & aflags);
+    ///
+    virtual ~ChebyshevSmoother();
+  
+    ///
+    virtual void Update (bool force_update = 0);
+    ///
+    virtual void PreSmooth (int level, ngla::BaseVector & u, 
+			    const ngla::BaseVector & f, int steps) const;
+    ///
+    virtual void PostSmooth (int level, ngla::BaseVector & u, 
+			     const ngla::BaseVector & f, int steps) const;
+    ///
+    virtual void Residuum (int level, ngla::BaseVector & u, 
+			   const ngla::BaseVector & f, ngla::BaseVector & d) const;
+    ///
+    virtual AutoVector CreateVector(int level) const;
+  };
 
 
 
@@ -5,6 +5,14 @@
 /**************************************************************************/
 
 #include <ngstd.hpp>
+#include <zlib.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 namespace ngstd
@@ -13,81 +21,57 @@ namespace ngstd
   /* ******************* BinaryOutArchive ******************* */
   
 
-  BinaryOutArchive :: BinaryOutArchive (string filename) 
-    : BinaryOutArchive(make_shared<ofstream>(filename.c_str()))
+  BinaryOutArchive :: BinaryOutArchive (string filename, bool acompress) 
+    : BinaryOutArchive(make_shared<ofstream>(filename.c_str(), ios::binary), acompress)
   { ; }
 
   Archive & BinaryOutArchive :: operator & (double & d) 
   {
     return Write(d);
-    /*
-    fout->write(reinterpret_cast<char*>(&d), sizeof(double));
-    return *this;
-    */
   }
   
   Archive & BinaryOutArchive :: operator & (int & i)
   {
     return Write(i);
-    /*
-    fout->write(reinterpret_cast<char*>(&i), sizeof(int));
-    return *this;
-    */
   }
 
   Archive & BinaryOutArchive :: operator & (short & i)
   {
     return Write(i);
-    // fout->write(reinterpret_cast<char*>(&i), sizeof(short));
-    // return *this;
   }
   
   Archive & BinaryOutArchive :: operator & (long & i)
   {
     return Write(i);
-    // fout->write(reinterpret_cast<char*>(&i), sizeof(long));
-    // return *this;
   }
 
   Archive & BinaryOutArchive :: operator & (size_t & i)
   {
     return Write(i);
-    // fout->write(reinterpret_cast<char*>(&i), sizeof(size_t));
-    // return *this;
   }
 
   Archive & BinaryOutArchive :: operator & (unsigned char & i)
   {
     return Write(i);
-    // fout->write(reinterpret_cast<char *>(&i), sizeof(unsigned char));
-    // return *this;
   }
   
   Archive & BinaryOutArchive :: operator & (bool & b) 
   {
     return Write(b);
-    // fout->write(reinterpret_cast<char*>(&b), sizeof(bool));
-    // return *this;
   }
   
   Archive & BinaryOutArchive :: operator & (string & str)
   {
-    if (ptr > 0) FlushBuffer();    
-
     int len = str.length();
-    fout->write (reinterpret_cast<char*>(&len), sizeof(int));
-    fout->write (&str[0], len);
-    return *this;
+    Write (len);
+    return WriteBytes (&str[0], len);
   }
 
   Archive & BinaryOutArchive :: operator & (char *& str)
   {
-    if (ptr > 0) FlushBuffer();
-
     int len = strlen (str);
-    fout->write (reinterpret_cast<char*>(&len), sizeof(int));
-    fout->write (&str[0], len);
-    return *this;
+    Write (len);
+    return WriteBytes (&str[0], len);
   }
 
   
@@ -95,26 +79,86 @@ namespace ngstd
   Archive & BinaryOutArchive :: Write (T x)
   {
     if (unlikely(ptr > BUFFERSIZE-sizeof(T)))
+      FlushBuffer();
+    memcpy (&buffer[ptr], &x, sizeof(T));
+    ptr += sizeof(T);
+    return *this;
+  }
+
+  Archive & BinaryOutArchive :: WriteBytes (const void * data, size_t bytes)
+  {
+    const char * cdata = static_cast<const char*> (data);
+    if (ptr + bytes <= BUFFERSIZE)
       {
-        fout->write(&buffer[0], ptr);
-        * (T*) (&buffer[0]) = x;        
-        ptr = sizeof(T);
+        if (bytes) memcpy (&buffer[ptr], cdata, bytes);
+        ptr += bytes;
         return *this;
       }
-    * (T*) (&buffer[ptr]) = x;
-    ptr += sizeof(T);
-    return *this;
-    /*
-    fout->write(reinterpret_cast<char*>(&x), sizeof(T));
+
+    // large arrays bypass the buffer
+    FlushBuffer();
+    if (bytes < BUFFERSIZE)
+      {
+        memcpy (&buffer[0], cdata, bytes);
+        ptr = bytes;
+      }
+    else if (compress)
+      WriteBlocks (cdata, bytes);
+    else
+      fout->write (cdata, bytes);
     return *this;
-    */
+  }
+
+  /*
+    Compressed format: blocks of at most BUFFERSIZE bytes, every block
+    is preceded by its uncompressed and compressed size.
+   */
+  void BinaryOutArchive :: WriteBlocks (const char * data, size_t bytes)
+  {
+    static Timer t("BinaryOutArchive::Compress"); RegionTimer reg(t);
+
+    size_t nblocks = (bytes + BUFFERSIZE-1) / BUFFERSIZE;
+    size_t bound = compressBound (BUFFERSIZE);
+    // compress groups of blocks in parallel, and write them in order
+    size_t ngroup = min2 (nblocks, size_t(4*TaskManager::GetNumThreads()));
+    Array<char> zbuffer(ngroup*bound);
+    Array<uint64_t> sizes(2*ngroup);
+
+    for (size_t first = 0; first < nblocks; first += ngroup)
+      {
+        size_t nb = min2 (ngroup, nblocks-first);
+        atomic<bool> failed(false);
+        ParallelFor (nb, [&] (size_t i)
+                     {
+                       size_t start = (first+i) * BUFFERSIZE;
+                       size_t rawsize = min2 (size_t(BUFFERSIZE), bytes-start);
+                       uLongf zsize = bound;
+                       if (compress2 (reinterpret_cast<Bytef*> (&zbuffer[i*bound]), &zsize,
+                                      reinterpret_cast<const Bytef*> (data+start), rawsize,
+                                      Z_BEST_SPEED) != Z_OK)
+                         failed = true;
+                       sizes[2*i] = rawsize;
+                       sizes[2*i+1] = zsize;
+                     });
+        if (failed)
+          throw Exception ("BinaryOutArchive: compression failed");
+
+        for (size_t i = 0; i < nb; i++)
+          {
+            fout->write (reinterpret_cast<char*> (&sizes[2*i]), 2*sizeof(uint64_t));
+            fout->write (&zbuffer[i*bound], sizes[2*i+1]);
+          }
+      }
   }
 
   void BinaryOutArchive :: FlushBuffer()
   {
     if (ptr > 0)
       {
-        fout->write(&buffer[0], ptr);
+        if (compress)
+          WriteBlocks (&buffer[0], ptr);
+        else
+          fout->write(&buffer[0], ptr);
         ptr = 0;
       }
   }
@@ -124,96 +168,196 @@ namespace ngstd
   /* ******************* BinaryInArchive ******************* */
 
 
-  BinaryInArchive :: BinaryInArchive (string filename) 
-    : BinaryInArchive(make_shared<ifstream>(filename.c_str())) { ; }
-  // { fin = make_shared<ifstream>(filename.c_str()); }
+  BinaryInArchive :: BinaryInArchive (string filename, bool acompressed) 
+    : Archive(false), compressed(acompressed)
+  {
+#ifndef WIN32
+    int fd = open (filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw Exception ("BinaryInArchive: cannot open '"+filename+"'");
+    struct stat st;
+    if (fstat (fd, &st) == 0 && st.st_size > 0)
+      {
+        mapped = mmap (nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+          {
+            mapped = nullptr;
+            close (fd);
+            throw Exception ("BinaryInArchive: cannot map '"+filename+"'");
+          }
+        madvise (mapped, st.st_size, MADV_SEQUENTIAL);
+        mem = static_cast<const char*> (mapped);
+        memsize = st.st_size;
+      }
+    close (fd);
+    if (!compressed)
+      {
+        data = mem;
+        size = memsize;
+      }
+#else
+    fin = make_shared<ifstream>(filename.c_str(), ios::binary);
+    if (!*fin)
+      throw Exception ("BinaryInArchive: cannot open '"+filename+"'");
+#endif
+  }
+
+  BinaryInArchive :: BinaryInArchive (FlatArray<char> amem, bool acompressed)
+    : Archive(false), mem(amem+0), memsize(amem.Size()), compressed(acompressed)
+  {
+    if (!compressed)
+      {
+        data = mem;
+        size = memsize;
+      }
+  }
+
+  BinaryInArchive :: ~BinaryInArchive ()
+  {
+#ifndef WIN32
+    if (mapped)
+      munmap (mapped, memsize);
+#endif
+  }
 
   Archive & BinaryInArchive :: operator & (double & d) 
   {
-    fin->read(reinterpret_cast<char*>(&d), sizeof(double));
-    return *this;
+    return Read(d);
   }
   
   Archive & BinaryInArchive :: operator & (int & i)
   {
-    fin->read(reinterpret_cast<char*>(&i), sizeof(int));
-    return *this;
+    return Read(i);
   }
 
   Archive & BinaryInArchive :: operator & (short & i)
   {
-    fin->read(reinterpret_cast<char*>(&i), sizeof(short));
-    return *this;
+    return Read(i);
   }
 
   Archive & BinaryInArchive :: operator & (long & i)
   {
-    fin->read(reinterpret_cast<char*>(&i), sizeof(long));
-    return *this;
+    return Read(i);
   }
 
   Archive & BinaryInArchive :: operator & (size_t & i)
   {
-    fin->read(reinterpret_cast<char*>(&i), sizeof(size_t));
-    return *this;
+    return Read(i);
   }
   
   Archive & BinaryInArchive :: operator & (unsigned char & i)
   {
-    fin->read(reinterpret_cast<char *>(&i), sizeof(unsigned char));
-    return *this;
+    return Read(i);
   }
   
   Archive & BinaryInArchive :: operator & (bool & b) 
   {
-    fin->read(reinterpret_cast<char*>(&b), sizeof(bool));
-    return *this;
+    return Read(b);
   }
   
   Archive & BinaryInArchive :: operator & (string & str) 
   {
     int len;
-    fin->read(reinterpret_cast<char*>(&len), sizeof(int));
+    Read (len);
     str.resize(len);
-    fin->read(&str[0], len);
-    return *this;
+    return ReadBytes (&str[0], len);
   }
 
   Archive & BinaryInArchive :: operator & (char *& str) 
   {
     int len;
-    fin->read(reinterpret_cast<char*>(&len), sizeof(int));
+    Read (len);
     str = new char[len+1];
-    fin->read(&str[0], len);
+    ReadBytes (&str[0], len);
     str[len] = '\0';
     return *this;
   }
 
-
-  Archive & BinaryInArchive :: Do (double * d, size_t n) 
+  Archive & BinaryInArchive :: ReadBytes (void * dst, size_t bytes)
   {
-    cout << "load double array, size = " << n << endl;
-    fin->read(reinterpret_cast<char*>(d), n*sizeof(double));
+    char * cdst = static_cast<char*> (dst);
+    while (bytes > 0)
+      {
+        if (pos == size)
+          {
+            // large arrays are read directly from an uncompressed stream
+            if (fin && !compressed && bytes >= BUFFERSIZE)
+              {
+                fin->read (cdst, bytes);
+                if (size_t(fin->gcount()) != bytes)
+                  throw Exception ("BinaryInArchive: unexpected end of input");
+                return *this;
+              }
+            if (!Refill())
+              throw Exception ("BinaryInArchive: unexpected end of input");
+          }
+        size_t n = min2 (bytes, size-pos);
+        memcpy (cdst, data+pos, n);
+        pos += n;
+        cdst += n;
+        bytes -= n;
+      }
     return *this;
   }
 
-  Archive & BinaryInArchive :: Do (int * i, size_t n) 
+  size_t BinaryInArchive :: ReadSource (char * dst, size_t bytes)
   {
-    cout << "load int array, size = " << n << endl;
-    fin->read(reinterpret_cast<char*>(i), n*sizeof(int));
-    return *this;
+    if (fin)
+      {
+        fin->read (dst, bytes);
+        return fin->gcount();
+      }
+    size_t n = min2 (bytes, memsize-mempos);
+    memcpy (dst, mem+mempos, n);
+    mempos += n;
+    return n;
   }
 
-  Archive & BinaryInArchive :: Do (size_t * i, size_t n) 
+  bool BinaryInArchive :: Refill ()
   {
-    cout << "load size_t array, size = " << n << endl;
-    fin->read(reinterpret_cast<char*>(i), n*sizeof(size_t));
-    return *this;
-  }
-
+    if (!compressed)
+      {
+        // memory source is available as a whole
+        if (!fin) return false;
+        buffer.SetSize (BUFFERSIZE);
+        fin->read (&buffer[0], BUFFERSIZE);
+        data = &buffer[0];
+        size = fin->gcount();
+        pos = 0;
+        return size > 0;
+      }
 
+    uint64_t sizes[2];
+    if (ReadSource (reinterpret_cast<char*> (&sizes[0]), sizeof(sizes)) != sizeof(sizes))
+      return false;
 
+    const Bytef * zdata;
+    if (fin)
+      {
+        zbuffer.SetSize (sizes[1]);
+        if (ReadSource (&zbuffer[0], sizes[1]) != sizes[1])
+          return false;
+        zdata = reinterpret_cast<const Bytef*> (&zbuffer[0]);
+      }
+    else
+      {
+        // decompress directly from the mapped memory
+        if (mempos + sizes[1] > memsize)
+          return false;
+        zdata = reinterpret_cast<const Bytef*> (mem+mempos);
+        mempos += sizes[1];
+      }
 
+    buffer.SetSize (sizes[0]);
+    uLongf rawsize = sizes[0];
+    if (uncompress (reinterpret_cast<Bytef*> (&buffer[0]), &rawsize, zdata, sizes[1]) != Z_OK
+        || rawsize != sizes[0])
+      throw Exception ("BinaryInArchive: corrupt compressed block");
+    data = &buffer[0];
+    size = rawsize;
+    pos = 0;
+    return size > 0;
+  }
 
 
 
@@ -51,19 +51,28 @@ namespace ngstd
   };
 
 
+  /**
+     Binary output archive. Values are collected in a large buffer,
+     arrays are written in bulk. With compress = true the data is
+     written as zlib (fast level) compressed blocks, large arrays are
+     compressed block-parallel.
+  */
   class BinaryOutArchive : public Archive
   {
     shared_ptr<ostream> fout;
     size_t ptr = 0;
-    enum { BUFFERSIZE = 1024 };
-    char buffer[BUFFERSIZE];
+    enum { BUFFERSIZE = 1 << 20 };
+    Array<char> buffer;
+    bool compress;
   public:
-    BinaryOutArchive (string filename);
-    BinaryOutArchive (shared_ptr<ostream> afout) : Archive(true), fout(afout) { ; }
+    BinaryOutArchive (string filename, bool acompress = false);
+    BinaryOutArchive (shared_ptr<ostream> afout, bool acompress = false)
+      : Archive(true), fout(afout), buffer(BUFFERSIZE), compress(acompress) { ; }
     virtual ~BinaryOutArchive () { FlushBuffer(); }
     // virtual bool Output ();
     // virtual bool Input ();
 
+    using Archive::operator&;
     virtual Archive & operator & (double & d);
     virtual Archive & operator & (int & i);
     virtual Archive & operator & (short & i);
@@ -74,22 +83,53 @@ namespace ngstd
     virtual Archive & operator & (string & str);
     virtual Archive & operator & (char *& str);
 
+    virtual Archive & Do (double * d, size_t n) { return WriteBytes (d, n*sizeof(double)); }
+    virtual Archive & Do (int * i, size_t n) { return WriteBytes (i, n*sizeof(int)); }
+    virtual Archive & Do (long * i, size_t n) { return WriteBytes (i, n*sizeof(long)); }
+    virtual Archive & Do (size_t * i, size_t n) { return WriteBytes (i, n*sizeof(size_t)); }
+    virtual Archive & Do (short * i, size_t n) { return WriteBytes (i, n*sizeof(short)); }
+    virtual Archive & Do (unsigned char * i, size_t n) { return WriteBytes (i, n); }
+    virtual Archive & Do (bool * b, size_t n) { return WriteBytes (b, n*sizeof(bool)); }
+
     template <typename T>
     Archive & Write (T x);
+    Archive & WriteBytes (const void * data, size_t bytes);
     void FlushBuffer();
+  private:
+    void WriteBlocks (const char * data, size_t bytes);
   };
 
 
+  /**
+     Binary input archive, reading from a buffered stream, from memory,
+     or from a memory mapped file. compressed has to match the output
+     archive.
+  */
   class BinaryInArchive : public Archive
   {
     shared_ptr<istream> fin;
+    /// memory source (memory or mapped file)
+    const char * mem = nullptr;
+    size_t memsize = 0, mempos = 0;
+    void * mapped = nullptr;
+    /// current data: the memory source, or the buffer
+    const char * data = nullptr;
+    size_t size = 0, pos = 0;
+    enum { BUFFERSIZE = 1 << 20 };
+    Array<char> buffer, zbuffer;
+    bool compressed;
   public:
-    BinaryInArchive (string filename);
-    BinaryInArchive (shared_ptr<istream> afin) : Archive(false), fin(afin) { ; }
+    BinaryInArchive (string filename, bool acompressed = false);
+    BinaryInArchive (shared_ptr<istream> afin, bool acompressed = false)
+      : Archive(false), fin(afin), compressed(acompressed) { ; }
+    /// read from memory, which has to stay valid
+    BinaryInArchive (FlatArray<char> amem, bool acompressed = false);
+    virtual ~BinaryInArchive ();
 
     // virtual bool Output ();
     // virtual bool Input ();
 
+    using Archive::operator&;
     virtual Archive & operator & (double & d);
     virtual Archive & operator & (int & i);
     virtual Archive & operator & (short & i);
@@ -100,10 +140,29 @@ namespace ngstd
     virtual Archive & operator & (string & str);
     virtual Archive & operator & (char *& str);
 
-    virtual Archive & Do (double * d, size_t n); 
-    virtual Archive & Do (int * i, size_t n); 
-    virtual Archive & Do (size_t * i, size_t n); 
+    virtual Archive & Do (double * d, size_t n) { return ReadBytes (d, n*sizeof(double)); }
+    virtual Archive & Do (int * i, size_t n) { return ReadBytes (i, n*sizeof(int)); }
+    virtual Archive & Do (long * i, size_t n) { return ReadBytes (i, n*sizeof(long)); }
+    virtual Archive & Do (size_t * i, size_t n) { return ReadBytes (i, n*sizeof(size_t)); }
+    virtual Archive & Do (short * i, size_t n) { return ReadBytes (i, n*sizeof(short)); }
+    virtual Archive & Do (unsigned char * i, size_t n) { return ReadBytes (i, n); }
+    virtual Archive & Do (bool * b, size_t n) { return ReadBytes (b, n*sizeof(bool)); }
 
+    template <typename T>
+    Archive & Read (T & x)
+    {
+      if (likely(pos + sizeof(T) <= size))
+        {
+          memcpy (&x, data+pos, sizeof(T));
+          pos += sizeof(T);
+          return *this;
+        }
+      return ReadBytes (&x, sizeof(T));
+    }
+    Archive & ReadBytes (void * dst, size_t bytes);
+  private:
+    bool Refill ();
+    size_t ReadSource (char * dst, size_t bytes);
   };
 
 
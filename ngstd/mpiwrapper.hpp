@@ -33,6 +33,7 @@ namespace ngstd
 
   enum { MPI_TAG_CMD = 110 };
   enum { MPI_TAG_SOLVE = 1110 };
+  enum { MPI_TAG_HALO = 1120 };
 
   struct no_base_impl {};
   template <class T>
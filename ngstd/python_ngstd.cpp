@@ -408,13 +408,13 @@ void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
                            })
       */
       .def(py::init<> ([](const string & filename, bool write,
-                          bool binary) -> shared_ptr<Archive>
+                          bool binary, bool compress) -> shared_ptr<Archive>
                        {
                          if(binary) {
                            if (write)
-                             return make_shared<BinaryOutArchive> (filename);
+                             return make_shared<BinaryOutArchive> (filename, compress);
                            else
-                             return make_shared<BinaryInArchive> (filename);
+                             return make_shared<BinaryInArchive> (filename, compress);
                          }
                          else {
                            if (write)
@@ -422,7 +422,10 @@ void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
                            else
                              return make_shared<TextInArchive> (filename);
                          }
-                       }))
+                       }),
+           py::arg("filename"), py::arg("write"), py::arg("binary"), py::arg("compress")=false,
+           "binary archives are buffered, input archives are memory mapped,\n"
+           "compress=True uses zlib compressed blocks (has to match for reading)")
     .def("__and__" , [](shared_ptr<Archive> & self, Array<int> & a) 
                                          { cout << "output array" << endl;
                                            *self & a; return self; })
@@ -437,6 +440,10 @@ void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
           ;
 
   m.def("SetNumThreads", &TaskManager::SetNumThreads );
+  m.def("SetNestedParallelism", &TaskManager::SetNestedParallelism, py::arg("use"),
+        "ParallelFor inside a running task is executed by idle threads (work-stealing) instead of serially");
+  m.def("SetPinThreads", &TaskManager::SetPinThreads, py::arg("pin"),
+        "bind TaskManager workers to cores, takes effect when the TaskManager is started");
 
   // local TaskManager class to be used as context manager in Python
   class ParallelContextManager {
@@ -251,6 +251,7 @@ namespace ngstd
     void Store (double * p, SIMD<mask64,1> mask) { if (mask.Data()) *p = data; }
     
     double operator[] (int i) const { return ((double*)(&data))[i]; }
+    double & operator[] (int i) { return ((double*)(&data))[i]; }
     double Data() const { return data; }
     double & Data() { return data; }
   };
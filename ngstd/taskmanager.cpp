@@ -6,6 +6,9 @@
 
 #include <ngstd.hpp>
 #include <thread>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 #include "taskmanager.hpp"
 #include "paje_interface.hpp"
@@ -50,9 +53,53 @@ namespace ngstd
 
   TaskManager::NodeData *TaskManager::nodedata[8];
   int TaskManager::num_nodes;
+
+  TaskManager::WorkDeque ** TaskManager::deques = nullptr;
+  bool TaskManager::nested_parallel = getenv("NGS_NESTED_TASKS") && atoi(getenv("NGS_NESTED_TASKS"));
+  bool TaskManager::pin_threads = getenv("NGS_PIN_THREADS") && atoi(getenv("NGS_PIN_THREADS"));
+
+  // depth of the job the thread is working on, -1 for none
+  static thread_local int job_depth = -1;
   
   static mutex copyex_mutex;
 
+
+  /*
+    A job created from inside a running task. The owner works on it
+    first, idle threads and threads waiting for deeper jobs join in.
+   */
+  class TaskManager::NestedJob
+  {
+  public:
+    const function<void(TaskInfo&)> * func;
+    int ntasks;
+    int depth;
+    atomic<int> next{0};
+    atomic<int> participants{0};
+    Exception * ex = nullptr;
+  };
+
+  /*
+    Stack of the nested jobs created by one thread. The owner pushes
+    and pops at the top, thieves look at the oldest (biggest) jobs
+    first, and join a job instead of removing it.
+   */
+  class alignas(64) TaskManager::WorkDeque : public AlignedAlloc<TaskManager::WorkDeque>
+  {
+    atomic<bool> locked{false};
+  public:
+    enum { MAXJOBS = 64 };
+    atomic<int> size{0};
+    NestedJob * jobs[MAXJOBS];
+
+    void Lock()
+    {
+      while (locked.exchange(true, memory_order_acquire))
+        _mm_pause();
+    }
+    void Unlock() { locked.store(false, memory_order_release); }
+  };
+
   int EnterTaskManager ()
   {
     if (task_manager)
@@ -141,6 +188,17 @@ namespace ngstd
       workers_on_node[0] = 0;
 #endif
 
+      deques = new WorkDeque*[num_threads];
+      for (int i = 0; i < num_threads; i++)
+        {
+#ifdef USE_NUMA
+          void * mem = numa_alloc_onnode (sizeof(WorkDeque), num_nodes*i/num_threads);
+          deques[i] = new (mem) WorkDeque;
+#else
+          deques[i] = new WorkDeque;
+#endif
+        }
+
       jobnr = 0;
       done = 0;
       sleep = false;
@@ -168,6 +226,17 @@ namespace ngstd
   {
     delete trace;
     trace = nullptr;
+    for (int i = 0; i < num_threads; i++)
+      {
+#ifdef USE_NUMA
+        deques[i]->~WorkDeque();
+        numa_free (deques[i], sizeof(WorkDeque));
+#else
+        delete deques[i];
+#endif
+      }
+    delete [] deques;
+    deques = nullptr;
     num_threads = 1;
   }
 
@@ -238,6 +307,13 @@ namespace ngstd
   {
     if (num_threads == 1 || !task_manager || func)
       {
+        if (func && nested_parallel && task_manager && num_threads > 1 && antasks > 1 &&
+            deques[thread_id]->size < WorkDeque::MAXJOBS)
+          {
+            CreateNestedJob (afunc, antasks);
+            return;
+          }
+        
         if (startup_function) (*startup_function)();
         
         TaskInfo ti;
@@ -282,6 +358,7 @@ namespace ngstd
     // ti.nnodes = num_nodes;
     // ti.node_nr = mynode;
 
+    job_depth = 0;
     try
       {
         while (1)
@@ -308,6 +385,7 @@ namespace ngstd
           mynode_data.start_cnt = mytasks.Size();
         }
       }
+    job_depth = -1;
 
     if (cleanup_function) (*cleanup_function)();
     
@@ -315,7 +393,8 @@ namespace ngstd
       if (workers_on_node[j])
         {
           while (complete[j] != jobnr)
-            _mm_pause();
+            if (!nested_parallel || !StealWork(-1))
+              _mm_pause();
         }
 
     func = nullptr;
@@ -355,6 +434,15 @@ namespace ngstd
       
 #ifdef USE_NUMA
     numa_run_on_node (mynode);
+#endif
+#ifdef __linux__
+    if (pin_threads)
+      {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(thd % std::thread::hardware_concurrency(), &cpuset);
+        pthread_setaffinity_np (pthread_self(), sizeof(cpu_set_t), &cpuset);
+      }
 #endif
     active_workers++;
     workers_on_node[mynode]++;
@@ -374,7 +462,9 @@ namespace ngstd
 
         if (jobnr == jobdone)
           {
-            // RegionTracer t(ti.thread_nr, tCASyield, ti.task_nr);            
+            // RegionTracer t(ti.thread_nr, tCASyield, ti.task_nr);
+            if (nested_parallel && StealWork(-1))
+              continue;
             if(sleep)
               this_thread::sleep_for(chrono::microseconds(sleep_usecs));
             else
@@ -405,7 +495,8 @@ namespace ngstd
         if (startup_function) (*startup_function)();
         
         IntRange mytasks = Range(int(ntasks)).Split (mynode, num_nodes);
-          
+
+        job_depth = 0;
         try
           {
             
@@ -435,6 +526,7 @@ namespace ngstd
               mynode_data.start_cnt = mytasks.Size();
             }
           }
+        job_depth = -1;
 
 #ifndef __MIC__
         atomic_thread_fence (memory_order_release);     
@@ -474,6 +566,293 @@ namespace ngstd
   }
 
 
+  void TaskManager :: CreateNestedJob (const function<void(TaskInfo&)> & afunc,
+                                       int antasks)
+  {
+    WorkDeque & mydeque = *deques[thread_id];
+
+    NestedJob job;
+    job.func = &afunc;
+    job.ntasks = antasks;
+    job.depth = job_depth+1;
+
+    mydeque.Lock();
+    mydeque.jobs[mydeque.size] = &job;
+    mydeque.size++;
+    mydeque.Unlock();
+
+    ProcessNestedJob (job);
+
+    // all tasks are taken, own job is on top of the stack
+    mydeque.Lock();
+    mydeque.size--;
+    mydeque.Unlock();
+
+    // wait for the helpers, and help with deeper jobs meanwhile
+    while (job.participants > 0)
+      if (!StealWork (job_depth))
+        _mm_pause();
+
+    if (job.ex)
+      {
+        Exception e(*job.ex);
+        delete job.ex;
+        throw e;
+      }
+  }
+
+  void TaskManager :: ProcessNestedJob (NestedJob & job)
+  {
+    TaskInfo ti;
+    ti.nthreads = GetNumThreads();
+    ti.thread_nr = thread_id;
+    ti.ntasks = job.ntasks;
+
+    int olddepth = job_depth;
+    job_depth = job.depth;
+    while (1)
+      {
+        if (job.next >= job.ntasks) break;
+        int mytask = job.next++;
+        if (mytask >= job.ntasks) break;
+
+        ti.task_nr = mytask;
+        try
+          {
+            RegionTracer t(ti.thread_nr, jobnr, RegionTracer::ID_JOB, ti.task_nr);
+            (*job.func)(ti);
+          }
+        catch (Exception e)
+          {
+            lock_guard<mutex> guard(copyex_mutex);
+            if (!job.ex)
+              job.ex = new Exception (e);
+            job.next = job.ntasks;
+          }
+        catch (const std::exception & e)
+          {
+            lock_guard<mutex> guard(copyex_mutex);
+            if (!job.ex)
+              job.ex = new Exception (e.what());
+            job.next = job.ntasks;
+          }
+        catch (...)
+          {
+            // the owner waits for all participants, so nothing may escape
+            lock_guard<mutex> guard(copyex_mutex);
+            if (!job.ex)
+              job.ex = new Exception ("unknown exception in nested parallel job");
+            job.next = job.ntasks;
+          }
+      }
+    job_depth = olddepth;
+  }
+
+  bool TaskManager :: StealWork (int mydepth)
+  {
+    // a thread only joins jobs deeper than its own, so it never
+    // interleaves two tasks of the same job
+    int thds = GetNumThreads();
+    int me = thread_id;
+    int mynode = num_nodes * me / thds;
+
+    for (int k = 0; k < num_nodes; k++)
+      {
+        int node = (mynode+k) % num_nodes;
+        for (int i = 1; i < thds; i++)
+          {
+            int victim = (me+i) % thds;
+            if (num_nodes * victim / thds != node) continue;
+
+            WorkDeque & dq = *deques[victim];
+            if (dq.size == 0) continue;   // fast check without lock
+
+            NestedJob * job = nullptr;
+            dq.Lock();
+            for (int j = 0; j < dq.size; j++)
+              {
+                NestedJob * cand = dq.jobs[j];
+                if (cand->depth > mydepth && cand->next < cand->ntasks)
+                  {
+                    job = cand;
+                    job->participants++;
+                    break;
+                  }
+              }
+            dq.Unlock();
+
+            if (job)
+              {
+                // an idle thread runs the job like a regular task
+                if (mydepth < 0 && startup_function) (*startup_function)();
+                ProcessNestedJob (*job);
+                job->participants--;
+                if (mydepth < 0 && cleanup_function) (*cleanup_function)();
+                return true;
+              }
+          }
+      }
+    return false;
+  }
+
+
+  /*
+    Ready tasks are published in a list of slots, idle threads claim
+    the slots in order. A finished task continues with one of the
+    successors it made ready, the others are published.
+   */
+  template <typename TSUCC, typename TFUNC>
+  static void T_RunParallelDependency (FlatArray<int> npred, TSUCC successors, TFUNC func)
+  {
+    size_t n = npred.Size();
+    if (n == 0) return;
+
+    Array<atomic<int>> cnt_dep(n);
+    Array<atomic<int>> published(n);
+    Array<int> ready(n);
+    size_t ninit = 0;
+    for (size_t i = 0; i < n; i++)
+      {
+        cnt_dep[i].store (npred[i], memory_order_relaxed);
+        published[i].store (0, memory_order_relaxed);
+        if (npred[i] == 0)
+          {
+            ready[ninit] = i;
+            published[ninit].store (1, memory_order_relaxed);
+            ninit++;
+          }
+      }
+    if (ninit == 0)
+      throw Exception ("RunParallelDependency: graph has no start node");
+
+    atomic<size_t> nready(ninit), nclaimed(0), ndone(0);
+    atomic<bool> failed(false);
+    Exception * ex = nullptr;
+
+    ParallelJob
+      ([&] (TaskInfo & ti)
+       {
+         int local = -1;
+         while (1)
+           {
+             int nr = local;
+             local = -1;
+             if (nr == -1)
+               {
+                 if (ndone >= n) return;
+                 size_t slot = nclaimed++;
+                 if (slot >= n) return;
+                 // slots not needed because of continuations are never published
+                 while (!published[slot].load(memory_order_acquire))
+                   {
+                     if (ndone >= n) return;
+                     _mm_pause();
+                   }
+                 nr = ready[slot];
+               }
+
+             if (!failed)
+               {
+                 try
+                   {
+                     func(nr);
+                   }
+                 catch (Exception e)
+                   {
+                     lock_guard<mutex> guard(copyex_mutex);
+                     if (!ex) ex = new Exception (e);
+                     failed = true;
+                   }
+                 catch (const std::exception & e)
+                   {
+                     lock_guard<mutex> guard(copyex_mutex);
+                     if (!ex) ex = new Exception (e.what());
+                     failed = true;
+                   }
+                 catch (...)
+                   {
+                     // the other workers wait for the successors, so nothing may escape
+                     lock_guard<mutex> guard(copyex_mutex);
+                     if (!ex) ex = new Exception ("unknown exception in task graph");
+                     failed = true;
+                   }
+               }
+
+             // successors are released also after a failure, to drain the graph
+             for (int j : successors(nr))
+               if (--cnt_dep[j] == 0)
+                 {
+                   if (local == -1)
+                     local = j;
+                   else
+                     {
+                       size_t slot = nready++;
+                       ready[slot] = j;
+                       published[slot].store (1, memory_order_release);
+                     }
+                 }
+             ndone++;
+           }
+       });
+
+    if (ex)
+      {
+        Exception e(*ex);
+        delete ex;
+        throw e;
+      }
+  }
+
+  void RunParallelDependency (const FlatTable<int> & dag,
+                              const FlatTable<int> & trans_dag,
+                              const function<void(int)> & func)
+  {
+    Array<int> npred(trans_dag.Size());
+    for (size_t i = 0; i < npred.Size(); i++)
+      npred[i] = trans_dag[i].Size();
+    T_RunParallelDependency (npred, [&dag] (int i) { return dag[i]; }, func);
+  }
+
+
+  int TaskGraph :: AddTask (function<void()> func, FlatArray<int> predecessors)
+  {
+    int nr = tasks.Size();
+    for (int p : predecessors)
+      if (p < 0 || p >= nr)
+        throw Exception ("TaskGraph::AddTask: predecessor "+ToString(p)+" is not a previous task");
+    tasks.Append (func);
+    for (int p : predecessors)
+      deps.Append (p);
+    firstdep.Append (deps.Size());
+    return nr;
+  }
+
+  void TaskGraph :: Run () const
+  {
+    size_t n = tasks.Size();
+    Array<int> npred(n), firstsucc(n+1), succ(deps.Size());
+
+    firstsucc = 0;
+    for (int p : deps)
+      firstsucc[p+1]++;
+    for (size_t i = 0; i < n; i++)
+      {
+        npred[i] = firstdep[i+1]-firstdep[i];
+        firstsucc[i+1] += firstsucc[i];
+      }
+
+    Array<int> cnt(n);
+    cnt = 0;
+    for (size_t i = 0; i < n; i++)
+      for (int p : deps.Range(firstdep[i], firstdep[i+1]))
+        succ[firstsucc[p] + cnt[p]++] = i;
+
+    T_RunParallelDependency (npred,
+                             [&] (int i) { return succ.Range(firstsucc[i], firstsucc[i+1]); },
+                             [this] (int i) { tasks[i](); });
+  }
+
+
   list<tuple<string,double>> TaskManager :: Timing ()
   {
     /*
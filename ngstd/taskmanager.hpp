@@ -60,6 +60,13 @@ namespace ngstd
 
     static NodeData *nodedata[8];
 
+    /// nested jobs published for stealing, one stack per thread
+    class NestedJob;
+    class WorkDeque;
+    static WorkDeque ** deques;
+    static bool nested_parallel;
+    static bool pin_threads;
+
     static int num_nodes;
     NGS_DLL_HEADER static int num_threads;
     NGS_DLL_HEADER static int max_threads;
@@ -97,6 +104,12 @@ namespace ngstd
     int GetNumNodes() const { return num_nodes; }
 
     static void SetPajeTrace (bool use)  { use_paje_trace = use; }
+
+    /// run ParallelFor inside a running job with all idle workers (default: serial)
+    static void SetNestedParallelism (bool use) { nested_parallel = use; }
+    static bool GetNestedParallelism () { return nested_parallel; }
+    /// bind worker i to core i (Linux only)
+    static void SetPinThreads (bool pin) { pin_threads = pin; }
     
     NGS_DLL_HEADER static void CreateJob (const function<void(TaskInfo&)> & afunc, 
                     int antasks = task_manager->GetNumThreads());
@@ -109,6 +122,13 @@ namespace ngstd
     void Done() { done = true; }
     void Loop(int thread_num);
 
+  private:
+    static void CreateNestedJob (const function<void(TaskInfo&)> & afunc, int antasks);
+    static void ProcessNestedJob (NestedJob & job);
+    /// execute tasks of some nested job deeper than mydepth, preferring the own NUMA node
+    static bool StealWork (int mydepth);
+  public:
+
     static list<tuple<string,double>> Timing ();
   };
 
@@ -770,6 +790,50 @@ public:
 
   
 
+  template <class T> class FlatTable;
+
+  /**
+     Calls func(i) for all nodes i of a directed acyclic graph, as soon
+     as all predecessors of i are finished. dag[i] are the successors,
+     trans_dag[i] the predecessors of node i.
+  */
+  NGS_DLL_HEADER void RunParallelDependency (const FlatTable<int> & dag,
+                                             const FlatTable<int> & trans_dag,
+                                             const function<void(int)> & func);
+
+  /*
+    Tasks with dependencies, no barriers between phases:
+
+      TaskGraph graph;
+      int a = graph.AddTask ([&] () { ... });
+      int b = graph.AddTask ([&] () { ... });
+      graph.AddTask ([&] () { ... }, { a, b });   // after a and b
+      graph.Run();
+
+    A task can only wait for tasks added before, so the graph is
+    acyclic. A graph can be run several times.
+  */
+  class NGS_DLL_HEADER TaskGraph
+  {
+    Array<function<void()>> tasks;
+    /// predecessors of task i are deps[firstdep[i]] ... deps[firstdep[i+1]-1]
+    Array<int> firstdep;
+    Array<int> deps;
+  public:
+    TaskGraph () { firstdep.Append(0); }
+
+    size_t Size() const { return tasks.Size(); }
+
+    int AddTask (function<void()> func) { return AddTask (func, FlatArray<int>(0, nullptr)); }
+    int AddTask (function<void()> func, initializer_list<int> predecessors)
+    { return AddTask (func, Array<int>(predecessors)); }
+    int AddTask (function<void()> func, FlatArray<int> predecessors);
+
+    void Run () const;
+  };
+
+
+
   //  some suggar for working with arrays 
 
   template <typename T> template <typename T2>
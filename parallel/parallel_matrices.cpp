@@ -359,8 +359,50 @@ namespace ngla
     ; // delete &mat;
   }
 
+  void ParallelMatrix :: SplitRows () const
+  {
+    if (rows_split) return;
+
+    auto & graph = dynamic_cast<const BaseSparseMatrix&> (*mat);
+    inner_rows.SetSize0();
+    interface_rows.SetSize0();
+    for (int i = 0; i < graph.Height(); i++)
+      {
+        bool touches_shared = false;
+        for (int j : graph.GetRowIndices(i))
+          if (paralleldofs->GetDistantProcs(j).Size())
+            {
+              touches_shared = true;
+              break;
+            }
+        if (touches_shared)
+          interface_rows.Append(i);
+        else
+          inner_rows.Append(i);
+      }
+    rows_split = true;
+  }
+
   void ParallelMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
+    static Timer t("ParallelMatrix::MultAdd - overlapped");
+
+    auto spmat = dynamic_pointer_cast<BaseSparseMatrix> (mat);
+    const ParallelBaseVector * parx = dynamic_cast_ParallelBaseVector (&x);
+    if (overlap && spmat && spmat->SupportsMultAddRows() &&
+        parx && parx->Status() == DISTRIBUTED)
+      {
+        RegionTimer reg(t);
+        SplitRows();
+
+        y.Distribute();
+        parx->StartCumulate();
+        spmat->MultAddRows (s, x, y, inner_rows);
+        parx->FinishCumulate();
+        spmat->MultAddRows (s, x, y, interface_rows);
+        return;
+      }
+
     x.Cumulate();
     y.Distribute();
     mat->MultAdd (s, x, y);
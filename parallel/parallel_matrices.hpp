@@ -40,6 +40,14 @@ namespace ngla
   {
     shared_ptr<BaseMatrix> mat;
     // const ParallelDofs & pardofs;
+
+    /// overlap the exchange of x with the product of the interior rows
+    bool overlap = false;
+    /// rows not touching / touching shared dofs, set up on first use
+    mutable Array<int> inner_rows, interface_rows;
+    mutable bool rows_split = false;
+
+    void SplitRows () const;
   public:
     ParallelMatrix (shared_ptr<BaseMatrix> amat, shared_ptr<ParallelDofs> apardofs);
     // : mat(*amat), pardofs(*apardofs) 
@@ -54,6 +62,9 @@ namespace ngla
     virtual const BaseVector & AsVector() const override { return mat->AsVector(); }
 
     shared_ptr<BaseMatrix> GetMatrix() const { return mat; }
+
+    void SetOverlap (bool aoverlap) { overlap = aoverlap; }
+    bool GetOverlap () const { return overlap; }
     virtual shared_ptr<BaseMatrix> CreateMatrix () const override;
     virtual AutoVector CreateVector () const override;
 
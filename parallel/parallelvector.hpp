@@ -23,6 +23,10 @@ namespace ngla
     mutable PARALLEL_STATUS status;
     shared_ptr<ParallelDofs> paralleldofs;    
 
+    /// exchange in flight between StartCumulate and FinishCumulate
+    mutable Array<int> cum_procs;
+    mutable Array<MPI_Request> cum_sendrequest, cum_recvrequest;
+
   public:
     ParallelBaseVector ()
     { ; }
@@ -69,6 +73,10 @@ namespace ngla
 
 
     virtual void Cumulate () const; 
+
+    /// non-blocking Cumulate: values of not exchanged dofs may be used in between
+    virtual void StartCumulate () const;
+    virtual void FinishCumulate () const;
     
     virtual void Distribute() const = 0;
     // { cerr << "ERROR -- Distribute called for BaseVector, is not parallel" << endl; }
@@ -152,6 +160,13 @@ namespace ngla
     virtual SCAL InnerProduct (const BaseVector & v2) const;
     virtual BaseVector & SetScalar (double scal)
     { return ParallelBaseVector::SetScalar(scal); }
+
+  public:
+    /// fused kernels with one reduction for all inner products
+    virtual double AddInnerProductD (double scal, const BaseVector & v, const BaseVector & w);
+    virtual void MultiInnerProductD (FlatArray<const BaseVector*> vecs, FlatVector<double> res) const;
+    virtual BaseVector & AddLinearCombination (double scal, FlatVector<double> coefs,
+                                               FlatArray<const BaseVector*> vecs);
   };
 
 
@@ -166,6 +181,8 @@ namespace ngla
     using ParallelBaseVector :: paralleldofs;
 
     Table<SCAL> * recvvalues;
+    /// halo exchange used by the running StartCumulate, if any
+    mutable HaloExchange<SCAL> * cum_halo = nullptr;
 
   public:
     // S_ParallelBaseVectorPtr (int as, int aes, void * adata) throw();
@@ -175,6 +192,8 @@ namespace ngla
     virtual void SetParallelDofs (shared_ptr<ParallelDofs> aparalleldofs, const Array<int> * procs=0 );
 
     virtual void Distribute() const;
+    virtual void StartCumulate () const;
+    virtual void FinishCumulate () const;
     virtual ostream & Print (ostream & ost) const;
 
     virtual void  IRecvVec ( int dest, MPI_Request & request );
@@ -107,33 +107,48 @@ namespace ngla
   
 
   void ParallelBaseVector :: Cumulate () const
+  {
+    if (status != DISTRIBUTED) return;
+    StartCumulate();
+    FinishCumulate();
+  }
+
+  void ParallelBaseVector :: StartCumulate () const
   {
     if (status != DISTRIBUTED) return;
     
     int ntasks = paralleldofs->GetNTasks();
-    Array<int> exprocs;
+    cum_procs.SetSize0();
     for (int i = 0; i < ntasks; i++)
       if (paralleldofs -> GetExchangeDofs (i).Size())
-	exprocs.Append(i);
+	cum_procs.Append(i);
     
-    int nexprocs = exprocs.Size();
+    int nexprocs = cum_procs.Size();
     
     ParallelBaseVector * constvec = const_cast<ParallelBaseVector * > (this);
     
-    Array<MPI_Request> sendrequest(nexprocs), recvrequest(nexprocs);
+    cum_sendrequest.SetSize(nexprocs);
+    cum_recvrequest.SetSize(nexprocs);
 
     for (int idest = 0; idest < nexprocs; idest ++ ) 
-      constvec->ISend (exprocs[idest], sendrequest[idest] );
+      constvec->ISend (cum_procs[idest], cum_sendrequest[idest] );
     for (int isender=0; isender < nexprocs; isender++)
-      constvec -> IRecvVec (exprocs[isender], recvrequest[isender] );
-    
-    MyMPI_WaitAll (sendrequest);
+      constvec -> IRecvVec (cum_procs[isender], cum_recvrequest[isender] );
+  }
+
+  void ParallelBaseVector :: FinishCumulate () const
+  {
+    if (status != DISTRIBUTED) return;
+
+    ParallelBaseVector * constvec = const_cast<ParallelBaseVector * > (this);
+
+    MyMPI_WaitAll (cum_sendrequest);
     
     // cumulate
-    for (int cntexproc=0; cntexproc < nexprocs; cntexproc++)
+    for (int cntexproc=0; cntexproc < cum_procs.Size(); cntexproc++)
       {
-	int isender = MyMPI_WaitAny (recvrequest);
-	constvec->AddRecvValues(exprocs[isender]);
+	int isender = MyMPI_WaitAny (cum_recvrequest);
+	constvec->AddRecvValues(cum_procs[isender]);
       } 
 
     SetStatus(CUMULATED);
@@ -213,6 +228,124 @@ namespace ngla
     return globalsum;
   }
 
+
+
+  template <>
+  double S_ParallelBaseVector<double> :: AddInnerProductD (double scal, const BaseVector & v,
+                                                           const BaseVector & w)
+  {
+    PARALLEL_STATUS stv = v.GetParallelStatus();
+
+    if (this->Status() == NOT_PARALLEL && stv == NOT_PARALLEL && w.GetParallelStatus() == NOT_PARALLEL)
+      return S_BaseVector<double>::AddInnerProductD (scal, v, w);
+
+    // same status for the update, as in Add
+    if (this->Status() != stv)
+      {
+        if (this->Status() == DISTRIBUTED)
+          Cumulate();
+        else
+          v.Cumulate();
+      }
+
+    // the inner product needs one cumulated and one distributed vector
+    if (this->Status() == w.GetParallelStatus())
+      return BaseVector::AddInnerProductD (scal, v, w);
+
+    double localsum = S_BaseVector<double>::AddInnerProductD (scal, v, w);
+    return MyMPI_AllReduce (localsum);
+  }
+
+  template <>
+  double S_ParallelBaseVector<Complex> :: AddInnerProductD (double scal, const BaseVector & v,
+                                                            const BaseVector & w)
+  {
+    return BaseVector::AddInnerProductD (scal, v, w);
+  }
+
+
+  template <>
+  void S_ParallelBaseVector<double> :: MultiInnerProductD (FlatArray<const BaseVector*> vecs,
+                                                           FlatVector<double> res) const
+  {
+    if (vecs.Size() == 0) return;
+
+    // all vectors of the same status, and none of them is me
+    PARALLEL_STATUS stv = vecs[0]->GetParallelStatus();
+    bool uniform = true;
+    for (auto v : vecs)
+      if (v->GetParallelStatus() != stv ||
+          dynamic_cast_ParallelBaseVector(v) == static_cast<const ParallelBaseVector*>(this))
+        uniform = false;
+
+    if (this->Status() == NOT_PARALLEL && stv == NOT_PARALLEL && uniform)
+      {
+        S_BaseVector<double>::MultiInnerProductD (vecs, res);
+        return;
+      }
+
+    if (!uniform || stv == NOT_PARALLEL)
+      {
+        BaseVector::MultiInnerProductD (vecs, res);
+        return;
+      }
+
+    if (this->Status() == stv)
+      {
+        if (stv == DISTRIBUTED)
+          Cumulate();
+        else
+          this->Distribute();
+      }
+
+    S_BaseVector<double>::MultiInnerProductD (vecs, res);
+
+    static Timer t("dummy - AllReduce");
+    RegionTimer r(t);
+    MPI_Allreduce (MPI_IN_PLACE, &res(0), vecs.Size(), MPI_DOUBLE, MPI_SUM, ngs_comm);
+  }
+
+  template <>
+  void S_ParallelBaseVector<Complex> :: MultiInnerProductD (FlatArray<const BaseVector*> vecs,
+                                                            FlatVector<double> res) const
+  {
+    BaseVector::MultiInnerProductD (vecs, res);
+  }
+
+
+  template <>
+  BaseVector & S_ParallelBaseVector<double> :: AddLinearCombination (double scal, FlatVector<double> coefs,
+                                                                     FlatArray<const BaseVector*> vecs)
+  {
+    // the result takes the status of the vectors if the old values are dropped
+    PARALLEL_STATUS st = (scal == 0 && vecs.Size()) ? vecs[0]->GetParallelStatus() : this->Status();
+    bool uniform = true;
+    for (auto v : vecs)
+      if (v->GetParallelStatus() != st)
+        uniform = false;
+
+    if (!uniform)
+      return BaseVector::AddLinearCombination (scal, coefs, vecs);
+
+    S_BaseVector<double>::AddLinearCombination (scal, coefs, vecs);
+    if (st != NOT_PARALLEL && scal == 0)
+      {
+        auto pardofs = dynamic_cast_ParallelBaseVector(*vecs[0]).GetParallelDofs();
+        if (pardofs != paralleldofs)
+          this->SetParallelDofs (pardofs);
+      }
+    this->SetStatus (st);
+    return *this;
+  }
+
+  template <>
+  BaseVector & S_ParallelBaseVector<Complex> :: AddLinearCombination (double scal, FlatVector<double> coefs,
+                                                                      FlatArray<const BaseVector*> vecs)
+  {
+    return BaseVector::AddLinearCombination (scal, coefs, vecs);
+  }
+
+
   template class S_ParallelBaseVector<double>;
   template class S_ParallelBaseVector<Complex>;
 
@@ -287,6 +420,39 @@ namespace ngla
 
 
 
+  template <typename SCAL>
+  void S_ParallelBaseVectorPtr<SCAL> :: StartCumulate () const
+  {
+    if (status != DISTRIBUTED) return;
+
+    auto & halo = paralleldofs->template GetHaloExchange<SCAL> (this->es);
+    if (halo.IsBusy())
+      {
+        // another vector is in the middle of an exchange
+        cum_halo = nullptr;
+        ParallelBaseVector::StartCumulate();
+        return;
+      }
+    cum_halo = &halo;
+    halo.Start (this->FVScal());
+  }
+
+  template <typename SCAL>
+  void S_ParallelBaseVectorPtr<SCAL> :: FinishCumulate () const
+  {
+    if (status != DISTRIBUTED) return;
+
+    if (!cum_halo)
+      {
+        ParallelBaseVector::FinishCumulate();
+        return;
+      }
+    cum_halo->FinishAdd (this->FVScal());
+    cum_halo = nullptr;
+    this->SetStatus(CUMULATED);
+  }
+
+
   template < class SCAL >
   ostream & S_ParallelBaseVectorPtr<SCAL> :: Print (ostream & ost) const
   {
@@ -31,7 +31,7 @@ namespace ngsolve
     ///
     bool print;
     ///
-    enum SOLVER { CG, GMRES, QMR/*, NCG */, SIMPLE, DIRECT, BICGSTAB };
+    enum SOLVER { CG, GMRES, QMR/*, NCG */, SIMPLE, DIRECT, BICGSTAB, PIPELINEDCG, SSTEPCG };
     ///
     enum IP_TYPE { SYMMETRIC, HERMITEAN, CONJ_HERMITEAN };
     ///
@@ -40,6 +40,8 @@ namespace ngsolve
     IP_TYPE ip_type;
     ///
     bool useseedvariant;
+    /// CG steps per reduction for the s-step CG
+    int sstep;
   public:
     ///
     NumProcBVP (shared_ptr<PDE> apde, const Flags & flags);
@@ -56,6 +58,7 @@ namespace ngsolve
       print = false;
       solver = CG;
       ip_type = SYMMETRIC;
+      sstep = 4;
     }
 
     ///
@@ -94,6 +97,10 @@ namespace ngsolve
           ost << "DIRECT" << endl; break;
 	case BICGSTAB:
 	  ost << "BiCGStab" << endl; break;
+        case PIPELINEDCG:
+          ost << "pipelined CG" << endl; break;
+        case SSTEPCG:
+          ost << "s-step CG, s = " << sstep << endl; break;
         default:
           ost << "Unknown solver-type" << endl;
         }
@@ -141,7 +148,10 @@ namespace ngsolve
       if (solvername == "simple") solver = SIMPLE;
       if (solvername == "direct") solver = DIRECT;
       if (solvername == "bicgstab") solver = BICGSTAB;
-    }       
+      if (solvername == "pipelinedcg") solver = PIPELINEDCG;
+      if (solvername == "sstepcg") solver = SSTEPCG;
+    }
+    sstep = int(flags.GetNumFlag ("sstep", 4));
     
     string ipflag = flags.GetStringFlag("innerproduct","symmetric");
     ip_type = SYMMETRIC;
@@ -177,7 +187,9 @@ namespace ngsolve
       "-gridfunction=<gfname>\n" \
       "    grid-function to store the solution vector\n" 
       "\nOptional flags:\n"\
-      "\n-solver=<solvername> (cg|qmr|gmres|direct|bicgstab)\n"\
+      "\n-solver=<solvername> (cg|pipelinedcg|sstepcg|qmr|gmres|direct|bicgstab)\n"\
+      "-sstep=s\n"\
+      "    CG steps per reduction for the s-step CG, default 4\n"\
       "-seed\n"\
       "    use seed variant for multiple rhs\n"\
       "-preconditioner=<prename>\n"
@@ -226,6 +238,18 @@ namespace ngsolve
 	    cout << IM(1) << "cg solve for real system" << endl;
 	    invmat = new CGSolver<double>(mat, *premat);
 	    break;
+          case PIPELINEDCG:
+            cout << IM(1) << "pipelined cg solve for real system" << endl;
+            invmat = new PipelinedCGSolver<double>(mat, *premat);
+            break;
+          case SSTEPCG:
+            {
+              cout << IM(1) << "s-step cg solve for real system" << endl;
+              SStepCGSolver<double> * hinv = new SStepCGSolver<double>(mat, *premat);
+              hinv -> SetSStep (sstep);
+              invmat = hinv;
+              break;
+            }
           case BICGSTAB:
 	    cout << IM(1) << "bicgstab solve for real system" << endl;
 	    invmat = new BiCGStabSolver<double>(mat, *premat);
@@ -260,6 +284,18 @@ namespace ngsolve
             cout << IM(1) << "cg solve for complex system" << endl;
             invmat = new CGSolver<Complex>(mat, *premat);
 	    break;
+          case PIPELINEDCG:
+            cout << IM(1) << "pipelined cg solve for complex system" << endl;
+            invmat = new PipelinedCGSolver<Complex>(mat, *premat);
+            break;
+          case SSTEPCG:
+            {
+              cout << IM(1) << "s-step cg solve for complex system" << endl;
+              SStepCGSolver<Complex> * hinv = new SStepCGSolver<Complex>(mat, *premat);
+              hinv -> SetSStep (sstep);
+              invmat = hinv;
+              break;
+            }
           case BICGSTAB:
 	    cout << IM(1) << "bicgstab solve for complex system" << endl;
 	    invmat = new BiCGStabSolver<Complex>(mat, *premat);
@@ -295,6 +331,18 @@ namespace ngsolve
             cout << IM(1) << "cg solve for complex system" << endl;
             invmat = new CGSolver<ComplexConjugate>(mat, *premat);
 	    break;
+          case PIPELINEDCG:
+            cout << IM(1) << "pipelined cg solve for complex system" << endl;
+            invmat = new PipelinedCGSolver<ComplexConjugate>(mat, *premat);
+            break;
+          case SSTEPCG:
+            {
+              cout << IM(1) << "s-step cg solve for complex system" << endl;
+              SStepCGSolver<ComplexConjugate> * hinv = new SStepCGSolver<ComplexConjugate>(mat, *premat);
+              hinv -> SetSStep (sstep);
+              invmat = hinv;
+              break;
+            }
           case BICGSTAB:
 	    cout << IM(1) << "bicgstab solve for complex system" << endl;
 	    invmat = new BiCGStabSolver<ComplexConjugate>(mat, *premat);
@@ -329,6 +377,18 @@ namespace ngsolve
             cout << IM(1) << "cg solve for complex system" << endl;
             invmat = new CGSolver<ComplexConjugate2>(mat, *premat);
 	    break;
+          case PIPELINEDCG:
+            cout << IM(1) << "pipelined cg solve for complex system" << endl;
+            invmat = new PipelinedCGSolver<ComplexConjugate2>(mat, *premat);
+            break;
+          case SSTEPCG:
+            {
+              cout << IM(1) << "s-step cg solve for complex system" << endl;
+              SStepCGSolver<ComplexConjugate2> * hinv = new SStepCGSolver<ComplexConjugate2>(mat, *premat);
+              hinv -> SetSStep (sstep);
+              invmat = hinv;
+              break;
+            }
           case BICGSTAB:
 	    cout << IM(1) << "bicgstab solve for complex system" << endl;
 	    invmat = new BiCGStabSolver<ComplexConjugate2>(mat, *premat);
@@ -0,0 +1,79 @@
+#include "catch.hpp"
+#include <ngstd.hpp>
+using namespace ngstd;
+
+// small values around a large array, the array is larger than the
+// archive buffers and runs the bulk and multi-block paths
+static void DoArchive (Archive & ar, Array<double> & large, Array<int> & small,
+                       string & name, size_t & n, double & last)
+{
+  ar & name;
+  n = large.Size();
+  ar & n;
+  if (ar.Input()) large.SetSize(n);
+  ar.Do (&large[0], n);
+  for (int i = 0; i < 10; i++)
+    {
+      size_t ns = small.Size();
+      ar & ns;
+      if (ar.Input()) small.SetSize(ns);
+      ar.Do (&small[0], ns);
+    }
+  ar & last;
+}
+
+TEST_CASE ("BinaryArchive", "[archive]")
+{
+  for (bool compress : { false, true })
+    SECTION (compress ? "compressed" : "uncompressed")
+      {
+        string filename = compress ? "archive_z.bin" : "archive.bin";
+        size_t n = 3 << 17;   // 3 MB of doubles
+        Array<double> large(n);
+        for (size_t i = 0; i < n; i++)
+          large[i] = (i % 1000 == 0) ? sin(i) : i/7;
+        Array<int> small(100);
+        for (int i = 0; i < 100; i++)
+          small[i] = i*i;
+        string name = "checkpoint";
+        double last = 3.25;
+        {
+          BinaryOutArchive out(filename, compress);
+          DoArchive (out, large, small, name, n, last);
+        }
+        size_t filesize = ifstream(filename, ios::binary | ios::ate).tellg();
+        if (compress)
+          CHECK(filesize < n*sizeof(double) / 2);
+        else
+          CHECK(filesize > n*sizeof(double));
+
+        // from the memory mapped file and from a stream
+        for (int source = 0; source < 2; source++)
+          {
+            Array<double> large2;
+            Array<int> small2;
+            string name2;
+            size_t n2;
+            double last2;
+            {
+              shared_ptr<BinaryInArchive> in;
+              if (source == 0)
+                in = make_shared<BinaryInArchive> (filename, compress);
+              else
+                in = make_shared<BinaryInArchive> (make_shared<ifstream> (filename, ios::binary), compress);
+              DoArchive (*in, large2, small2, name2, n2, last2);
+            }
+            CHECK(name2 == name);
+            REQUIRE(n2 == n);
+            bool same = true;
+            for (size_t i = 0; i < n; i++)
+              if (large2[i] != large[i]) same = false;
+            CHECK(same);
+            REQUIRE(small2.Size() == small.Size());
+            for (int i = 0; i < 100; i++)
+              CHECK(small2[i] == small[i]);
+            CHECK(last2 == last);
+          }
+        remove (filename.c_str());
+      }
+}
@@ -0,0 +1,106 @@
+
+#include "catch.hpp"
+#include <parallelngs.hpp>
+
+using namespace ngparallel;
+
+#ifdef PARALLEL
+
+static void InitMPI ()
+{
+  int initialized;
+  MPI_Initialized (&initialized);
+  if (!initialized)
+    {
+      MPI_Init (nullptr, nullptr);
+      atexit ([] () { MPI_Finalize(); });
+    }
+}
+
+// n dofs per rank, the last dof of each rank is shared with the first
+// dof of the next rank. Without neighbours, nothing is shared.
+static shared_ptr<ParallelDofs> ChainParallelDofs (int n)
+{
+  int id = MyMPI_GetId(MPI_COMM_WORLD);
+  int ntasks = MyMPI_GetNTasks(MPI_COMM_WORLD);
+  TableCreator<int> creator(n);
+  for ( ; !creator.Done(); creator++)
+    {
+      if (id > 0) creator.Add (0, id-1);
+      if (id < ntasks-1) creator.Add (n-1, id+1);
+    }
+  return make_shared<ParallelDofs> (MPI_COMM_WORLD, creator.MoveTable(), 1, false);
+}
+
+TEST_CASE ("HaloExchange", "[parallel]")
+{
+  InitMPI();
+  int n = 10;
+  auto pardofs = ChainParallelDofs (n);
+
+  ParallelVVector<double> a(n, pardofs, DISTRIBUTED), b(n, pardofs, DISTRIBUTED);
+  for (int i = 0; i < n; i++)
+    a.FV()(i) = b.FV()(i) = i+1;
+
+  // a uses the halo exchange, b meanwhile the previous exchange
+  a.StartCumulate();
+  CHECK(pardofs->GetHaloExchange<double>(1).IsBusy());
+  b.Cumulate();
+  a.FinishCumulate();
+
+  CHECK(a.Status() == CUMULATED);
+  CHECK(b.Status() == CUMULATED);
+  for (int i = 0; i < n; i++)
+    {
+      double expected = i+1;
+      if (pardofs->GetDistantProcs(i).Size()) expected = n+1;
+      CHECK(a.FV()(i) == Approx(expected));
+      CHECK(b.FV()(i) == Approx(expected));
+    }
+}
+
+TEST_CASE ("ParallelMatrixOverlap", "[parallel]")
+{
+  InitMPI();
+  int n = 10;
+  auto pardofs = ChainParallelDofs (n);
+
+  // locally assembled 1D stiffness matrix, distributed in the parallel sense
+  Array<int> elsperrow(n);
+  elsperrow = 3;
+  elsperrow[0] = elsperrow[n-1] = 2;
+  auto mat = make_shared<SparseMatrix<double>> (elsperrow, n);
+  mat->AsVector() = 0.0;
+  for (int i = 0; i < n-1; i++)
+    {
+      (*mat)(i,i) += 2+i;
+      (*mat)(i+1,i+1) += 1;
+      (*mat)(i,i+1) -= 1;
+      (*mat)(i+1,i) -= 1+0.5*i;
+    }
+  auto pmat = make_shared<ParallelMatrix> (mat, pardofs);
+
+  ParallelVVector<double> x(n, pardofs, DISTRIBUTED);
+  ParallelVVector<double> y1(n, pardofs, DISTRIBUTED), y2(n, pardofs, DISTRIBUTED);
+  for (int i = 0; i < n; i++)
+    x.FV()(i) = sin(i+1);
+
+  // same distributed input, once split into interior/interface rows, once blocking
+  ParallelVVector<double> x2(n, pardofs, DISTRIBUTED);
+  x2.FV() = x.FV();
+  y1.FVDouble() = 0.0;
+  y2.FVDouble() = 0.0;
+
+  pmat->SetOverlap (true);
+  pmat->MultAdd (2, x, y1);
+  pmat->SetOverlap (false);
+  pmat->MultAdd (2, x2, y2);
+
+  CHECK(x.Status() == CUMULATED);
+  y1.Cumulate();
+  y2.Cumulate();
+  for (int i = 0; i < n; i++)
+    CHECK(y1.FV()(i) == Approx(y2.FV()(i)));
+}
+
+#endif
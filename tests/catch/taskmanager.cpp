@@ -0,0 +1,197 @@
+#include "catch.hpp"
+#include <ngstd.hpp>
+using namespace ngstd;
+
+// runs alg with 4 threads, exceptions are passed on after the task manager is left
+static void RunWithThreads (function<void()> alg)
+{
+  TaskManager::SetNumThreads (4);
+  int num_threads = EnterTaskManager();
+  try
+    {
+      alg();
+    }
+  catch (...)
+    {
+      ExitTaskManager(num_threads);
+      throw;
+    }
+  ExitTaskManager(num_threads);
+}
+
+TEST_CASE ("TaskGraph", "[taskmanager]")
+{
+  SECTION ("diamond")
+    {
+      atomic<int> counter(0);
+      int stamp[4];
+      TaskGraph graph;
+      int a = graph.AddTask ([&] () { stamp[0] = counter++; });
+      int b = graph.AddTask ([&] () { stamp[1] = counter++; }, { a });
+      int c = graph.AddTask ([&] () { stamp[2] = counter++; }, { a });
+      graph.AddTask ([&] () { stamp[3] = counter++; }, { b, c });
+
+      // a graph can be run several times
+      for (int run = 0; run < 3; run++)
+        {
+          counter = 0;
+          RunWithThreads ([&] () { graph.Run(); });
+          CHECK(counter == 4);
+          CHECK(stamp[0] == 0);
+          CHECK(stamp[1] > stamp[0]);
+          CHECK(stamp[2] > stamp[0]);
+          CHECK(stamp[3] == 3);
+        }
+    }
+
+  SECTION ("layers")
+    {
+      // every task waits for two tasks of the previous layer
+      int nlayers = 20, width = 16;
+      atomic<int> counter(0);
+      Array<int> stamp(nlayers*width);
+      stamp = -1;
+      TaskGraph graph;
+      for (int l = 0; l < nlayers; l++)
+        for (int i = 0; i < width; i++)
+          {
+            int nr = l*width+i;
+            auto func = [&stamp, &counter, nr] () { stamp[nr] = counter++; };
+            if (l == 0)
+              graph.AddTask (func);
+            else
+              graph.AddTask (func, { (l-1)*width+i, (l-1)*width+(i+1)%width });
+          }
+
+      RunWithThreads ([&] () { graph.Run(); });
+      CHECK(counter == nlayers*width);
+      for (int l = 1; l < nlayers; l++)
+        for (int i = 0; i < width; i++)
+          {
+            CHECK(stamp[l*width+i] > stamp[(l-1)*width+i]);
+            CHECK(stamp[l*width+i] > stamp[(l-1)*width+(i+1)%width]);
+          }
+    }
+
+  SECTION ("exceptions")
+    {
+      // a failing task still releases its successors, Run returns and rethrows
+      for (int kind = 0; kind < 2; kind++)
+        {
+          TaskGraph graph;
+          int first = graph.AddTask ([] () { ; });
+          Array<int> layer;
+          for (int i = 0; i < 50; i++)
+            layer.Append (graph.AddTask ([i, kind] ()
+                                         {
+                                           if (i != 17) return;
+                                           if (kind == 0) throw Exception ("task failed");
+                                           throw std::runtime_error ("task failed");
+                                         }, { first }));
+          graph.AddTask ([] () { ; }, layer);
+
+          CHECK_THROWS_AS (RunWithThreads ([&] () { graph.Run(); }), Exception);
+          CHECK_THROWS_WITH (RunWithThreads ([&] () { graph.Run(); }), Catch::Contains("task failed"));
+        }
+    }
+}
+
+TEST_CASE ("RunParallelDependency", "[taskmanager]")
+{
+  SECTION ("chain")
+    {
+      int n = 100;
+      TableCreator<int> dag_creator(n), trans_creator(n);
+      for ( ; !dag_creator.Done(); dag_creator++, trans_creator++)
+        for (int i = 0; i+1 < n; i++)
+          {
+            dag_creator.Add (i, i+1);
+            trans_creator.Add (i+1, i);
+          }
+      Table<int> dag = dag_creator.MoveTable();
+      Table<int> trans_dag = trans_creator.MoveTable();
+
+      Array<int> order;
+      RunWithThreads ([&] ()
+                      {
+                        RunParallelDependency (dag, trans_dag, [&] (int i) { order.Append(i); });
+                      });
+      REQUIRE(order.Size() == n);
+      for (int i = 0; i < n; i++)
+        CHECK(order[i] == i);
+    }
+
+  SECTION ("no start node")
+    {
+      // a cycle, every node has a predecessor
+      TableCreator<int> dag_creator(2), trans_creator(2);
+      for ( ; !dag_creator.Done(); dag_creator++, trans_creator++)
+        {
+          dag_creator.Add (0, 1);
+          dag_creator.Add (1, 0);
+          trans_creator.Add (1, 0);
+          trans_creator.Add (0, 1);
+        }
+      Table<int> dag = dag_creator.MoveTable();
+      Table<int> trans_dag = trans_creator.MoveTable();
+
+      int calls = 0;
+      CHECK_THROWS_AS (RunWithThreads ([&] ()
+                                       {
+                                         RunParallelDependency (dag, trans_dag, [&] (int i) { calls++; });
+                                       }), Exception);
+      CHECK(calls == 0);
+    }
+}
+
+TEST_CASE ("NestedParallelFor", "[taskmanager]")
+{
+  bool old_nested = TaskManager::GetNestedParallelism();
+  TaskManager::SetNestedParallelism (true);
+
+  SECTION ("every index once")
+    {
+      int nouter = 16, ninner = 200;
+      Array<atomic<int>> count(nouter*ninner);
+      for (auto & c : count) c = 0;
+
+      for (int run = 0; run < 5; run++)
+        RunWithThreads ([&] ()
+                        {
+                          ParallelFor (nouter, [&] (int i)
+                                       {
+                                         ParallelFor (ninner, [&] (int j)
+                                                      {
+                                                        count[i*ninner+j]++;
+                                                      });
+                                       });
+                        });
+      for (auto & c : count)
+        CHECK(c == 5);
+    }
+
+  SECTION ("exception in inner task")
+    {
+      for (int kind = 0; kind < 2; kind++)
+        {
+          auto run = [kind] ()
+            {
+              RunWithThreads ([kind] ()
+                              {
+                                ParallelFor (16, [kind] (int i)
+                                             {
+                                               ParallelFor (200, [i, kind] (int j)
+                                                            {
+                                                              if (i != 5 || j != 123) return;
+                                                              if (kind == 0) throw Exception ("inner task failed");
+                                                              throw std::runtime_error ("inner task failed");
+                                                            });
+                                             });
+                              });
+            };
+          CHECK_THROWS_WITH (run(), Catch::Contains("inner task failed"));
+        }
+    }
+
+  TaskManager::SetNestedParallelism (old_nested);
+}
@@ -0,0 +1,49 @@
+from netgen.geom2d import unit_square
+from ngsolve import *
+import pytest
+
+def test_checkpoint(tmpdir):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=3)
+    u = GridFunction(fes, name="u")
+    p = GridFunction(L2(mesh, order=1, complex=True), name="p")
+    filename = str(tmpdir.join("checkpoint.ngs"))
+
+    for step in range(3):
+        u.Set(x*y + step)
+        p.Set((1+1j)*(x+step))
+        u.SaveCheckpoint(filename, append=step>0, time=0.1*step)
+        p.SaveCheckpoint(filename, append=True, time=0.1*step)
+
+    uref = u.vec.CreateVector()
+    for step in [0, 2, -2]:
+        u.Set(x*y + (step % 3))
+        uref.data = u.vec
+        u.vec[:] = 0
+        time = u.LoadCheckpoint(filename, index=step)
+        assert time == pytest.approx(0.1 * (step % 3))
+        uref.data -= u.vec
+        assert Norm(uref) < 1e-14
+
+    pref = p.vec.CreateVector()
+    pref.data = p.vec
+    p.vec[:] = 0
+    assert p.LoadCheckpoint(filename) == pytest.approx(0.2)
+    pref.data -= p.vec
+    assert Norm(pref) < 1e-14
+
+    with pytest.raises(Exception):
+        GridFunction(H1(mesh, order=2), name="u").LoadCheckpoint(filename)
+    with pytest.raises(Exception):
+        u.LoadCheckpoint(filename, index=3)
+
+    # header_bytes = data_bytes = 0 in the first entry must not loop forever
+    import struct
+    corrupt = str(tmpdir.join("corrupt.ngs"))
+    with open(filename, "rb") as f:
+        data = bytearray(f.read())
+    data[16:32] = struct.pack("<QQ", 0, 0)
+    with open(corrupt, "wb") as f:
+        f.write(data)
+    with pytest.raises(Exception):
+        u.LoadCheckpoint(corrupt)
@@ -78,6 +78,32 @@ def test_code_generation_derivatives():
         vals -= vals_ref
         assert Norm(vals) < 1e-13
 
+def test_code_generation_cache(tmpdir):
+    import os
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = L2(mesh, order=3)
+    gfu1 = GridFunction(fes)
+    gfu2 = GridFunction(fes)
+    gfu1.Set(x*y)
+    gfu2.Set(sin(x)+y)
+    olddir = GetCodeCacheDirectory()
+    oldpath = os.environ["PATH"]
+    SetCodeCacheDirectory(str(tmpdir))
+    try:
+        # same code, the later ones are loaded from the cache with their own gridfunction pointer
+        for i, gfu in enumerate([gfu1, gfu2, gfu1]):
+            cf = (gfu*gfu).Compile(True, wait=True)
+            assert Integrate((cf-gfu*gfu)*(cf-gfu*gfu), mesh) < 1e-13
+            if i == 0:
+                # without compiler and linker, only a cache hit succeeds
+                os.environ["PATH"] = ""
+        entries = os.listdir(str(tmpdir))
+        assert len(entries) == 1
+        assert "_tmp" not in entries[0]
+    finally:
+        os.environ["PATH"] = oldpath
+        SetCodeCacheDirectory(olddir)
+
 if __name__ == "__main__":
     test_code_generation_derivatives()
     test_code_generation_volume_terms()
@@ -65,9 +65,40 @@ def test_domainwise_cf():
     error_true = Integrate((c-c_true)*(c-c_true), mesh)
     assert abs(error_true) < 1e-14
 
+def test_compile_optimization():
+    xy = x*y
+    c = (xy + xy*1 + 0*x) * sin(xy) / (CoefficientFunction(2)*3-5) + exp(2*y) - exp(2*y)*1
+    assert CompareCfs2D(c, c.Compile(False))
+    assert CompareCfs2D(c, c.Compile(True, wait=True))
+
+    # xy*1 and the duplicated xy are merged, 0*x and the constant division are removed,
+    # this is the same list of steps as for the simplified tree with shared nodes
+    e = exp(2*y)
+    cref = (xy + xy) * sin(xy) + e - e
+    assert c.compiled_steps == -1
+    assert c.Compile(False).compiled_steps == cref.Compile(False).compiled_steps
+
+    cvec = CoefficientFunction((xy, xy+0, 1*xy))
+    for cc in [cvec.Compile(False), cvec.Compile(True, wait=True)]:
+        assert CompareCfs2D(InnerProduct(cvec-cc, cvec-cc), 0)
+    assert cvec.Compile(False).compiled_steps == CoefficientFunction((xy, xy, xy)).Compile(False).compiled_steps
+
+    # 0/x is not simplified, 0/0 stays nan
+    c0 = CoefficientFunction(0) / x
+    assert c0.Compile(False).compiled_steps == 3
+
+def test_compile_interpreter():
+    v = CoefficientFunction((x, y, x*y))
+    m = CoefficientFunction((1, x, 0, y, 2, x, 0, 1, y+3), dims=(3,3))
+    w = m*v + 2*v - (x+1)*v
+    c = InnerProduct(w, v) / (1+w[2]*w[2]) + sin(w[0]) + CoefficientFunction((w[1], x))[1]
+    assert CompareCfs2D(c, c.Compile(False))
+
 if __name__ == "__main__":
     test_pow()
     test_ParameterCF()
     test_mesh_size_cf()
     test_real()
     test_domainwise_cf()
+    test_compile_optimization()
+    test_compile_interpreter()
@@ -99,7 +99,193 @@ def test_sparsematrix_access():
     a.Assemble()
     assert abs(a.mat[1,1][0,0] - (reference_values[3])) < 1e-8
 
+def test_sparsematrix_sell():
+    mesh = Mesh("square.vol.gz")
+    fes = H1(mesh, order=3)
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    a = BilinearForm(fes, symmetric=False)
+    a += SymbolicBFI(grad(u)*grad(v)+u*v)
+    a.Assemble()
+
+    sell = la.SparseMatrixSELL(a.mat, maxfill=10)
+    assert not sell.uses_csr
+    x = a.mat.CreateColVector()
+    x.FV().NumPy()[:] = np.random.rand(len(x))
+    y1 = a.mat.CreateColVector()
+    y2 = a.mat.CreateColVector()
+    a.mat.Mult(x, y1)
+    sell.Mult(x, y2)
+    assert np.linalg.norm(y1.FV().NumPy()-y2.FV().NumPy()) < 1e-12 * y1.Norm()
+
+    vals = a.mat.AsVector()
+    vals *= 2
+    sell.Update()
+    sell.Mult(x, y2)
+    assert np.linalg.norm(2*y1.FV().NumPy()-y2.FV().NumPy()) < 1e-12 * y1.Norm()
+
+    # real matrix acting on complex vectors, must use the CSR matrix
+    fesc = H1(mesh, order=3, complex=True)
+    u,v = fesc.TrialFunction(), fesc.TestFunction()
+    a = BilinearForm(fesc, symmetric=False, real=True)
+    a += SymbolicBFI(grad(u)*grad(v)+u*v)
+    a.Assemble()
+
+    sell = la.SparseMatrixSELL(a.mat, maxfill=10)
+    assert sell.uses_csr
+    x = a.mat.CreateColVector()
+    x.FV().NumPy()[:] = np.random.rand(len(x)) + 1j*np.random.rand(len(x))
+    y1 = a.mat.CreateColVector()
+    y2 = a.mat.CreateColVector()
+    a.mat.Mult(x, y1)
+    sell.Mult(x, y2)
+    assert np.linalg.norm(y1.FV().NumPy()-y2.FV().NumPy()) < 1e-12 * y1.Norm()
+
+def test_sparsematrix_float():
+    mesh = Mesh("square.vol.gz")
+    fes = H1(mesh, order=2, dirichlet=".*")
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym)
+        a += SymbolicBFI(grad(u)*grad(v)+u*v)
+        a.Assemble()
+
+        amat = la.SparseMatrixFloat(a.mat)
+        x = a.mat.CreateColVector()
+        x.FV().NumPy()[:] = np.random.rand(len(x))
+        y1 = a.mat.CreateColVector()
+        y2 = a.mat.CreateColVector()
+        a.mat.Mult(x, y1)
+        amat.Mult(x, y2)
+        assert np.linalg.norm(y1.FV().NumPy()-y2.FV().NumPy()) < 1e-6 * y1.Norm()
+
+def test_sparsecholesky_nd():
+    mesh = Mesh("square.vol.gz")
+    fes = H1(mesh, order=3, dirichlet=".*")
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    a = BilinearForm(fes, symmetric=True)
+    a += SymbolicBFI(grad(u)*grad(v))
+    a.Assemble()
+
+    f = a.mat.CreateColVector()
+    f.FV().NumPy()[:] = np.random.rand(len(f))
+    u1 = a.mat.CreateColVector()
+    u2 = a.mat.CreateColVector()
+    u1.data = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky") * f
+    u2.data = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky_nd") * f
+    assert a.mat.GetInverseType() == "sparsecholesky_nd"
+    assert np.linalg.norm(u1.FV().NumPy()-u2.FV().NumPy()) < 1e-10 * u1.Norm()
+
+def test_sparsecholesky_parallel():
+    # enough supernodes for the parallel factorization along the elimination tree
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.03))
+    fes = H1(mesh, order=3, dirichlet=".*")
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    a = BilinearForm(fes, symmetric=True)
+    a += SymbolicBFI(grad(u)*grad(v))
+    a.Assemble()
+
+    f = a.mat.CreateColVector()
+    f.FV().NumPy()[:] = np.random.rand(len(f))
+    u1 = a.mat.CreateColVector()
+    u2 = a.mat.CreateColVector()
+    u1.data = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky") * f
+    SetNumThreads(4)
+    with TaskManager():
+        inv = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky")
+        u2.data = inv * f
+    assert np.linalg.norm(u1.FV().NumPy()-u2.FV().NumPy()) < 1e-10 * u1.Norm()
+
+def test_reassemble():
+    mesh = Mesh("square.vol.gz")
+    fes = L2(mesh, order=2, dgjumps=True)
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    def MakeForm(c):
+        a = BilinearForm(fes)
+        a += SymbolicBFI(c*grad(u)*grad(v)+u*v)
+        a += SymbolicBFI(c*(u-u.Other())*(v-v.Other()), VOL, skeleton=True)
+        a += SymbolicBFI(c*u*v, BND, skeleton=True)
+        return a
+
+    c = Parameter(1)
+    a = MakeForm(c)
+    for val in [1, 2, 3]:
+        c.Set(val)
+        a.Assemble()
+    b = MakeForm(3)
+    b.Assemble()
+    diff = a.mat.AsVector().FV().NumPy() - b.mat.AsVector().FV().NumPy()
+    assert np.linalg.norm(diff) < 1e-12 * np.linalg.norm(b.mat.AsVector().FV().NumPy())
+
+def test_cache_scatter():
+    mesh = Mesh("square.vol.gz")
+    fes = L2(mesh, order=2, dgjumps=True)
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    c = Parameter(1)
+    for sym in [False, True]:
+        a = BilinearForm(fes, symmetric=sym, cache_scatter=True)
+        b = BilinearForm(fes, symmetric=sym)
+        for bf in [a, b]:
+            bf += SymbolicBFI(c*grad(u)*grad(v)+u*v)
+            bf += SymbolicBFI(c*(u-u.Other())*(v-v.Other()), VOL, skeleton=True)
+            bf += SymbolicBFI(c*u*v, BND, skeleton=True)
+        def compare():
+            a.Assemble()
+            b.Assemble()
+            diff = a.mat.AsVector().FV().NumPy() - b.mat.AsVector().FV().NumPy()
+            assert np.linalg.norm(diff) < 1e-12 * np.linalg.norm(b.mat.AsVector().FV().NumPy())
+        # the first assembly records the positions, the next ones replay them
+        for val in [1, 2, 3]:
+            c.Set(val)
+            compare()
+        a.InvalidateScatterCache()
+        c.Set(4)
+        compare()
+
+def test_batch_elements():
+    for mesh, order in [(Mesh("square.vol.gz"), 2), (Mesh("cube.vol.gz"), 1)]:
+        for fes in [H1(mesh, order=order), H1(mesh, order=order, dim=mesh.dim)]:
+            u,v = fes.TrialFunction(), fes.TestFunction()
+            mats = []
+            for batch in [False, True]:
+                a = BilinearForm(fes, batch_elements=batch)
+                a += SymbolicBFI((1+x*y)*InnerProduct(grad(u),grad(v))+InnerProduct(u,v))
+                a.Assemble()
+                mats.append(a.mat.AsVector().FV().NumPy().copy())
+            assert np.linalg.norm(mats[0]-mats[1]) < 1e-12 * np.linalg.norm(mats[0])
+
+def test_batch_condensation():
+    mesh = Mesh("square.vol.gz")
+    fes = H1(mesh, order=4)
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    for keep, spd in [(False, False), (True, False), (True, True)]:
+        results = []
+        for batch in [False, True]:
+            a = BilinearForm(fes, eliminate_internal=True, keep_internal=keep, spd=spd, batch_elements=batch)
+            a += SymbolicBFI((1+x*y)*grad(u)*grad(v)+u*v)
+            f = LinearForm(fes)
+            f += SymbolicLFI(x*v)
+            f.Assemble()
+            a.Assemble()
+            gfu = GridFunction(fes)
+            if keep:
+                f.vec.data += a.harmonic_extension_trans * f.vec
+            gfu.vec.data = a.mat.Inverse(fes.FreeDofs(True)) * f.vec
+            if keep:
+                gfu.vec.data += a.harmonic_extension * gfu.vec
+                gfu.vec.data += a.inner_solve * f.vec
+            results.append((a.mat.AsVector().FV().NumPy().copy(), gfu.vec.FV().NumPy().copy()))
+        for i in range(2):
+            assert np.linalg.norm(results[0][i]-results[1][i]) < 1e-10 * np.linalg.norm(results[0][i])
+
 if __name__ == "__main__":
     test_matrix()
     test_matrix_numpy()
     test_sparsematrix_access()
+    test_sparsematrix_sell()
+    test_sparsematrix_float()
+    test_sparsecholesky_nd()
+    test_sparsecholesky_parallel()
+    test_reassemble()
+    test_cache_scatter()
+    test_batch_elements()
+    test_batch_condensation()
@@ -183,6 +183,26 @@ def test_pickle_periodic():
     assert sqrt(Integrate((u-u2)*(u-u2),mesh)) < 1e-14
 
 
+def test_pickle_sparsematrix():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = H1(mesh,order=3)
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    for symmetric in [False, True]:
+        a = BilinearForm(fes, symmetric=symmetric)
+        a += SymbolicBFI(grad(u) * grad(v) + u*v)
+        a.Assemble()
+
+        mat2 = pickle.loads(pickle.dumps(a.mat))
+        assert mat2.height == a.mat.height and mat2.width == a.mat.width
+
+        x = a.mat.CreateColVector()
+        x.FV().NumPy()[:] = range(len(x))
+        y = a.mat.CreateColVector()
+        y.data = a.mat * x
+        y.data -= mat2 * x
+        assert Norm(y) < 1e-12
+
+
 if __name__ == "__main__":
     test_pickle_volume_fespaces()
     test_pickle_surface_fespaces()
@@ -191,3 +211,4 @@ if __name__ == "__main__":
     test_pickle_compoundfespace()
     test_pickle_hcurl()
     test_pickle_periodic()
+    test_pickle_sparsematrix()
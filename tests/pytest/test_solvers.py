@@ -1,6 +1,7 @@
 from netgen.geom2d import unit_square
 from ngsolve import *
 import pytest
+import numpy as np
 
 def test_arnoldi():
     SetHeapSize (10*1000*1000)
@@ -43,6 +44,196 @@ def test_arnoldi():
     Draw(laplace(evec),mesh,"laplace")
 
 
+def test_sumfactorization():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3, quad_dominated=True))
+    assert all(el.type == ET.QUAD for el in mesh.Elements(VOL))
+    for fes in [H1(mesh, order=4, dirichlet="left|bottom"), L2(mesh, order=3)]:
+        u,v = fes.TrialFunction(), fes.TestFunction()
+        a = BilinearForm(fes)
+        a += SymbolicBFI(grad(u)*grad(v)+(1+x)*u*v)
+        a.Assemble()
+        op = SumFactorizationOperator(fes, alpha=1, beta=1+x)
+
+        vec = a.mat.CreateColVector()
+        for i in range(len(vec)):
+            vec[i] = (i*17 % 13) / 13
+        y1 = a.mat.CreateColVector()
+        y2 = a.mat.CreateColVector()
+        y1.data = a.mat * vec
+        y2.data = op * vec
+        y2.data -= y1
+        assert y2.Norm() < 1e-10 * y1.Norm()
+
+    # use in CG with Jacobi preconditioner
+    fes = H1(mesh, order=4, dirichlet="left|bottom")
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    a = BilinearForm(fes)
+    a += SymbolicBFI(grad(u)*grad(v))
+    a.Assemble()
+    f = LinearForm(fes)
+    f += SymbolicLFI(v)
+    f.Assemble()
+    pre = a.mat.CreateSmoother(fes.FreeDofs())
+    op = SumFactorizationOperator(fes)
+    gfu = GridFunction(fes)
+    gfu.vec.data = CGSolver(op, pre, precision=1e-12, maxsteps=1000) * f.vec
+    gfu2 = GridFunction(fes)
+    gfu2.vec.data = a.mat.Inverse(fes.FreeDofs()) * f.vec
+    assert Integrate((gfu-gfu2)*(gfu-gfu2), mesh) < 1e-16
+
+
+def test_cg_variants():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, dirichlet="left|bottom")
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    a = BilinearForm(fes)
+    a += SymbolicBFI(grad(u)*grad(v)+u*v)
+    a.Assemble()
+    f = LinearForm(fes)
+    f += SymbolicLFI(x*v)
+    f.Assemble()
+    pre = a.mat.CreateSmoother(fes.FreeDofs())
+
+    gfu = GridFunction(fes)
+    gfu.vec.data = a.mat.Inverse(fes.FreeDofs()) * f.vec
+    for inv in [CGSolver(a.mat, pre, precision=1e-12, maxsteps=1000),
+                PipelinedCGSolver(a.mat, pre, precision=1e-12, maxsteps=1000),
+                SStepCGSolver(a.mat, pre, sstep=1, precision=1e-12, maxsteps=1000),
+                SStepCGSolver(a.mat, pre, sstep=3, precision=1e-12, maxsteps=1000)]:
+        gfu2 = GridFunction(fes)
+        gfu2.vec.data = inv * f.vec
+        assert inv.GetSteps() < 1000
+        assert Integrate((gfu-gfu2)*(gfu-gfu2), mesh) < 1e-16
+
+
+def test_block_gauss_seidel():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, dirichlet="left|bottom")
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    f = LinearForm(fes)
+    f += SymbolicLFI(x*v)
+    f.Assemble()
+    blocks = []
+    for el in fes.Elements():
+        blocks.append([d for d in el.dofs if d >= 0 and fes.FreeDofs()[d]])
+
+    for symmetric in [False, True]:
+        a = BilinearForm(fes, symmetric=symmetric)
+        a += SymbolicBFI(grad(u)*grad(v)+u*v)
+        a.Assemble()
+        res = f.vec.CreateVector()
+        sols = []
+        for parallel in [False, True]:
+            def smooth():
+                pre = a.mat.CreateBlockSmoother(blocks)
+                gfu = GridFunction(fes)
+                for it in range(10):
+                    pre.Smooth(gfu.vec, f.vec, 1)
+                    pre.SmoothBack(gfu.vec, f.vec, 1)
+                return gfu
+            if parallel:
+                with TaskManager():
+                    sols.append(smooth())
+            else:
+                sols.append(smooth())
+            res.data = f.vec - a.mat * sols[-1].vec
+            assert Norm(res) < 0.5 * Norm(f.vec)
+        # the multicolor smoother is independent of the number of threads
+        res.data = sols[0].vec - sols[1].vec
+        assert Norm(res) < 1e-12
+
+
+def test_block_jacobi_batched():
+    # double valued blocks are applied in SIMD batches, complex ones
+    # by the dense block inverses
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    results = []
+    for cplx in [False, True]:
+        fes = H1(mesh, order=3, dirichlet="left|bottom", complex=cplx)
+        u,v = fes.TrialFunction(), fes.TestFunction()
+        a = BilinearForm(fes)
+        a += SymbolicBFI(grad(u)*grad(v)+u*v+(2*grad(u)[0]+grad(u)[1])*v)
+        a.Assemble()
+        blocks = []
+        for el in fes.Elements():
+            blocks.append([d for d in el.dofs if d >= 0 and fes.FreeDofs()[d]])
+        pre = a.mat.CreateBlockSmoother(blocks)
+
+        gfx = GridFunction(fes)
+        gfx.Set(sin(3*x)*y+x)
+        gfy = GridFunction(fes)
+        res = []
+        gfy.vec.data = pre * gfx.vec
+        res.append(gfy.vec.FV().NumPy().copy())
+        gfy.vec.data = pre.T * gfx.vec
+        res.append(gfy.vec.FV().NumPy().copy())
+        gfy = GridFunction(fes)
+        for it in range(3):
+            pre.Smooth(gfy.vec, gfx.vec, 1)
+            pre.SmoothBack(gfy.vec, gfx.vec, 1)
+        res.append(gfy.vec.FV().NumPy().copy())
+        results.append(res)
+    for r, c in zip(results[0], results[1]):
+        assert np.linalg.norm(r-c) < 1e-10 * np.linalg.norm(r)
+
+
+def test_chebyshev_smoother():
+    def solve(smoother):
+        mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+        fes = H1(mesh, order=1, dirichlet="left|bottom")
+        u,v = fes.TrialFunction(), fes.TestFunction()
+        a = BilinearForm(fes)
+        a += SymbolicBFI(grad(u)*grad(v)+u*v)
+        f = LinearForm(fes)
+        f += SymbolicLFI(x*v)
+        c = Preconditioner(a, "multigrid", smoother=smoother)
+        for l in range(4):
+            if l > 0:
+                mesh.Refine()
+            fes.Update()
+            a.Assemble()
+        f.Assemble()
+        inv = CGSolver(a.mat, c.mat, precision=1e-10, maxsteps=200)
+        gfu = GridFunction(fes)
+        gfu.vec.data = inv * f.vec
+        res = f.vec.CreateVector()
+        res.data = f.vec - a.mat * gfu.vec
+        assert Norm(res) < 1e-8 * Norm(f.vec)
+        return inv.GetSteps()
+
+    assert solve("chebyshev") < 30
+
+
+def test_bddc_nested_coarse():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=5, dirichlet="left|bottom")
+    u,v = fes.TrialFunction(), fes.TestFunction()
+    f = LinearForm(fes)
+    f += SymbolicLFI(x*v)
+    f.Assemble()
+
+    def solve(**flags):
+        a = BilinearForm(fes)
+        a += SymbolicBFI(grad(u)*grad(v)+u*v)
+        c = Preconditioner(a, "bddc", **flags)
+        a.Assemble()
+        inv = CGSolver(a.mat, c.mat, precision=1e-10, maxsteps=200)
+        gfu = GridFunction(fes)
+        gfu.vec.data = inv * f.vec
+        return gfu, inv.GetSteps()
+
+    gfu1, steps1 = solve()
+    gfu2, steps2 = solve(coarsetype="bddc")
+    gfu1.vec.data -= gfu2.vec
+    assert Norm(gfu1.vec) < 1e-6 * Norm(gfu2.vec)
+    assert steps2 < 100
+
 
 if __name__ == "__main__":
     test_arnoldi()
+    test_sumfactorization()
+    test_cg_variants()
+    test_block_gauss_seidel()
+    test_block_jacobi_batched()
+    test_chebyshev_smoother()
+    test_bddc_nested_coarse()
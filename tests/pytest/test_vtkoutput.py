@@ -0,0 +1,59 @@
+from netgen.geom2d import unit_square
+from ngsolve import *
+import xml.etree.ElementTree as ET
+import base64, struct, zlib, os
+
+def decode_base64(text, compressed):
+    if not compressed:
+        data = base64.b64decode(text)
+        n = struct.unpack('<Q', data[:8])[0]
+        return data[8:8+n]
+    nblocks = struct.unpack('<Q', base64.b64decode(text[:12])[:8])[0]
+    hlen = 4*((8*(3+nblocks)+2)//3)
+    header = struct.unpack('<%dQ' % (3+nblocks), base64.b64decode(text[:hlen]))
+    data = base64.b64decode(text[hlen:])
+    res, pos = b'', 0
+    for size in header[3:]:
+        res += zlib.decompress(data[pos:pos+size])
+        pos += size
+    return res
+
+def test_vtu(tmpdir):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    cf = x*y
+    for encoding in ["ascii", "base64"]:
+        for compress in [False, True]:
+            name = str(tmpdir.join("out_"+encoding+str(compress)))
+            vtk = VTKOutput(ma=mesh, coefs=[cf], names=["xy"], filename=name, subdivision=1,
+                            format="vtu", encoding=encoding, compress=compress)
+            vtk.Do(time=0.5)
+            vtk.Do(time=1.0)
+
+            piece = ET.parse(name+".vtu").getroot().find("UnstructuredGrid/Piece")
+            np = int(piece.get("NumberOfPoints"))
+            nc = int(piece.get("NumberOfCells"))
+            assert np == 6*mesh.ne and nc == 4*mesh.ne
+
+            pts = piece.find("Points/DataArray").text
+            vals = piece.find("PointData/DataArray").text
+            if encoding == "ascii":
+                pts = [float(v) for v in pts.split()]
+                vals = [float(v) for v in vals.split()]
+            else:
+                pts = struct.unpack('<%df' % (3*np), decode_base64(pts.strip(), compress))
+                vals = struct.unpack('<%df' % np, decode_base64(vals.strip(), compress))
+            for i in range(np):
+                assert abs(vals[i] - pts[3*i]*pts[3*i+1]) < 1e-6
+
+            steps = ET.parse(name+".pvd").getroot().findall("Collection/DataSet")
+            assert [float(s.get("timestep")) for s in steps] == [0.5, 1.0]
+            assert os.path.exists(name+"_1.vtu")
+
+def test_vtu_raw(tmpdir):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    name = str(tmpdir.join("raw"))
+    vtk = VTKOutput(ma=mesh, coefs=[x], names=["x"], filename=name, format="vtu", compress=True)
+    vtk.Do()
+    data = open(name+".vtu", "rb").read()
+    assert data.startswith(b'<?xml') and b'<AppendedData encoding="raw">' in data
+    assert data.endswith(b'</VTKFile>\n')